@@ -0,0 +1,32 @@
+# Writes every shader in SHADER_DIR into OUTPUT as a raw string literal, so the executables do not
+# read shaders/ at runtime. Run in script mode by the EmbedShaders target whenever a shader changes.
+# GLSL has no includes, so a line #include "<name>.glsl" is replaced by that snippet from SHADER_DIR.
+#
+#   cmake -DSHADER_DIR=<dir> -DOUTPUT=<header> -P EmbedShaders.cmake
+
+file(GLOB SHADERS RELATIVE ${SHADER_DIR} ${SHADER_DIR}/*.vert ${SHADER_DIR}/*.geom ${SHADER_DIR}/*.frag)
+list(SORT SHADERS)
+list(LENGTH SHADERS SHADER_COUNT)
+file(GLOB SNIPPETS RELATIVE ${SHADER_DIR} ${SHADER_DIR}/*.glsl)
+
+set(CONTENT "// Generated from shaders/ by cmake/EmbedShaders.cmake, do not edit\n\n")
+string(APPEND CONTENT "#pragma once\n\n#include <array>\n#include <string_view>\n\n")
+string(APPEND CONTENT "struct EmbeddedShader {\n\tstd::string_view name;\n\tstd::string_view source;\n};\n\n")
+string(APPEND CONTENT "inline constexpr std::array<EmbeddedShader, ${SHADER_COUNT}> EMBEDDED_SHADERS = {{\n")
+foreach(SHADER ${SHADERS})
+    file(READ ${SHADER_DIR}/${SHADER} SOURCE)
+    foreach(SNIPPET ${SNIPPETS})
+        file(READ ${SHADER_DIR}/${SNIPPET} SNIPPET_SOURCE)
+        string(REPLACE "#include \"${SNIPPET}\"\n" "${SNIPPET_SOURCE}" SOURCE "${SOURCE}")
+    endforeach()
+    if(SOURCE MATCHES "#include")
+        message(FATAL_ERROR "${SHADER} includes a file that is not a snippet in ${SHADER_DIR}")
+    endif()
+    string(APPEND CONTENT "\t{ \"${SHADER}\", R\"shader(${SOURCE})shader\" },\n")
+endforeach()
+string(APPEND CONTENT "}};\n")
+
+# Only touch the header when a shader actually changed, everything including it rebuilds otherwise
+file(WRITE ${OUTPUT}.tmp "${CONTENT}")
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different ${OUTPUT}.tmp ${OUTPUT})
+file(REMOVE ${OUTPUT}.tmp)
@@ -3,33 +3,55 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-#include <windows.h>
-#include <mmdeviceapi.h>
-#include <audioclient.h>
-
-extern "C" {
-#include "kiss_fft.h"
-}
 
+#include <cstdint>
 #include <vector>
 #include <array>
 #include <stdexcept>
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <span>
 #include <fstream>
 #include <sstream>
 
 #include "Globals.h"
-
-#define THROW_ON_ERROR(hres, x)  \
-              if (FAILED(hres)) { throw std::runtime_error(x); }
+#include "AudioSource.h"
+#include "BarBinner.h"
+#include "BarVertices.h"
+#include "CaptureThread.h"
+#include "ConstantQ.h"
+#include "Downmix.h"
+#include "GpuSmoother.h"
+#include "ProgramCache.h"
+#include "RenderManager.h"
+#include "ShaderSources.h"
+#include "SpscRingBuffer.h"
+#include "SpectrumFft.h"
+#include "SpectrumKernels.h"
+#include "Stft.h"
+#include "TripleBuffer.h"
+#include "VertexRing.h"
+#include "WindowTables.h"
 
 #define DEFAULT_M		0
 #define SYMMETRIC_M		1
 #define DOUBLE_SYM_M	2
 
+//	How the bars are turned into quads. Both paths draw the same bars in every mode.
+enum class RenderPath {
+	GeometryShader,		//	One point per bar, expanded by the mode's geometry shader
+	Instanced,			//	One uint16 height per bar, instanced quads, no geometry shader
+	Fullscreen			//	One fullscreen triangle, the fragment shader looks the bar heights up in a buffer texture
+};
+
+constexpr const char* RENDER_PATH_NAMES[] = { "Geometry shader", "Instanced", "Fullscreen shader" };
+
 struct Settings {
 	bool smoothing;
 	unsigned int modeIndex; //Default = 0, Symmetric = 1; Double Symetric = 2
@@ -39,6 +61,18 @@ struct Settings {
 	int windowHeight;
 	int windowWidth;
 	float smoothingCoef;
+	BarScale barScale;		//	Frequency spacing of the bars
+	unsigned int barCount;	//	BAR_COUNT_AUTO picks it from windowWidth
+	bool gpuSmoothing;		//	Smooth the bars in a transform feedback pass instead of on the CPU, geometry shader path only
+	RenderPath renderPath;
+};
+
+//	One finished spectrum as the analysis thread hands it to the render thread
+struct SpectrumFrame {
+	std::vector<float> magnitudes;
+	uint64_t sequence = 0;		//	Counts up from 1 per spectrum, gaps are spectra the renderer never saw
+	SpectrumAnalysis analysis = SpectrumAnalysis::Fft;	//	Which bins the magnitudes are
+	std::chrono::steady_clock::time_point captureTime{};	//	When the newest sample of its window was captured
 };
 
 //	Tests classes
@@ -46,6 +80,15 @@ class AudioManagerTest;
 class GraphicsTest;
 class AudioManagerTest_silenceTest_Test;
 class AudioManagerTest_smoothingTest_Test;
+class AudioSourceTest_syntheticSineTest_Test;
+class AudioSourceTest_captureThreadTest_Test;
+class AudioSourceTest_capturePacingTest_Test;
+class StftTest_hopTest_Test;
+class AudioSourceTest_multichannelPcmTest_Test;
+class GraphicsTest_gpuSmoothingTest_Test;
+class AudioSourceTest_impulseLatencyTest_Test;
+class AudioSourceTest_silentPacketTest_Test;
+class ConstantQTest_audioManagerTest_Test;
 
 class AudioManager {
 	//	Need private member access for tests
@@ -53,26 +96,41 @@ class AudioManager {
 	friend class GraphicsTest;
 	friend class AudioManagerTest_silenceTest_Test;
 	friend class AudioManagerTest_smoothingTest_Test;
+	friend class AudioSourceTest_syntheticSineTest_Test;
+	friend class AudioSourceTest_captureThreadTest_Test;
+	friend class AudioSourceTest_capturePacingTest_Test;
+	friend class StftTest_hopTest_Test;
+	friend class AudioSourceTest_multichannelPcmTest_Test;
+	friend class GraphicsTest_gpuSmoothingTest_Test;
+	friend class AudioSourceTest_impulseLatencyTest_Test;
+	friend class AudioSourceTest_silentPacketTest_Test;
+	friend class ConstantQTest_audioManagerTest_Test;
 
 	public:
-		AudioManager();
+		AudioManager();		//	Uses the platform capture device (WASAPI loopback on Windows)
+		explicit AudioManager(std::unique_ptr<AudioSource> source);	//	Any source, e.g. synthetic or WAV for tests/benchmarks
 		~AudioManager() noexcept;
 
-		void RenderAudio(const GLFWwindow *, const GLuint &VBO, const GLuint &VAO);
+		void RenderAudio(const GLFWwindow *, const GLuint &VAO);
 		// void SetColorFunction();
 		void UpdateSmoothing(int);
 		void openGLInit(GLuint& VBO, GLuint& VAO);
 		static void compileShader(const char* source, GLuint& name, GLenum type, int & success);
 
-		[[nodiscard]] GLuint getColorLocation1() const { return this->colorLocation1; }
-		[[nodiscard]] GLuint getColorLocation2() const { return this->colorLocation2; }
-		[[nodiscard]] GLuint getColorLocation3() const { return this->colorLocation3; }
-		[[nodiscard]] GLuint getBarCountUniform1() const { return this->barCountUniform1; }
-		[[nodiscard]] GLuint getBarCountUniform2() const { return this->barCountUniform2; }
-		[[nodiscard]] GLuint getBarCountUniform3() const { return this->barCountUniform3; }
 		[[nodiscard]] GLuint getDefaultShader() const { return this->defaultShaderProgram; }
 		[[nodiscard]] GLuint getSymmetricShader() const { return this->symmetricShaderProgram; }
 		[[nodiscard]] GLuint getDoubleSymmetricShader() const { return this->doubleSymmetricShaderProgram; }
+		[[nodiscard]] GLuint getInstancedShader() const { return this->instancedShaderProgram; }
+		[[nodiscard]] GLuint getFullscreenShader() const { return this->fullscreenShaderProgram; }
+
+		//	Shared uniform block and bind cache, lastFrame() counts the GL calls it saved
+		[[nodiscard]] const RenderManager& getRenderManager() const { return renderManager; }
+
+		//	Where openGLInit keeps linked program binaries, an empty path links from source every time.
+		//	Set it before openGLInit, hits() and misses() show whether the programs came from the cache.
+		void setShaderCacheDirectory(std::filesystem::path directory) { programCache = ProgramCache(std::move(directory)); }
+		[[nodiscard]] const ProgramCache& getProgramCache() const { return programCache; }
+		[[nodiscard]] ProgramCache& getProgramCache() { return programCache; }
 
 		AudioManager(const AudioManager&) = delete;
 		AudioManager& operator=(const AudioManager&) = delete;	//	no copies
@@ -84,50 +142,137 @@ class AudioManager {
 
 		[[nodiscard]] bool hasValidAudioDevice() const { return this->validAudioDevice; }
 
+		//	Bars drawn right now, settings.barCount resolved against the window size and clamped
+		[[nodiscard]] unsigned int getBarCount() const { return barCount; }
+		[[nodiscard]] unsigned int resolveBarCount() const;
+
+		//	Channels, sample format and rate of the capture source, fixed at construction
+		[[nodiscard]] const AudioFormat& getSourceFormat() const { return sourceFormat; }
+
+		//	Moves capture and FFT onto dedicated threads, RenderAudio then only reads the newest spectrum
+		void startCapture();
+		void stopCapture() noexcept;
+		[[nodiscard]] bool isCapturing() const { return captureThread != nullptr; }
+
+		//	Sequence number and capture time of the spectrum RenderAudio last picked up, 0 before the first.
+		//	The time is that of the newest sample in its window, taken from the packet stamps, so now minus
+		//	it right after the swap is the audio to screen latency of the frame.
+		[[nodiscard]] uint64_t spectrumSequence() const { return consumedSequence; }
+		[[nodiscard]] std::chrono::steady_clock::time_point spectrumCaptureTime() const { return consumedCaptureTime; }
+
+		//	Samples the capture side could not queue because analysis fell behind
+		[[nodiscard]] uint64_t droppedSampleCount() const { return sampleRing ? sampleRing->droppedCount() : 0; }
+		[[nodiscard]] uint64_t sampleOverflowCount() const { return sampleRing ? sampleRing->overflowCount() : 0; }
+
+		//	Samples between consecutive spectra, 1 to FFT_COUNT. Safe to call while capturing,
+		//	the analysis side picks it up on its next window.
+		void setStftHop(uint32_t hop);
+		[[nodiscard]] uint32_t stftHop() const { return requestedHop.load(std::memory_order_relaxed); }
+
+		//	Analysis window, applied while the STFT copies each frame out of the sample ring
+		void setWindow(WindowType type);
+		[[nodiscard]] WindowType window() const { return requestedWindow.load(std::memory_order_relaxed); }
+
+		//	Linear FFT_COUNT point bins or constant-Q bins over CQT_FFT_SIZE samples, into the same bars.
+		//	The constant-Q kernels are built on the first switch to it, so call it from the render thread.
+		//	Safe while capturing, the analysis side switches on its next window.
+		void setAnalysis(SpectrumAnalysis analysis);
+		[[nodiscard]] SpectrumAnalysis analysis() const { return requestedAnalysis.load(std::memory_order_relaxed); }
+		[[nodiscard]] const ConstantQ& getConstantQ() const { return constantQ; }
+
+		//	How RenderAudio hands its vertices to GL. Before openGLInit this picks what it sets up,
+		//	afterwards it needs the render context. Persistent mapping falls back to orphaning without
+		//	buffer storage. Leaving it moves the rings to new buffers, the VAOs follow.
+		void setUploadStrategy(UploadStrategy strategy);
+		[[nodiscard]] UploadStrategy uploadStrategy() const { return vertexRing.segmentSize() ? vertexRing.strategy() : requestedUpload; }
+
+		//	CPU time spent generating and uploading the vertices, averaged since the last reset
+		[[nodiscard]] std::chrono::nanoseconds getAverageUploadTime() const;
+		void resetUploadTime() { uploadTime = {}; uploadFrames = 0; }
+
 	private:
 		bool getAudioSample();		//Returns false if the sample is empty
 		void vectorizeMagnitudes();
+		void downmixPacket(const AudioPacket& p);
+		bool analyseNextBlock(std::vector<float>& out);
+		bool analyseConstantQ(std::vector<float>& out, uint32_t hop);
 
 
-		GLuint defaultShaderProgram, symmetricShaderProgram, doubleSymmetricShaderProgram;
-		GLuint colorLocation1, colorLocation2, colorLocation3, barCountUniform1, barCountUniform2, barCountUniform3;
+		GLuint defaultShaderProgram, symmetricShaderProgram, doubleSymmetricShaderProgram, instancedShaderProgram, fullscreenShaderProgram;
+		RenderManager renderManager;
+		ProgramCache programCache{ ProgramCache::defaultDirectory() };
 
-		// WASAPI interfaces
-		IMMDeviceEnumerator* pEnumerator = nullptr;
-		IMMDevice* pDevice = nullptr;
-		IAudioClient* pAudioClient = nullptr;
-		IAudioCaptureClient* pCaptureClient = nullptr;
-		REFERENCE_TIME hnsRequestedDuration = REFTIMES_PER_SEC;
+		//	Capture backend, null if the platform has none
+		std::unique_ptr<AudioSource> source;
+		AudioPacket packet;		//	Packet currently held from the source
 
 		bool validAudioDevice = true;	//	For CI tests, no audio device present
+		AudioFormat sourceFormat;		//	Channels and sample format of the packets from source
 
-		// Global GUID's for devices
-		const CLSID CLSID_MMDeviceEnumerator = __uuidof(MMDeviceEnumerator);
-		const IID IID_IMMDeviceEnumerator = __uuidof(IMMDeviceEnumerator);
-		const IID IID_IAudioClient = __uuidof(IAudioClient);
-		const IID IID_IAudioCaptureClient = __uuidof(IAudioCaptureClient);
-
-		//	For capture client
-		BYTE* pData = nullptr;
-		UINT32 numFramesAvailable = 0;
-		DWORD flags = 0;
-		HRESULT hr = 0;
-		int numChannels = 0;
-
-		// Struct to describe the audio properties
-		WAVEFORMATEX* pwfx = nullptr;
-
-		// Kiss FFT
-		kiss_fft_cfg cfg = nullptr;
-		std::vector<kiss_fft_cpx> audioSample;
-		std::vector<kiss_fft_cpx> visualData;
+		//	Real input transform, only the FFT_COUNT / 2 + 1 non-redundant bins are produced
+		std::unique_ptr<SpectrumFft> spectrumFft;
+		std::vector<float> spectrumRe;
+		std::vector<float> spectrumIm;
 
 		// Data for visualization
 		std::vector<float> magnitudes;
-		std::vector<float> prevMagnitudes;
 
-		// Accumulator for audio data
-		std::vector<float> accumulator;
+		//	All FFT bins folded onto barCount bars, render thread only
+		void binBars();
+		BarBinner barBinner;
+		std::vector<float> barHeights;
+		std::vector<float> prevBarHeights;		//	Raw bar heights of the last frame, for smoothing
+
+		//	Only runs when the resolved bar count changes, the buffers never grow past their reservation
+		void resizeBars(unsigned int count);
+		unsigned int barCount = 0;
+
+		//	Mono samples between capture (producer) and analysis (consumer)
+		std::unique_ptr<SpscRingBuffer<float>> sampleRing;
+		std::vector<float> fftInput;
+
+		//	Capture time of the last sample of every packet, by its position in sampleRing. Same producer
+		//	and consumer as the ring, the analysis side times each window against them.
+		struct CaptureStamp {
+			uint64_t end = 0;		//	sampleRing->totalWritten() after the packet
+			std::chrono::steady_clock::time_point time;
+		};
+		std::unique_ptr<SpscRingBuffer<CaptureStamp>> stampRing;
+		CaptureStamp windowStamp;		//	Consumer side, the stamp the last window was timed against
+		std::chrono::steady_clock::time_point analysedCaptureTime;	//	Newest sample of the last window analysed
+		std::chrono::steady_clock::time_point sampleCaptureTime(uint64_t end);
+		[[nodiscard]] std::chrono::steady_clock::duration framesDuration(int64_t count) const;
+
+		//	Overlapping windows over sampleRing, only touched by whichever thread consumes the ring
+		Stft stft{ FFT_COUNT, FFT_HOP };
+		std::atomic<uint32_t> requestedHop{ FFT_HOP };
+		std::atomic<WindowType> requestedWindow{ WindowType::Hann };
+
+		//	Constant-Q analysis over longer windows of the same ring, empty until setAnalysis() first picks it.
+		//	Its bins go into the front of magnitudes, the rest stay 0.
+		ConstantQ constantQ;
+		Stft cqtStft{ CQT_FFT_SIZE, FFT_HOP };
+		std::unique_ptr<ConstantQFft> cqtFft;
+		std::vector<float> cqtInput, cqtRe, cqtIm, cqtBinRe, cqtBinIm;
+		std::atomic<SpectrumAnalysis> requestedAnalysis{ SpectrumAnalysis::Fft };
+		SpectrumAnalysis lastAnalysis = SpectrumAnalysis::Fft;		//	Consumer side, of the last window
+		SpectrumAnalysis consumedAnalysis = SpectrumAnalysis::Fft;	//	Render thread, of magnitudes
+
+		//	Capture and analysis threads, and the handoff of finished spectra to the render thread
+		std::unique_ptr<CaptureThread> captureThread;
+		std::thread analysisThread;
+		std::atomic<bool> stopAnalysis{ false };
+		std::atomic<uint32_t> samplesPublished{ 0 };	//	Bumped by capture after every push, analysis waits on it
+		TripleBuffer<SpectrumFrame> spectrumHandoff;	//	Analysis writes, render reads, neither blocks
+		uint64_t publishedSequence = 0;				//	Analysis thread only
+		uint64_t consumedSequence = 0;				//	Render thread only
+		std::chrono::steady_clock::time_point consumedCaptureTime;	//	Render thread only
+		std::atomic<float> spectrumScale{ 108.0f };	//	windowHeight / 10, written by the render thread
+
+		void onCapturedPacket(const AudioPacket& p);
+		void analysisLoop();
+		void publishSpectrum();
+		bool consumeLatestSpectrum();
 
 		//	Get the color data for bars
 		void genColors();
@@ -139,21 +284,32 @@ class AudioManager {
 		//	Minimal vertices are the points at the top left of each bar
 		//	The purpose of this is to reduce the buffer size as much as possible
 		//	and to compute as much on the GPU as we can
-		void genMinVerts();
-		std::vector<float> minVerts;
-
-		//	Smooths the magnitudes CPU side before they are translated into vertices
-		//	GPU side someday?
-		void smoothMagnitudes();
+		//	Written straight into the vertex ring, barCount * 2 floats
+		void genMinVerts(float* minVerts) const;
+		[[nodiscard]] std::pair<float, float> minVertScales() const;	//	x step per bar, y per unit of bar height
+
+		//	RenderPath::Instanced and Fullscreen, the bar heights are the only per frame data
+		//	Top of each bar as genMinVerts places it, halved and normalised to uint16
+		void genBarHeights(uint16_t* heights) const;
+		VertexRing heightRing;
+		GLuint instancedVAO = 0;
+		GLuint instancedDivisor = 1;	//	2 in double symmetric mode, both instances of a bar read its height
+		GLuint fullscreenVAO = 0;		//	No attributes, core profile still needs one bound to draw
+		GLuint heightTexture = 0;		//	GL_R16 buffer texture over heightRing
+
+		//	Vertex upload, one MAX_BAR_COUNT segment per frame in flight
+		VertexRing vertexRing;
+		GLuint vertexArray = 0;			//	The caller's VAO from openGLInit, attribute 0 reads vertexRing
+		UploadStrategy requestedUpload = UploadStrategy::PersistentMapped;
+		std::chrono::nanoseconds uploadTime{ 0 };
+		uint64_t uploadFrames = 0;
+
+		//	Smooths the binned bar heights CPU side before they are translated into vertices
+		void smoothBars();
+
+		//	settings.gpuSmoothing: smooths the same bar heights and builds their vertices on the GPU instead.
+		//	Geometry shader path only, Instanced and Fullscreen always smooth on the CPU.
+		GpuSmoother gpuSmoother;
+		[[nodiscard]] GLuint modeProgram() const;
 };		
 
-static std::string fileToString(const char* path) {
-	std::ifstream file;
-	file.open(path);
-
-	if (!file) throw std::invalid_argument(std::string("Unable to open file: ") + path);
-
-	std::ostringstream ss;
-	ss << file.rdbuf();
-	return ss.str();
-}
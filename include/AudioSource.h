@@ -0,0 +1,107 @@
+#pragma once
+
+//	Abstract audio sampler. Every capture backend (WASAPI loopback, synthetic test signals,
+//	memory-mapped WAV files) hands out interleaved frames through this interface so the
+//	DSP and render path never touch a platform API directly.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+enum class SampleFormat {
+	Float32,
+	Int16,
+	Int24,		//	Packed, 3 bytes per sample
+	Int32
+};
+
+struct AudioFormat {
+	uint32_t sampleRate = 48000;
+	uint16_t channels = 2;
+	SampleFormat sampleFormat = SampleFormat::Float32;
+
+	[[nodiscard]] size_t bytesPerSample() const {
+		switch (sampleFormat) {
+		case SampleFormat::Int16: return 2;
+		case SampleFormat::Int24: return 3;
+		default: return 4;
+		}
+	}
+	[[nodiscard]] size_t bytesPerFrame() const { return bytesPerSample() * channels; }
+};
+
+//	Zero copy view of one packet of interleaved frames
+//	Only valid until releasePacket() is called on the source that produced it
+struct AudioPacket {
+	const std::byte* data = nullptr;
+	uint32_t frames = 0;
+	bool silent = false;
+	//	When the newest frame was captured: the device clock where there is one, the pacer's due time for
+	//	realtime files and generators, the acquire otherwise. Left at zero, the consumer stamps it on arrival.
+	std::chrono::steady_clock::time_point captureTime{};
+};
+
+class AudioSource {
+public:
+	virtual ~AudioSource() = default;
+
+	[[nodiscard]] virtual AudioFormat format() const = 0;
+
+	//	False if the source has no usable device/data behind it (CI runners etc.)
+	[[nodiscard]] virtual bool isValid() const { return true; }
+
+	//	Returns false if there is no packet ready. A successful acquire must be
+	//	paired with releasePacket() before the next acquire.
+	virtual bool acquirePacket(AudioPacket& packet) = 0;
+	virtual void releasePacket() = 0;
+
+	//	Blocks until a packet is likely ready or the timeout expires. Returns false on timeout.
+	//	Sources that can always produce data return immediately.
+	virtual bool waitForPacket(std::chrono::milliseconds /*timeout*/) { return true; }
+
+	//	Called on the capture thread before the first and after the last acquire
+	virtual void onCaptureThreadStart() {}
+	virtual void onCaptureThreadStop() {}
+
+	AudioSource() = default;
+	AudioSource(const AudioSource&) = delete;
+	AudioSource& operator=(const AudioSource&) = delete;
+};
+
+
+//	Paces sources that could hand out data instantly (files, generators) to the wall clock,
+//	so the capture thread sees packets at the cadence a real device would deliver them
+class RealtimePacer {
+	using clock = std::chrono::steady_clock;
+
+public:
+	void reset() {
+		startTime = clock::now();
+		framesReleased = 0;
+	}
+
+	//	True once a packet of the given size, following everything released so far, has "arrived"
+	[[nodiscard]] bool ready(const uint32_t frames, const uint32_t sampleRate) const {
+		return clock::now() >= dueTime(frames, sampleRate);
+	}
+
+	void advance(const uint32_t frames) { framesReleased += frames; }
+
+	//	When the newest frame released so far was due, the capture time of the packet it ended
+	[[nodiscard]] clock::time_point releasedUntil(const uint32_t sampleRate) const { return dueTime(0, sampleRate); }
+
+	void waitUntilReady(const uint32_t frames, const uint32_t sampleRate, const std::chrono::milliseconds timeout) const {
+		std::this_thread::sleep_until(std::min(dueTime(frames, sampleRate), clock::now() + timeout));
+	}
+
+private:
+	[[nodiscard]] clock::time_point dueTime(const uint32_t frames, const uint32_t sampleRate) const {
+		const auto ns = (framesReleased + frames) * 1000000000ull / sampleRate;
+		return startTime + std::chrono::nanoseconds(ns);
+	}
+
+	clock::time_point startTime = clock::now();
+	uint64_t framesReleased = 0;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+//	Maps every FFT (or constant-Q) bin onto the bars with linear, log, mel or octave spacing.
+//	The mapping is a sparse bar x bin weight table in CSR form, rebuilt only when the layout changes.
+//	A bar always covers a contiguous run of bins, so each row only stores its first bin and the
+//	per frame pass is a unit stride weighted sum per bar with no index gather.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class BarScale {
+	Linear,
+	Log,
+	Mel,
+	Octave		//	Fractional octave bands anchored at 1 kHz
+};
+
+constexpr const char* BAR_SCALE_NAMES[] = { "Linear", "Log", "Mel", "Octave" };
+
+struct BarLayout {
+	size_t binCount = 0;		//	Bins in the spectrum, bin k sits at k * sampleRate / fftSize
+	size_t fftSize = 0;
+	uint32_t sampleRate = 48000;
+	//	Non-zero for a constant-Q spectrum, bin k then sits at firstBinFrequency * 2^(k / binsPerOctave)
+	unsigned int binsPerOctave = 0;
+	float firstBinFrequency = 0.0f;
+	size_t barCount = 0;
+	BarScale scale = BarScale::Log;
+	float minFrequency = 20.0f;
+	float maxFrequency = 20000.0f;
+
+	bool operator==(const BarLayout&) const = default;
+};
+
+class BarBinner {
+public:
+	//	Rebuilds the weight table if the layout differs from the current one, returns true if it did
+	bool configure(const BarLayout& layout);
+
+	//	bars[b] = sum of weight * spectrum[bin] over the bins of bar b. Each bar averages the part of
+	//	the spectrum it covers, bars narrower than a bin repeat that bin.
+	void apply(const float* spectrum, float* bars) const;
+
+	[[nodiscard]] const BarLayout& layout() const { return current; }
+
+	//	Frequency edges of the bars, barCount + 1 values in Hz
+	[[nodiscard]] const std::vector<float>& edges() const { return barEdges; }
+
+	//	Non-zero weights in the table
+	[[nodiscard]] size_t weightCount() const { return weights.size(); }
+
+private:
+	void build();
+
+	//	Position of a frequency on the bin axis, bin k covers [k - 0.5, k + 0.5)
+	[[nodiscard]] double binPosition(double hz) const;
+	[[nodiscard]] double binFrequency(double position) const;
+
+	BarLayout current;
+	std::vector<float> barEdges;
+
+	//	CSR: bar b weighs bins firstBin[b], firstBin[b] + 1, ... with weights[rowStart[b] .. rowStart[b + 1])
+	std::vector<uint32_t> rowStart;
+	std::vector<uint32_t> firstBin;
+	std::vector<float> weights;
+};
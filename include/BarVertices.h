@@ -0,0 +1,40 @@
+#pragma once
+
+//	Per frame bar math, shared by AudioManager, GpuSmoother and the headless DSP benchmarks.
+//	horizScale is the x step per bar and vertScale the y per unit of bar height, both in clip space.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+//	Decay rule shared by the CPU smoothing and the feedback shader: rising values jump to their
+//	target, falling values blend with the previous frame
+inline float smoothedHeight(const float coef, const float previous, const float target)
+{
+	return previous >= target ? coef * previous + (1.0f - coef) * target : target;
+}
+
+
+//	Top of a bar in clip space, with a floor so empty bars stay visible
+inline float barTop(const float height, const float vertScale)
+{
+	return height <= 0.01f ? 0.01f : height * vertScale + 0.01f;
+}
+
+
+//	Minimal vertices, the top left point of each bar, count * 2 floats
+inline void genBarVertices(const float* heights, const size_t count, const float horizScale, const float vertScale, float* vertices)
+{
+	for (size_t i = 0; i < count; i++) {
+		vertices[i * 2] = static_cast<float>(i) * horizScale - 1.0f;
+		vertices[i * 2 + 1] = barTop(heights[i], vertScale);
+	}
+}
+
+
+//	Bar tops halved and normalised to uint16, for the instanced and fullscreen paths
+inline void genBarHeights16(const float* heights, const size_t count, const float vertScale, uint16_t* out)
+{
+	for (size_t i = 0; i < count; i++)
+		out[i] = static_cast<uint16_t>(std::min(barTop(heights[i], vertScale), 2.0f) * (0.5f * 65535.0f) + 0.5f);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+//	Dedicated capture thread. Sleeps until the source signals a buffer (or a short timeout passes),
+//	then drains every packet into the sink so capture cadence no longer depends on the frame rate.
+
+#include "AudioSource.h"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <thread>
+
+class CaptureThread {
+public:
+	//	Called on the capture thread for every packet, the packet is released right after
+	using PacketSink = std::function<void(const AudioPacket&)>;
+
+	CaptureThread(AudioSource& source, PacketSink sink);
+	~CaptureThread() noexcept;
+
+	CaptureThread(const CaptureThread&) = delete;
+	CaptureThread& operator=(const CaptureThread&) = delete;
+
+	void start();
+	void stop() noexcept;
+
+	[[nodiscard]] bool running() const { return thread.joinable(); }
+	[[nodiscard]] uint64_t packetsCaptured() const { return packetCounter.load(std::memory_order_relaxed); }
+
+	//	Rethrows anything the source threw on the capture thread, no-op otherwise
+	void rethrowIfFailed();
+
+	//	Longest time the thread sleeps before polling the source again
+	static constexpr std::chrono::milliseconds WAIT_TIMEOUT{ 20 };
+
+private:
+	void run();
+
+	AudioSource& source;
+	PacketSink sink;
+
+	std::thread thread;
+	std::atomic<bool> stopRequested{ false };
+	std::atomic<bool> failed{ false };
+	std::atomic<uint64_t> packetCounter{ 0 };
+	std::exception_ptr error;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+//	Constant-Q / variable-Q spectrum computed from one large real FFT (Brown and Puckette's efficient CQT).
+//	Bin k sits at minFrequency * 2^(k / binsPerOctave). Its temporal kernel is a Hann windowed complex
+//	exponential fs / (alpha * f_k + gamma) samples long, with alpha = 2^(1 / binsPerOctave) - 1: gamma = 0
+//	is constant-Q, gamma > 0 widens the low bins (variable-Q) so their windows get shorter. Kernels that
+//	would be longer than the FFT are cut to it. Every kernel ends on the newest sample of the frame instead
+//	of being centred, so the short high frequency kernels only look at the most recent audio.
+//	The spectra of the kernels are computed once. Each keeps only the contiguous run of FFT bins around its
+//	peak that is above threshold, stored in CSR form like BarBinner's weights, so a frame costs the FFT plus
+//	a short complex dot product per bin.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class SpectrumAnalysis {
+	Fft,			//	FFT_COUNT point FFT, linear bins
+	ConstantQ		//	CQT_FFT_SIZE point FFT through the constant-Q kernels, musically spaced bins
+};
+
+constexpr const char* SPECTRUM_ANALYSIS_NAMES[] = { "FFT", "Constant-Q" };
+
+struct ConstantQLayout {
+	uint32_t sampleRate = 48000;
+	size_t fftSize = 8192;			//	Even, the frame length and the longest possible kernel
+	float minFrequency = 32.7f;
+	float maxFrequency = 20000.0f;	//	Capped at 0.45 * sampleRate
+	unsigned int binsPerOctave = 24;
+	float gamma = 0.0f;				//	Hz added to every bandwidth, 0 for constant-Q
+	float threshold = 0.0054f;		//	Kernel spectrum values below this fraction of their peak are dropped
+	float gain = 1.0f;				//	A sine of amplitude a at a bin centre comes out at gain * a / 4
+
+	bool operator==(const ConstantQLayout&) const = default;
+};
+
+class ConstantQ {
+public:
+	//	Rebuilds the kernels if the layout differs from the current one, returns true if it did
+	bool configure(const ConstantQLayout& layout);
+
+	//	re and im hold the fftSize / 2 + 1 bins of a real FFT of the frame (oldest sample first),
+	//	outRe and outIm get binCount() complex values
+	void apply(const float* re, const float* im, float* outRe, float* outIm) const;
+
+	[[nodiscard]] const ConstantQLayout& layout() const { return current; }
+	[[nodiscard]] size_t binCount() const { return firstBin.size(); }
+	[[nodiscard]] float binFrequency(size_t bin) const;
+
+	//	Temporal kernel length of bin in samples, the lowest bin has the longest
+	[[nodiscard]] size_t kernelLength(size_t bin) const { return lengths[bin]; }
+	[[nodiscard]] size_t longestKernel() const { return lengths.empty() ? 0 : lengths.front(); }
+
+	//	Complex weights kept over all kernels
+	[[nodiscard]] size_t weightCount() const { return weightsRe.size(); }
+
+private:
+	void build();
+
+	ConstantQLayout current;
+	std::vector<size_t> lengths;
+
+	//	CSR: bin k weighs FFT bins firstBin[k], firstBin[k] + 1, ... with weights[rowStart[k] .. rowStart[k + 1])
+	std::vector<uint32_t> rowStart;
+	std::vector<uint32_t> firstBin;
+	std::vector<float> weightsRe;
+	std::vector<float> weightsIm;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+//	constexpr stand-ins for the few <cmath> functions needed to build lookup tables at compile time.
+//	Double precision throughout, tables are rounded to float once at the end.
+
+constexpr double PI = 3.14159265358979323846;
+
+//	Wraps x into [-pi, pi]
+constexpr double reduceAngle(const double x)
+{
+	const double turns = x / (2.0 * PI);
+	const auto whole = static_cast<long long>(turns >= 0.0 ? turns + 0.5 : turns - 0.5);
+	return x - static_cast<double>(whole) * 2.0 * PI;
+}
+
+
+//	Taylor series, accurate to double precision for |x| <= pi / 2
+constexpr double taylorSin(const double x)
+{
+	const double x2 = x * x;
+	double term = x, sum = x;
+	for (int n = 1; n < 12; n++) {
+		term *= -x2 / static_cast<double>((2 * n) * (2 * n + 1));
+		sum += term;
+	}
+	return sum;
+}
+
+
+constexpr double constexprSin(double x)
+{
+	x = reduceAngle(x);
+
+	//	sin(pi - x) == sin(x) folds the outer quarters onto the Taylor range
+	if (x > PI / 2.0) x = PI - x;
+	else if (x < -PI / 2.0) x = -PI - x;
+	return taylorSin(x);
+}
+
+
+constexpr double constexprCos(const double x)
+{
+	return constexprSin(x + PI / 2.0);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+//	Interleaved N-channel frames in any SampleFormat to mono float, in one pass.
+//	Channels are averaged and integer samples scaled to [-1, 1), so the analysis never sees
+//	raw PCM reinterpreted as float and multichannel endpoints are mixed rather than ignored.
+
+#include "AudioSource.h"
+
+#include <cstddef>
+#include <cstdint>
+
+//	Reads frames * channels samples from in and writes frames mono samples to out
+void downmixToMono(const std::byte* in, SampleFormat format, uint16_t channels, float* out, size_t frames);
@@ -0,0 +1,251 @@
+#pragma once
+
+//	Compile-time specialised FFT on split real/imaginary (SoA) arrays.
+//	The radix plan and the twiddle table are built with constexpr, and every stage is instantiated
+//	with its radix, length and stride as template arguments, so the butterflies are fixed size
+//	float loops the compiler can unroll and vectorise. Stockham autosort, no bit reversal pass.
+//	Supports N = 2^a * 3^b * 5^c, which covers FFT_COUNT = 480 and the powers of two 512 to 8192.
+
+#include "ConstexprMath.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+constexpr size_t FFT_MAX_STAGES = 32;
+
+struct FftPlan {
+	std::array<uint8_t, FFT_MAX_STAGES> radices{};
+	size_t stages = 0;
+	bool supported = false;
+};
+
+
+//	Radix 4 first for the fewest passes over the data, then the leftover 2, 3 and 5 factors
+constexpr FftPlan makeFftPlan(size_t n)
+{
+	FftPlan plan;
+	if (n < 2) return plan;
+
+	for (const size_t radix : { 4, 2, 3, 5 }) {
+		while (n % radix == 0 && plan.stages < FFT_MAX_STAGES) {
+			plan.radices[plan.stages++] = static_cast<uint8_t>(radix);
+			n /= radix;
+		}
+	}
+
+	plan.supported = n == 1;
+	return plan;
+}
+
+
+constexpr bool fftSupportsSize(const size_t n)
+{
+	return makeFftPlan(n).supported;
+}
+
+
+//	W_N^k = exp(-2 pi i k / N) for k in [0, N)
+template <size_t N>
+struct FftTwiddles {
+	std::array<float, N> re{};
+	std::array<float, N> im{};
+};
+
+
+template <size_t N>
+constexpr FftTwiddles<N> makeFftTwiddles()
+{
+	FftTwiddles<N> w;
+	for (size_t k = 0; k < N; k++) {
+		const double angle = -2.0 * PI * static_cast<double>(k) / static_cast<double>(N);
+		w.re[k] = static_cast<float>(constexprCos(angle));
+		w.im[k] = static_cast<float>(constexprSin(angle));
+	}
+	return w;
+}
+
+
+template <size_t N>
+inline constexpr FftTwiddles<N> FFT_TWIDDLES = makeFftTwiddles<N>();
+
+
+// ----------------------------------------------------
+// Complex transform
+// ----------------------------------------------------
+
+//	Holds two N float scratch arrays, allocate large sizes on the heap
+template <size_t N>
+class Fft {
+	static constexpr FftPlan plan = makeFftPlan(N);
+	static_assert(plan.supported, "Fft<N> needs N >= 2 of the form 2^a * 3^b * 5^c");
+
+public:
+	static constexpr size_t size = N;
+
+	//	Forward transform, unnormalised like kissfft. Input and output must not alias.
+	void forward(const float* inRe, const float* inIm, float* outRe, float* outIm)
+	{
+		runStage<0, N, 1>(inRe, inIm, outRe, outIm);
+	}
+
+private:
+	template <size_t Stage, size_t Len, size_t Stride>
+	void runStage(const float* xr, const float* xi, float* outRe, float* outIm)
+	{
+		if constexpr (Stage < plan.stages) {
+			constexpr size_t radix = plan.radices[Stage];
+
+			//	Stages ping-pong between out and scratch, chosen so that the last one lands in out
+			constexpr bool toOut = (plan.stages - 1 - Stage) % 2 == 0;
+			float* yr = toOut ? outRe : scratchRe.data();
+			float* yi = toOut ? outIm : scratchIm.data();
+
+			butterflies<radix, Len, Stride>(xr, xi, yr, yi);
+			runStage<Stage + 1, Len / radix, Stride * radix>(yr, yi, outRe, outIm);
+		}
+	}
+
+	//	One Stockham pass over sub-transforms of length Len, Stride of them interleaved:
+	//	y[q + Stride * (R * p + j)] = (sum_k x[q + Stride * (p + k * Len / R)] * W_R^(j * k)) * W_Len^(j * p)
+	template <size_t R, size_t Len, size_t Stride>
+	static void butterflies(const float* __restrict xr, const float* __restrict xi, float* __restrict yr, float* __restrict yi)
+	{
+		constexpr size_t m = Len / R;
+		constexpr size_t twiddleStep = N / Len;
+		const auto& tw = FFT_TWIDDLES<N>;
+
+		for (size_t p = 0; p < m; p++) {
+			float wr[R], wi[R];
+			for (size_t j = 1; j < R; j++) {
+				wr[j] = tw.re[j * p * twiddleStep];
+				wi[j] = tw.im[j * p * twiddleStep];
+			}
+
+			const size_t in = Stride * p;
+			const size_t out = Stride * R * p;
+
+			//	Unit stride over q, this is the loop that vectorises
+			for (size_t q = 0; q < Stride; q++) {
+				float ar[R], ai[R], br[R], bi[R];
+				for (size_t k = 0; k < R; k++) {
+					ar[k] = xr[in + q + Stride * m * k];
+					ai[k] = xi[in + q + Stride * m * k];
+				}
+
+				if constexpr (R == 2) {
+					br[0] = ar[0] + ar[1];	bi[0] = ai[0] + ai[1];
+					br[1] = ar[0] - ar[1];	bi[1] = ai[0] - ai[1];
+				}
+				else if constexpr (R == 3) {
+					//	W_3 = -1/2 - i sqrt(3)/2
+					constexpr float s = 0.86602540378443865f;
+					const float sr = ar[1] + ar[2], si = ai[1] + ai[2];
+					const float dr = ar[1] - ar[2], di = ai[1] - ai[2];
+					const float mr = ar[0] - 0.5f * sr, mi = ai[0] - 0.5f * si;
+					br[0] = ar[0] + sr;		bi[0] = ai[0] + si;
+					br[1] = mr + s * di;	bi[1] = mi - s * dr;
+					br[2] = mr - s * di;	bi[2] = mi + s * dr;
+				}
+				else if constexpr (R == 4) {
+					//	W_4 = -i
+					const float t0r = ar[0] + ar[2], t0i = ai[0] + ai[2];
+					const float t1r = ar[0] - ar[2], t1i = ai[0] - ai[2];
+					const float t2r = ar[1] + ar[3], t2i = ai[1] + ai[3];
+					const float t3r = ai[1] - ai[3], t3i = ar[3] - ar[1];	//	-i * (a1 - a3)
+					br[0] = t0r + t2r;		bi[0] = t0i + t2i;
+					br[1] = t1r + t3r;		bi[1] = t1i + t3i;
+					br[2] = t0r - t2r;		bi[2] = t0i - t2i;
+					br[3] = t1r - t3r;		bi[3] = t1i - t3i;
+				}
+				else if constexpr (R == 5) {
+					constexpr float c1 = 0.30901699437494742f, c2 = -0.80901699437494742f;	//	cos 72, cos 144
+					constexpr float s1 = 0.95105651629515357f, s2 = 0.58778525229247313f;	//	sin 72, sin 144
+					const float p1r = ar[1] + ar[4], p1i = ai[1] + ai[4];
+					const float d1r = ar[1] - ar[4], d1i = ai[1] - ai[4];
+					const float p2r = ar[2] + ar[3], p2i = ai[2] + ai[3];
+					const float d2r = ar[2] - ar[3], d2i = ai[2] - ai[3];
+					const float m1r = ar[0] + c1 * p1r + c2 * p2r, m1i = ai[0] + c1 * p1i + c2 * p2i;
+					const float m2r = ar[0] + c2 * p1r + c1 * p2r, m2i = ai[0] + c2 * p1i + c1 * p2i;
+
+					//	-i * (s1 d1 + s2 d2) and -i * (s2 d1 - s1 d2)
+					const float e1r = s1 * d1i + s2 * d2i, e1i = -(s1 * d1r + s2 * d2r);
+					const float e2r = s2 * d1i - s1 * d2i, e2i = -(s2 * d1r - s1 * d2r);
+					br[0] = ar[0] + p1r + p2r;	bi[0] = ai[0] + p1i + p2i;
+					br[1] = m1r + e1r;		bi[1] = m1i + e1i;
+					br[2] = m2r + e2r;		bi[2] = m2i + e2i;
+					br[3] = m2r - e2r;		bi[3] = m2i - e2i;
+					br[4] = m1r - e1r;		bi[4] = m1i - e1i;
+				}
+				else {
+					static_assert(R == 2, "No butterfly for this radix");
+				}
+
+				yr[out + q] = br[0];
+				yi[out + q] = bi[0];
+				for (size_t j = 1; j < R; j++) {
+					yr[out + q + Stride * j] = br[j] * wr[j] - bi[j] * wi[j];
+					yi[out + q + Stride * j] = br[j] * wi[j] + bi[j] * wr[j];
+				}
+			}
+		}
+	}
+
+	std::array<float, N> scratchRe{};
+	std::array<float, N> scratchIm{};
+};
+
+
+// ----------------------------------------------------
+// Real transform
+// ----------------------------------------------------
+
+//	Real input of length N packed into a complex Fft<N / 2> (even samples real, odd samples imaginary),
+//	then split back into the N / 2 + 1 non-redundant bins
+template <size_t N>
+class RealFft {
+	static_assert(N % 2 == 0, "RealFft<N> needs an even N");
+	static constexpr size_t M = N / 2;
+
+public:
+	static constexpr size_t size = N;
+	static constexpr size_t bins = M + 1;
+
+	//	in holds N samples, outRe and outIm hold bins values
+	void forward(const float* in, float* outRe, float* outIm)
+	{
+		for (size_t k = 0; k < M; k++) {
+			packedRe[k] = in[2 * k];
+			packedIm[k] = in[2 * k + 1];
+		}
+
+		fft.forward(packedRe.data(), packedIm.data(), zRe.data(), zIm.data());
+		unpack(outRe, outIm);
+	}
+
+private:
+	//	With Z = FFT(z) and W = W_N: X[k] = (Z[k] + conj(Z[M - k])) / 2 - i W^k (Z[k] - conj(Z[M - k])) / 2
+	void unpack(float* outRe, float* outIm) const
+	{
+		const auto& tw = FFT_TWIDDLES<N>;
+
+		outRe[0] = zRe[0] + zIm[0];		outIm[0] = 0.0f;
+		outRe[M] = zRe[0] - zIm[0];		outIm[M] = 0.0f;
+
+		for (size_t k = 1; k < M; k++) {
+			const float ar = zRe[k], ai = zIm[k];
+			const float br = zRe[M - k], bi = -zIm[M - k];
+
+			const float evenRe = 0.5f * (ar + br), evenIm = 0.5f * (ai + bi);
+			const float oddRe = 0.5f * (ai - bi), oddIm = -0.5f * (ar - br);
+
+			outRe[k] = evenRe + tw.re[k] * oddRe - tw.im[k] * oddIm;
+			outIm[k] = evenIm + tw.re[k] * oddIm + tw.im[k] * oddRe;
+		}
+	}
+
+	Fft<M> fft;
+	std::array<float, M> packedRe{}, packedIm{};
+	std::array<float, M> zRe{}, zIm{};
+};
@@ -1,16 +1,44 @@
 #pragma once
 
-// Number of frequency range bars to draw
-// Not being used yet
+#include <cstddef>
+
+// Number of frequency range bars to draw by default, settings.barCount changes it at runtime
 constexpr unsigned int BAR_COUNT = 64;
 
+// settings.barCount value that picks the bar count from the framebuffer width
+constexpr unsigned int BAR_COUNT_AUTO = 0;
+
+// Runtime bar count range, bar buffers are reserved for MAX_BAR_COUNT up front
+// Counts in the thousands are meant for the fullscreen render path, whose cost does not grow with bars
+constexpr unsigned int MIN_BAR_COUNT = 8;
+constexpr unsigned int MAX_BAR_COUNT = 4096;
+
+// Bar pitch the auto mode aims for, 1920 / 30 gives the default 64 bars
+constexpr unsigned int AUTO_BAR_PIXELS = 30;
+
 // How many times to retry initializing am if error occurs
 constexpr unsigned int RETRY_COUNT = 5;
 
 // How many frames are needed for kiss fft to gen a audio sample
 constexpr int FFT_COUNT = 480;
 
+// Samples the STFT advances per spectrum, 50% overlap by default
+constexpr int FFT_HOP = FFT_COUNT / 2;
+
+// Mono samples buffered between the capture and analysis threads (~0.68s at 48kHz)
+constexpr size_t SAMPLE_RING_CAPACITY = 1 << 15;
+
+// Packet capture times queued next to the sample ring, a packet that finds it full only loses its stamp
+constexpr size_t CAPTURE_STAMP_CAPACITY = 1024;
+
+// Constant-Q analysis: 24 bins per octave from C1 over one FFT of CQT_FFT_SIZE samples (~170ms at 48kHz).
+// CQT_GAMMA (Hz) widens the lowest bins (variable-Q) so their windows fit the FFT and react faster.
+constexpr size_t CQT_FFT_SIZE = 8192;
+constexpr unsigned int CQT_BINS_PER_OCTAVE = 24;
+constexpr float CQT_MIN_FREQUENCY = 32.7f;
+constexpr float CQT_GAMMA = 5.0f;
+
 #define REFTIMES_PER_SEC 1000000;
 
-// bool smoothing, uint displayModeIndex, float[4] baseColorBars, float[4] barColor float barHeightScaling, int windowHeight, int windowWidth, float smoothingCoef,
-#define DEFAULT_SETTINGS true, 0, {0.0f, 0.0f, 0.0f, 0.0f},{0.0f, 0.0f, 1.0f, 0.0f}, 1.0f, 1080, 1920, 0.9f
\ No newline at end of file
+// bool smoothing, uint displayModeIndex, float[4] baseColorBars, float[4] barColor float barHeightScaling, int windowHeight, int windowWidth, float smoothingCoef, BarScale barScale, uint barCount, bool gpuSmoothing, RenderPath renderPath
+#define DEFAULT_SETTINGS true, 0, {0.0f, 0.0f, 0.0f, 0.0f},{0.0f, 0.0f, 1.0f, 0.0f}, 1.0f, 1080, 1920, 0.9f, BarScale::Log, BAR_COUNT, false, RenderPath::Instanced
\ No newline at end of file
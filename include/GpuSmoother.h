@@ -0,0 +1,47 @@
+#pragma once
+
+//	Bar smoothing as a transform feedback pass, so the decay filter leaves the render thread.
+//	The previous raw bar heights stay on the GPU in two buffers that swap every frame, the CPU only
+//	uploads the new raw bar heights. The pass writes the bar vertices straight into the buffer
+//	behind vertexArray(), which is then drawn instead of the CPU generated vertices.
+
+#include "BarVertices.h"
+#include "VertexRing.h"
+
+#include <array>
+#include <cstddef>
+
+class GpuSmoother {
+public:
+	//	Links vertexShader (shaders/smoothing.vert) into the feedback program and sizes every buffer for
+	//	maxBars. Needs a current context. Returns false if the program fails to link.
+	bool init(GLuint vertexShader, size_t maxBars, UploadStrategy upload = UploadStrategy::PersistentMapped);
+
+	//	Smooths count bars against the previous frame and writes their vertices, leaves the feedback
+	//	program bound. horizScale and vertScale place the vertices as genMinVerts does.
+	void run(const float* targets, size_t count, float coef, float horizScale, float vertScale);
+
+	//	Forgets the previous heights, e.g. after the bars were re-laid out
+	void reset();
+
+	//	How the raw bar heights are uploaded, see VertexRing::setStrategy
+	void setUploadStrategy(UploadStrategy upload) { if (ready()) targetRing.setStrategy(upload); }
+
+	[[nodiscard]] bool ready() const { return program != 0; }
+
+	//	Draws the smoothed bars, attribute 0 holds one vec2 per bar like the main VAO
+	[[nodiscard]] GLuint vertexArray() const { return drawArray; }
+	[[nodiscard]] GLuint vertexBuffer() const { return vertices; }
+
+private:
+	GLuint program = 0;
+	GLint coefLocation = -1, horizScaleLocation = -1, vertScaleLocation = -1;
+
+	VertexRing targetRing;					//	Raw bar heights, one float per bar
+	std::array<GLuint, 2> state{};			//	Previous raw heights, read one and write the other
+	size_t readState = 0;
+	GLuint feedbackArray = 0;				//	Attribute 0 from targetRing, 1 from state[readState]
+	GLuint vertices = 0;
+	GLuint drawArray = 0;
+	size_t capacity = 0;
+};
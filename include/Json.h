@@ -0,0 +1,64 @@
+#pragma once
+
+//	Minimal JSON document for the benchmark reports: enough to write them and to read them back in
+//	BenchCompare. Objects keep their insertion order so reports diff cleanly. Numbers are doubles,
+//	which hold every nanosecond count a report can contain exactly.
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+class JsonValue {
+public:
+	using Array = std::vector<JsonValue>;
+	using Object = std::vector<std::pair<std::string, JsonValue>>;
+
+	JsonValue() = default;
+	JsonValue(std::nullptr_t) {}
+	JsonValue(bool b) : value(b) {}
+	JsonValue(double n) : value(n) {}
+	JsonValue(int n) : value(static_cast<double>(n)) {}
+	JsonValue(unsigned int n) : value(static_cast<double>(n)) {}
+	JsonValue(uint64_t n) : value(static_cast<double>(n)) {}
+	JsonValue(const char* s) : value(std::string(s)) {}
+	JsonValue(std::string s) : value(std::move(s)) {}
+	JsonValue(Array a) : value(std::move(a)) {}
+	JsonValue(Object o) : value(std::move(o)) {}
+
+	//	Throws std::runtime_error with the offset of the first error
+	static JsonValue parse(std::string_view text);
+
+	//	Pretty printed with two space indents, short arrays of numbers stay on one line
+	void write(std::ostream& out, int indent = 0) const;
+
+	[[nodiscard]] bool isNull() const { return std::holds_alternative<std::nullptr_t>(value); }
+	[[nodiscard]] bool isNumber() const { return std::holds_alternative<double>(value); }
+	[[nodiscard]] bool isString() const { return std::holds_alternative<std::string>(value); }
+	[[nodiscard]] bool isArray() const { return std::holds_alternative<Array>(value); }
+	[[nodiscard]] bool isObject() const { return std::holds_alternative<Object>(value); }
+
+	//	Throw std::runtime_error if the value is of another type
+	[[nodiscard]] double number() const;
+	[[nodiscard]] const std::string& string() const;
+	[[nodiscard]] const Array& array() const;
+	[[nodiscard]] const Object& object() const;
+
+	//	Member of an object, null if this is not an object or has no such key
+	[[nodiscard]] const JsonValue* find(std::string_view key) const;
+
+	//	Appends a member to an object
+	JsonValue& set(std::string key, JsonValue member);
+
+private:
+	std::variant<std::nullptr_t, bool, double, std::string, Array, Object> value;
+};
+
+inline std::ostream& operator<<(std::ostream& out, const JsonValue& json)
+{
+	json.write(out);
+	return out;
+}
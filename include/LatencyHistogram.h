@@ -0,0 +1,108 @@
+#pragma once
+
+//  Log-bucketed (HDR style) histogram of latencies in integer nanoseconds.
+//  Every power of two range is split into 2^SUB_BUCKET_BITS linear buckets, so any recorded value is
+//  known to within 1 / 2^SUB_BUCKET_BITS (under 1%) of itself, from 1 ns up to MAX_VALUE.
+//  record() is a handful of integer ops on fixed storage, cheap enough for every frame.
+//  min, max, mean and standard deviation are exact, percentiles are bucket accurate.
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 7;
+    static constexpr unsigned MAX_EXPONENT = 40;                //  2^40 ns, about 18 minutes
+    static constexpr uint64_t MAX_VALUE = (uint64_t(1) << MAX_EXPONENT) - 1;  //  Larger values are clamped
+
+    void record(const uint64_t value)
+    {
+        const uint64_t v = std::min(value, MAX_VALUE);
+        buckets[bucketIndex(v)]++;
+        total++;
+        sum += v;
+        sumSquares += static_cast<double>(v) * static_cast<double>(v);
+        minimum = std::min(minimum, v);
+        maximum = std::max(maximum, v);
+    }
+
+    void record(const std::chrono::nanoseconds value) { record(static_cast<uint64_t>(std::max<int64_t>(value.count(), 0))); }
+
+    void reset() { *this = LatencyHistogram(); }
+
+    [[nodiscard]] uint64_t count() const { return total; }
+    [[nodiscard]] uint64_t min() const { return total ? minimum : 0; }
+    [[nodiscard]] uint64_t max() const { return maximum; }
+    [[nodiscard]] double mean() const { return total ? static_cast<double>(sum) / static_cast<double>(total) : 0.0; }
+
+    [[nodiscard]] double stddev() const
+    {
+        if (total == 0) return 0.0;
+        const double m = mean();
+        return std::sqrt(std::max(sumSquares / static_cast<double>(total) - m * m, 0.0));
+    }
+
+    //  Smallest value at or below which percent of the recorded values fall, 0 to 100.
+    //  Reported as the top of the value's bucket, clamped to the recorded min and max.
+    [[nodiscard]] uint64_t percentile(const double percent) const
+    {
+        if (total == 0) return 0;
+
+        const double clamped = std::clamp(percent, 0.0, 100.0);
+        const auto rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total))), 1);
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += buckets[i];
+            if (seen >= rank) return std::clamp(bucketTop(i), min(), maximum);
+        }
+        return maximum;
+    }
+
+    //  Calls visit(top, count) for every non-empty bucket from the smallest values up,
+    //  top being the largest value the bucket holds
+    template <typename Visit>
+    void forEachBucket(Visit&& visit) const
+    {
+        for (size_t i = 0; i < BUCKET_COUNT; i++)
+            if (buckets[i]) visit(bucketTop(i), buckets[i]);
+    }
+
+private:
+    static constexpr uint64_t SUB_BUCKETS = uint64_t(1) << SUB_BUCKET_BITS;
+
+    //  Values below SUB_BUCKETS get a bucket each, then SUB_BUCKETS per power of two
+    static constexpr size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    static size_t bucketIndex(const uint64_t v)
+    {
+        if (v < SUB_BUCKETS) return static_cast<size_t>(v);
+
+        const unsigned exponent = static_cast<unsigned>(std::bit_width(v)) - 1;
+        const unsigned shift = exponent - SUB_BUCKET_BITS;
+        return static_cast<size_t>((shift + 1) * SUB_BUCKETS + ((v >> shift) - SUB_BUCKETS));
+    }
+
+    //  Largest value that lands in bucket i
+    static uint64_t bucketTop(const size_t i)
+    {
+        if (i < SUB_BUCKETS) return i;
+
+        const uint64_t shift = i / SUB_BUCKETS - 1;
+        const uint64_t mantissa = i % SUB_BUCKETS + SUB_BUCKETS;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    std::array<uint64_t, BUCKET_COUNT> buckets{};
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    double sumSquares = 0.0;
+    uint64_t minimum = std::numeric_limits<uint64_t>::max();
+    uint64_t maximum = 0;
+};
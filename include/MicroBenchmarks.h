@@ -0,0 +1,11 @@
+#pragma once
+
+//	Headless micro benchmarks for individual pipeline pieces.
+//	Run with: Benchmarks --micro
+
+#include <ostream>
+
+void runSampleRingBenchmark(std::ostream& out);
+void runFftBenchmark(std::ostream& out);
+void runFftEngineBenchmark(std::ostream& out);
+void runMagnitudeKernelBenchmark(std::ostream& out);
@@ -1,9 +1,26 @@
 //  Performance manager will serve to monitor the performance of all system components.
 //  This will be used when running benchmarks.
 
+#pragma once
+
+#include "Json.h"
+#include "LatencyHistogram.h"
+#include "Profiler.h"
+
 #include <chrono>
+#include <filesystem>
+#include <string>
 #include <vector>
 
+//  What was being measured, written into the report next to the commit, CPU and GL driver
+struct RunInfo {
+    unsigned int fftSize = 0;
+    unsigned int sampleRate = 0;
+    unsigned int barCount = 0;
+    std::string mode;
+    std::string renderPath;
+};
+
 class PerformanceManager {
 
     using us = std::chrono::microseconds;   //  Measure with integer microseconds (us)
@@ -16,6 +33,8 @@ public:
     PerformanceManager &operator=(const PerformanceManager &) = delete;
 
 
+    //  The frame/FFT/render pairs belong to one thread (the render loop), anything else or any finer
+    //  split is a PROFILE_ZONE. Zones from every thread are part of the report.
     void startFrameTimer();
     us stopFrameTimer();    //  Returns frame time in us
 
@@ -25,17 +44,53 @@ public:
     void startRenderTimer();
     us stopRenderTimer();     //  Returns render time in us
 
-    void writePerformanceData();    //  Writes a performance report to json in benchmarks/out
-                                    //  Report metrics - average/min/max/p50/p95/p99 for each timer
+    //  Audio to screen latency of one frame: call it right after glfwSwapBuffers with the capture time of
+    //  the spectrum that was drawn (AudioManager::spectrumCaptureTime()). The swap returning is as close
+    //  to the photons as GL lets us see, vsync and the compositor still add up to a refresh or two on top.
+    //  A zero capture time (nothing captured yet) is not recorded.
+    us recordLatency(timePoint captureTime);
+
+    //  Writes <label>.json to the output directory and a summary to stdout, returns the file written
+    //  (empty if it could not be). Report metrics - min/max/mean/stddev/percentiles and the full
+    //  bucket list of each timer, compare two reports with BenchCompare.
+    std::filesystem::path writePerformanceData(const std::string& label = "session");
+    [[nodiscard]] JsonValue buildReport(const std::string& label) const;
+
+    //  Reads the GL vendor/renderer/version strings, call it with the render context current
+    void setRunInfo(RunInfo info);
+    void setOutputDirectory(std::filesystem::path directory) { outputDirectory = std::move(directory); }
+
+    //  Empties every timer and zone and restarts the system timer, e.g. between the steps of a sweep
+    void resetTimers();
 
     //  Performance Overlay API functions
     [[nodiscard]] us getCurrentFFTTime() const;
     [[nodiscard]] us getCurrentRenderTime() const;
     [[nodiscard]] us getCurrentFrameTime() const;
+    [[nodiscard]] us getCurrentLatency() const;
 
     [[nodiscard]] us getAverageFFTTime() const;
     [[nodiscard]] us getAverageRenderTime() const;
     [[nodiscard]] us getAverageFrameTime() const;
+    [[nodiscard]] us getAverageLatency() const;
+
+    //  Every recorded sample of each timer, in nanoseconds, for percentiles and spread
+    [[nodiscard]] const LatencyHistogram& getFrameTimeHistogram() const { return frameTimes; }
+    [[nodiscard]] const LatencyHistogram& getFFTTimeHistogram() const { return fftTimes; }
+    [[nodiscard]] const LatencyHistogram& getRenderTimeHistogram() const { return renderTimes; }
+    [[nodiscard]] const LatencyHistogram& getLatencyHistogram() const { return latencies; }
+
+    //  Keeps a timeline of every zone and frame from here on, bounded per thread. writeTrace() dumps
+    //  it, the destructor does too if tracing is still on.
+    void setTracing(bool enabled) { Profiler::setTracing(enabled); }
+    [[nodiscard]] bool tracing() const { return Profiler::tracing(); }
+
+    //  Writes <label>.trace.json to the output directory in the Chrome trace-event format
+    //  (chrome://tracing, ui.perfetto.dev), returns the file written or empty if it could not be
+    std::filesystem::path writeTrace(const std::string& label = "trace") const;
+
+    //  Every PROFILE_ZONE recorded since the last resetTimers(), summed over all threads
+    [[nodiscard]] std::vector<ZoneStats> getZones() const { return Profiler::snapshot(); }
 
     [[nodiscard]] std::chrono::seconds getSystemRunTime() const;
 
@@ -50,6 +105,10 @@ private:
 
     us systemRunTime = std::chrono::microseconds(0);
 
+    RunInfo runInfo;
+    std::string glVendor, glRenderer, glVersion;
+    std::filesystem::path outputDirectory = "benchmarks/out";
+
     //  Timer flags
     bool systemTimerRunning = false;
     bool frameTimerRunning = false;
@@ -57,26 +116,16 @@ private:
     bool renderTimerRunning = false;
 
 
-    //  Count the occurrences of each timer cycle
-    unsigned long long frameCounter = 0;
-    unsigned long long fftCounter = 0;
-    unsigned long long renderCounter = 0;
-
-
-    //  Count the total time for all occurrences to calculate averages
-    //  Measured in Microseconds (us)
-    unsigned long long frameTimeAccumulator_us = 0;
-    unsigned long long fftTimeAccumulator_us = 0;
-    unsigned long long renderTimeAccumulator_us = 0;
+    //  Every timer cycle is binned, counts and averages come from the histograms
+    LatencyHistogram frameTimes;
+    LatencyHistogram fftTimes;
+    LatencyHistogram renderTimes;
+    LatencyHistogram latencies;
 
 
     //  Most recent data for each timer
     unsigned long long mostRecentFrameTime_us = 0;
     unsigned long long mostRecentFFTTime_us = 0;
     unsigned long long mostRecentRenderTime_us = 0;
-
-    //  I have yet to choose a parsing strategy. Probably binning the data in a histogram as it is parsed.
-    //  void binFrameTime(us);
-    //  void binFFTTime(us);
-    //  void binRenderTime(us);
+    unsigned long long mostRecentLatency_us = 0;
 };
\ No newline at end of file
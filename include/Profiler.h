@@ -0,0 +1,158 @@
+#pragma once
+
+//	Named profiling zones. PROFILE_ZONE("fft") times the rest of the enclosing scope,
+//	PROFILE_SAMPLE("upload", elapsed) adds a duration that was already measured.
+//	Every thread records into its own buffer with plain relaxed stores, there is no lock, no shared
+//	cache line and no read-modify-write on the recording path. snapshot() sums the buffers of every
+//	thread that ever recorded without stopping them, so a zone may be a sample behind while in use.
+//	A thread that exits hands its buffer to the next thread that starts, so restarting threads does not
+//	grow the list.
+//	Zones with the same name share their counters wherever they are, zones nest and times are inclusive.
+//	Zone names have to outlive the program (string literals). PROFILE_ZONE compiles to nothing unless
+//	AUDIOVIS_PROFILING is defined (CMake option, on by default).
+//	With tracing on, every zone is also kept as a timeline event in a fixed ring per thread (the oldest
+//	events are overwritten), which PerformanceManager writes out as a Chrome trace.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+//	Totals of one zone over every thread since the last reset, in nanoseconds
+struct ZoneStats {
+	const char* name = nullptr;
+	uint64_t count = 0;
+	uint64_t totalNs = 0;
+	uint64_t minNs = 0;
+	uint64_t maxNs = 0;
+	uint32_t threads = 0;		//	Threads that recorded the zone
+
+	[[nodiscard]] double meanNs() const { return count ? static_cast<double>(totalNs) / static_cast<double>(count) : 0.0; }
+};
+
+//	One zone on the timeline, in nanoseconds since Profiler::epoch()
+struct TraceEvent {
+	uint32_t zone;
+	uint64_t startNs;
+	uint64_t durationNs;
+};
+
+//	What one thread's ring holds, oldest event first
+struct ThreadTrace {
+	uint32_t thread = 0;			//	Order the threads first recorded in
+	const char* name = nullptr;		//	Null unless the thread called setThreadName()
+	std::vector<TraceEvent> events;
+	uint64_t dropped = 0;			//	Events overwritten before they were collected
+};
+
+class Profiler {
+public:
+	static constexpr size_t MAX_ZONES = 64;
+	static constexpr size_t TRACE_CAPACITY = size_t{ 1 } << 15;		//	Timeline events kept per thread
+
+	//	Index of the zone called name, registering it on first use. Takes a lock, so call it once per
+	//	call site (PROFILE_ZONE keeps it in a static). Beyond MAX_ZONES names it returns MAX_ZONES,
+	//	which record() ignores.
+	static uint32_t zoneIndex(const char* name);
+
+	[[nodiscard]] static const char* zoneName(uint32_t zone);
+
+	//	Adds one sample to the calling thread's counters of zone
+	static void record(uint32_t zone, uint64_t ns);
+	//	Same, and a timeline event while tracing
+	static void record(uint32_t zone, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+	//	Every zone recorded since the last reset, in registration order
+	[[nodiscard]] static std::vector<ZoneStats> snapshot();
+
+	//	Starts new counters everywhere. Threads drop their old counters the next time they record,
+	//	so a reset never writes to another thread's buffer.
+	static void reset();
+
+	//	Turning tracing on allocates a ring for every thread buffer there is, threads that start later get
+	//	theirs from setThreadName(). Recording never allocates, so a thread that starts after tracing was
+	//	turned on and never names itself is not on the timeline.
+	static void setTracing(bool enabled);
+	[[nodiscard]] static bool tracing();
+
+	//	Copies every thread's ring, safe while the threads keep recording
+	[[nodiscard]] static std::vector<ThreadTrace> collectTrace();
+
+	//	Names the calling thread in the trace and allocates its ring while tracing, name has to outlive
+	//	the program. Call it first thing on a new thread.
+	static void setThreadName(const char* name);
+
+	//	Time zero of the trace timestamps
+	[[nodiscard]] static std::chrono::steady_clock::time_point epoch();
+
+private:
+	struct Counters {
+		std::atomic<uint64_t> count{ 0 };
+		std::atomic<uint64_t> totalNs{ 0 };
+		std::atomic<uint64_t> minNs{ std::numeric_limits<uint64_t>::max() };
+		std::atomic<uint64_t> maxNs{ 0 };
+	};
+
+	//	Atomic fields so collectTrace() can copy a slot the owner is rewriting, it drops those afterwards
+	struct TraceSlot {
+		std::atomic<uint64_t> startNs{ 0 };
+		std::atomic<uint64_t> durationNs{ 0 };
+		std::atomic<uint32_t> zone{ 0 };
+	};
+
+	//	Owned by one thread, read by snapshot() and collectTrace(). Never freed: when its thread exits
+	//	the next new thread takes it over and keeps adding to its counters, so an exited thread's samples
+	//	stay in the totals, while the trace starts over for the new thread.
+	struct alignas(64) ThreadBuffer {
+		std::array<Counters, MAX_ZONES> zones;
+		std::atomic<uint32_t> generation{ 0 };
+		std::atomic<TraceSlot*> trace{ nullptr };		//	TRACE_CAPACITY slots, null until tracing
+		std::atomic<uint64_t> traceWritten{ 0 };
+		std::atomic<uint64_t> traceFirst{ 0 };			//	Events before this belong to an earlier owner
+		std::atomic<const char*> name{ nullptr };
+		std::atomic<uint32_t> thread{ 0 };
+		std::atomic<bool> inUse{ true };
+		ThreadBuffer* next = nullptr;
+	};
+
+	static ThreadBuffer& localBuffer();
+	static ThreadBuffer* acquireBuffer();
+	static void allocateTrace(ThreadBuffer& buffer);
+	static std::atomic<ThreadBuffer*> buffers;		//	Every thread's buffer, only ever pushed to
+};
+
+
+//	Records the time from construction to destruction into zone
+class ProfileZone {
+public:
+	explicit ProfileZone(const uint32_t zone) : zone(zone), start(std::chrono::steady_clock::now()) {}
+	~ProfileZone() { Profiler::record(zone, start, std::chrono::steady_clock::now()); }
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	uint32_t zone;
+	std::chrono::steady_clock::time_point start;
+};
+
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef AUDIOVIS_PROFILING
+#define PROFILE_ZONE(name) \
+	static const uint32_t PROFILE_CONCAT(profileZoneIndex_, __LINE__) = Profiler::zoneIndex(name); \
+	const ProfileZone PROFILE_CONCAT(profileZone_, __LINE__){ PROFILE_CONCAT(profileZoneIndex_, __LINE__) }
+#define PROFILE_SAMPLE(name, elapsed) do { \
+	static const uint32_t profileZoneIndex = Profiler::zoneIndex(name); \
+	const auto profileEnd = std::chrono::steady_clock::now(); \
+	Profiler::record(profileZoneIndex, profileEnd - std::chrono::duration_cast<std::chrono::steady_clock::duration>(elapsed), profileEnd); \
+} while (false)
+#else
+#define PROFILE_ZONE(name) static_cast<void>(0)
+#define PROFILE_SAMPLE(name, elapsed) static_cast<void>(0)
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+//	Linked shader programs cached on disk as program binaries (GL 4.1 or ARB_get_program_binary).
+//	Each entry is keyed by the driver (vendor, renderer and version strings) and a hash of every stage's
+//	type and source, so a driver update or an edited shader misses and relinks from source, and the new
+//	binary replaces the stale one. Drivers without binary formats always link from source.
+
+#define GLFW_INCLUDE_NONE
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <string_view>
+
+struct ShaderStage {
+	GLenum type;
+	std::string_view source;
+};
+
+class ProgramCache {
+public:
+	//	An empty directory disables the cache
+	ProgramCache() = default;
+	explicit ProgramCache(std::filesystem::path dir) : directory(std::move(dir)) {}
+
+	//	<temp>/AudioVis/shader-cache, empty if there is no temp directory
+	static std::filesystem::path defaultDirectory();
+
+	//	Returns a linked program made of stages, loaded from name's binary if it matches.
+	//	Needs a current context. Returns 0 if the stages fail to compile or link, the log goes to cerr.
+	GLuint link(std::string_view name, std::initializer_list<ShaderStage> stages);
+
+	//	Deletes every stored binary, the next link of each program is cold
+	void clear();
+
+	//	FNV-1a over the stage types and sources, the driver strings are added in link()
+	[[nodiscard]] static uint64_t sourceHash(std::initializer_list<ShaderStage> stages);
+
+	//	Whether the current context can save and load program binaries
+	[[nodiscard]] static bool hasProgramBinary();
+
+	[[nodiscard]] const std::filesystem::path& cacheDirectory() const { return directory; }
+	[[nodiscard]] uint32_t hits() const { return hitCount; }
+	[[nodiscard]] uint32_t misses() const { return missCount; }
+
+private:
+	std::filesystem::path directory;
+	uint32_t hitCount = 0;
+	uint32_t missCount = 0;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+//	Uniforms and binding state shared by every bar program.
+//	All bar programs read BaseColor, BarCount, Mode and FirstBar from one std140 uniform block, so a
+//	colour or bar count change is one buffer write instead of a glUseProgram / glUniform round per program.
+//	Program, VAO and texture binds go through a cache that skips binds of what is already bound, and the
+//	block is only written when a value actually changed. Anything that binds behind its back has to
+//	restore the state (the ImGui backend does) or call invalidate().
+
+#define GLFW_INCLUDE_NONE
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <initializer_list>
+
+//	std140 layout of the BarUniforms block, shaders/BarUniforms.glsl
+struct BarUniforms {
+	float baseColor[4];
+	int32_t barCount;
+	int32_t mode;
+	int32_t firstBar;
+	int32_t padding;
+};
+static_assert(sizeof(BarUniforms) == 32, "BarUniforms has to match the std140 block");
+
+//	GL calls issued and skipped by the cache, per frame
+struct RenderStats {
+	uint32_t programBinds = 0, programBindsSkipped = 0;
+	uint32_t vertexArrayBinds = 0, vertexArrayBindsSkipped = 0;
+	uint32_t textureBinds = 0, textureBindsSkipped = 0;
+	uint32_t uniformUploads = 0, uniformUploadsSkipped = 0;
+
+	[[nodiscard]] uint32_t saved() const
+	{
+		return programBindsSkipped + vertexArrayBindsSkipped + textureBindsSkipped + uniformUploadsSkipped;
+	}
+};
+
+class RenderManager {
+public:
+	static constexpr GLuint UNIFORM_BINDING = 0;
+
+	//	Creates the uniform buffer and attaches the BarUniforms block of every program to it.
+	//	Needs a current context, programs without the block are skipped.
+	void init(std::initializer_list<GLuint> programs);
+	[[nodiscard]] bool ready() const { return uniformBuffer != 0; }
+
+	//	Starts a new frame of counters, the previous one moves to lastFrame()
+	void beginFrame();
+	[[nodiscard]] const RenderStats& lastFrame() const { return previous; }
+
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint vertexArray);
+	void bindTexture(GLenum target, GLuint texture);	//	Texture unit 0 only
+
+	//	Staged, written to the uniform buffer by flushUniforms() if they differ from what it holds
+	void setBaseColor(const float* rgba);
+	void setBarCount(int32_t count);
+	void setMode(int32_t mode);
+	void setFirstBar(int32_t first);
+	void flushUniforms();
+
+	//	Forget what is bound, the next bind of anything goes through
+	void invalidate();
+
+	[[nodiscard]] const BarUniforms& uniforms() const { return staged; }
+	[[nodiscard]] GLuint uniformBufferName() const { return uniformBuffer; }
+
+private:
+	GLuint uniformBuffer = 0;
+	BarUniforms staged{};
+	BarUniforms uploaded{};
+
+	//	~0u means unknown, 0 is a valid binding
+	GLuint boundProgram = ~0u;
+	GLuint boundVertexArray = ~0u;
+	GLenum boundTextureTarget = 0;
+	GLuint boundTexture = ~0u;
+
+	RenderStats current;
+	RenderStats previous;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+//	Writes and compares the timers of benchmark reports (PerformanceManager, DspBench), see BenchCompare.
+//	Percentiles are recomputed from each report's bucket list, so any percentile can be checked.
+
+#include "Json.h"
+#include "LatencyHistogram.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct CompareOptions {
+	std::vector<double> percentiles{ 50.0, 95.0, 99.0 };
+	double thresholdPercent = 5.0;		//	A percentile more than this much slower is a regression
+	double minDeltaNs = 0.0;			//	Changes smaller than this are noise, however large relatively
+};
+
+struct Regression {
+	std::string timer;
+	double percentile;
+	double baseNs;
+	double candidateNs;
+	bool missing;		//	Recorded in the base report but missing or empty in the candidate
+};
+
+//	Everything the histogram knows as a report timer: count, min/max/mean/stddev, percentiles and
+//	buckets, values in nanoseconds
+JsonValue histogramReport(const LatencyHistogram& histogram);
+
+//	Percentile of a report timer from its "buckets" list, 0 if it recorded nothing
+double reportPercentile(const JsonValue& timer, double percent);
+
+//	Prints one line per timer and percentile to out and returns the regressions. A timer the base recorded
+//	that is missing or empty in the candidate is one regression, marked missing, so renaming or dropping a
+//	timer fails the gate. Timers empty in the base are skipped. Throws std::runtime_error on a malformed report.
+std::vector<Regression> compareReports(const JsonValue& base, const JsonValue& candidate, const CompareOptions& options, std::ostream& out);
@@ -0,0 +1,18 @@
+#pragma once
+
+//	Shader sources compiled into the binary from shaders/ (see cmake/EmbedShaders.cmake).
+//	Every source is a string literal, so source.data() is null terminated.
+
+#include "EmbeddedShaders.h"
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+//	Looks a shader up by its file name in shaders/, e.g. "default.vert"
+inline std::string_view shaderSource(const std::string_view name)
+{
+	for (const EmbeddedShader& shader : EMBEDDED_SHADERS)
+		if (shader.name == name) return shader.source;
+	throw std::invalid_argument("No embedded shader named " + std::string(name));
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+//	Real FFTs used for the spectrum: the compile-time Fft engine whenever it supports the size,
+//	kissfft's kiss_fftr behind the same interface otherwise.
+
+#include "Fft.h"
+#include "Globals.h"
+
+extern "C" {
+#include "kiss_fftr.h"
+}
+
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+
+template <size_t N>
+class KissRealFft {
+public:
+	static constexpr size_t size = N;
+	static constexpr size_t bins = N / 2 + 1;
+
+	KissRealFft() : cfg(kiss_fftr_alloc(static_cast<int>(N), 0, nullptr, nullptr)), spectrum(bins) {}
+	~KissRealFft() { free(cfg); }
+
+	KissRealFft(const KissRealFft&) = delete;
+	KissRealFft& operator=(const KissRealFft&) = delete;
+
+	void forward(const float* in, float* outRe, float* outIm)
+	{
+		kiss_fftr(cfg, in, spectrum.data());
+		for (size_t k = 0; k < bins; k++) {
+			outRe[k] = spectrum[k].r;
+			outIm[k] = spectrum[k].i;
+		}
+	}
+
+private:
+	kiss_fftr_cfg cfg;
+	std::vector<kiss_fft_cpx> spectrum;
+};
+
+
+using SpectrumFft = std::conditional_t<FFT_COUNT % 2 == 0 && fftSupportsSize(FFT_COUNT / 2),
+	RealFft<FFT_COUNT>, KissRealFft<FFT_COUNT>>;
+
+//	One per hop in the constant-Q analysis
+using ConstantQFft = std::conditional_t<CQT_FFT_SIZE % 2 == 0 && fftSupportsSize(CQT_FFT_SIZE / 2),
+	RealFft<CQT_FFT_SIZE>, KissRealFft<CQT_FFT_SIZE>>;
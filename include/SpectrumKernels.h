@@ -0,0 +1,19 @@
+#pragma once
+
+//	Vectorised per-bin kernels for the end of the spectrum path.
+//	AVX2, SSE2 or NEON is picked at compile time from the target flags, with a scalar fallback.
+
+#include <cstddef>
+
+//	log2 from the float exponent plus a degree 5 polynomial for the mantissa.
+//	Within 1.5e-5 of std::log2 for x in [1, 2), and within 2e-5 for any normal positive x, where
+//	rounding the sum with a large exponent adds to the polynomial's error. Zero and denormals come out
+//	as roughly -127 to -150 instead of -inf, so a floor clamp handles them.
+float fastLog2(float x);
+
+//	out[i] = scale * max(floorLog2, log2(|X[i]|)), with |X[i]| from re[i] and im[i], in a single pass.
+//	Works on |X|^2 (log2 |X| = 0.5 * log2 |X|^2) so there is no square root.
+void logMagnitudes(const float* re, const float* im, float* out, size_t count, float scale, float floorLog2 = 0.0f);
+
+//	Name of the instruction set logMagnitudes was built for
+const char* spectrumKernelIsa();
@@ -0,0 +1,190 @@
+#pragma once
+
+//	Fixed capacity single-producer/single-consumer ring buffer.
+//	One thread may push, one other thread may pop, neither ever blocks or allocates.
+//	Producer and consumer state live on separate cache lines so the two threads
+//	only share a line when one of them has to refresh its view of the other index.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+template <typename T>
+class SpscRingBuffer {
+	static_assert(std::is_trivially_copyable_v<T>, "SpscRingBuffer copies elements with memcpy");
+
+public:
+	//	Capacity is rounded up to a power of two
+	explicit SpscRingBuffer(size_t minCapacity)
+	{
+		if (minCapacity == 0) throw std::invalid_argument("SpscRingBuffer needs a non-zero capacity");
+
+		size_t cap = 1;
+		while (cap < minCapacity) cap <<= 1;
+
+		mask = cap - 1;
+		buffer = std::make_unique<T[]>(cap);
+	}
+
+	SpscRingBuffer(const SpscRingBuffer&) = delete;
+	SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+	[[nodiscard]] size_t capacity() const { return mask + 1; }
+
+	// ----------------------------------------------------
+	// Producer side
+	// ----------------------------------------------------
+
+	[[nodiscard]] size_t writeAvailable()
+	{
+		const uint64_t head = producer.head.load(std::memory_order_relaxed);
+		producer.cachedTail = consumer.tail.load(std::memory_order_acquire);
+		return capacity() - static_cast<size_t>(head - producer.cachedTail);
+	}
+
+	//	Largest contiguous block that can be written without wrapping.
+	//	Fill it in place and then commitWrite() the part that was used.
+	//	The consumer index is only re-read when fewer than wanted slots look free,
+	//	so the span can be shorter than the real free space unless wanted asks for more.
+	[[nodiscard]] std::span<T> writableSpan(const size_t wanted = 1)
+	{
+		const uint64_t head = producer.head.load(std::memory_order_relaxed);
+		size_t free = capacity() - static_cast<size_t>(head - producer.cachedTail);
+		if (free < wanted) free = writeAvailable();
+
+		const size_t offset = static_cast<size_t>(head) & mask;
+		return { buffer.get() + offset, std::min(free, capacity() - offset) };
+	}
+
+	void commitWrite(const size_t count)
+	{
+		producer.head.store(producer.head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	//	Copies as much of data as fits, anything that does not fit is dropped and counted
+	size_t push(const T* data, const size_t count)
+	{
+		const uint64_t head = producer.head.load(std::memory_order_relaxed);
+		size_t free = capacity() - static_cast<size_t>(head - producer.cachedTail);
+		if (free < count) free = writeAvailable();
+
+		const size_t n = std::min(free, count);
+		const size_t offset = static_cast<size_t>(head) & mask;
+		const size_t first = std::min(n, capacity() - offset);
+
+		std::memcpy(buffer.get() + offset, data, first * sizeof(T));
+		std::memcpy(buffer.get(), data + first, (n - first) * sizeof(T));
+		producer.head.store(head + n, std::memory_order_release);
+
+		if (n < count) recordOverflow(count - n);
+		return n;
+	}
+
+	//	For producers filling spans that ran out of room
+	void recordOverflow(const size_t droppedCount)
+	{
+		producer.overflows.fetch_add(1, std::memory_order_relaxed);
+		producer.dropped.fetch_add(droppedCount, std::memory_order_relaxed);
+	}
+
+	// ----------------------------------------------------
+	// Consumer side
+	// ----------------------------------------------------
+
+	[[nodiscard]] size_t readAvailable()
+	{
+		const uint64_t tail = consumer.tail.load(std::memory_order_relaxed);
+		consumer.cachedHead = producer.head.load(std::memory_order_acquire);
+		return static_cast<size_t>(consumer.cachedHead - tail);
+	}
+
+	//	Largest contiguous block that can be read without wrapping.
+	//	Read it in place and then consume() the part that was used.
+	//	The producer index is only re-read when fewer than wanted elements look ready,
+	//	so the span can be shorter than what is really queued unless wanted asks for more.
+	[[nodiscard]] std::span<const T> readableSpan(const size_t wanted = 1)
+	{
+		const uint64_t tail = consumer.tail.load(std::memory_order_relaxed);
+		size_t used = static_cast<size_t>(consumer.cachedHead - tail);
+		if (used < wanted) used = readAvailable();
+
+		const size_t offset = static_cast<size_t>(tail) & mask;
+		return { buffer.get() + offset, std::min(used, capacity() - offset) };
+	}
+
+	//	The next count queued elements, read in place without consuming them.
+	//	Split in two at the wrap point, both spans are empty if fewer than count are queued.
+	[[nodiscard]] std::array<std::span<const T>, 2> peek(const size_t count)
+	{
+		const uint64_t tail = consumer.tail.load(std::memory_order_relaxed);
+		size_t used = static_cast<size_t>(consumer.cachedHead - tail);
+		if (used < count) used = readAvailable();
+		if (used < count) return {};
+
+		const size_t offset = static_cast<size_t>(tail) & mask;
+		const size_t first = std::min(count, capacity() - offset);
+		return { std::span<const T>(buffer.get() + offset, first), std::span<const T>(buffer.get(), count - first) };
+	}
+
+	void consume(const size_t count)
+	{
+		consumer.tail.store(consumer.tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	//	Copies up to count elements out, returns how many were copied
+	size_t pop(T* data, const size_t count)
+	{
+		const uint64_t tail = consumer.tail.load(std::memory_order_relaxed);
+		size_t used = static_cast<size_t>(consumer.cachedHead - tail);
+		if (used < count) used = readAvailable();
+
+		const size_t n = std::min(used, count);
+		const size_t offset = static_cast<size_t>(tail) & mask;
+		const size_t first = std::min(n, capacity() - offset);
+
+		std::memcpy(data, buffer.get() + offset, first * sizeof(T));
+		std::memcpy(data + first, buffer.get(), (n - first) * sizeof(T));
+		consumer.tail.store(tail + n, std::memory_order_release);
+
+		return n;
+	}
+
+	// ----------------------------------------------------
+	// Statistics, safe from any thread
+	// ----------------------------------------------------
+
+	[[nodiscard]] uint64_t overflowCount() const { return producer.overflows.load(std::memory_order_relaxed); }
+	[[nodiscard]] uint64_t droppedCount() const { return producer.dropped.load(std::memory_order_relaxed); }
+	[[nodiscard]] uint64_t totalWritten() const { return producer.head.load(std::memory_order_relaxed); }
+	[[nodiscard]] uint64_t totalRead() const { return consumer.tail.load(std::memory_order_relaxed); }
+
+private:
+	//	Indices only ever grow, the slot is index & mask. 64 bits never wrap in practice.
+	struct alignas(CACHE_LINE_SIZE) ProducerState {
+		std::atomic<uint64_t> head{ 0 };
+		uint64_t cachedTail = 0;		//	Producer's last view of consumer.tail
+		std::atomic<uint64_t> overflows{ 0 };
+		std::atomic<uint64_t> dropped{ 0 };
+	};
+
+	struct alignas(CACHE_LINE_SIZE) ConsumerState {
+		std::atomic<uint64_t> tail{ 0 };
+		uint64_t cachedHead = 0;		//	Consumer's last view of producer.head
+	};
+
+	ProducerState producer;
+	ConsumerState consumer;
+
+	//	Read-only after construction, kept off the index lines
+	alignas(CACHE_LINE_SIZE) size_t mask = 0;
+	std::unique_ptr<T[]> buffer;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+//	Sliding window short-time Fourier transform framing.
+//	Windows are read in place from the sample ring and the ring only advances by the hop,
+//	so the overlapping part of the next window never leaves the ring and every sample is
+//	consumed exactly once. One frame is emitted per hop, i.e. at sampleRate / hop frames per second.
+
+#include "SpscRingBuffer.h"
+
+#include <cstddef>
+
+class Stft {
+public:
+	Stft(size_t windowLength, size_t hopSize);
+
+	[[nodiscard]] size_t windowLength() const { return length; }
+	[[nodiscard]] size_t hopSize() const { return hop; }
+
+	//	1 <= hop <= windowLength, takes effect from the next frame
+	void setHopSize(size_t hopSize);
+
+	//	Copies the next full window from the ring into out (windowLength samples) and advances
+	//	the ring by the hop. Returns false and leaves the ring untouched if no full window is queued.
+	bool nextFrame(SpscRingBuffer<float>& ring, float* out) const;
+
+	//	Same, multiplying by window (windowLength coefficients) during the copy so windowing
+	//	costs no extra pass over the frame
+	bool nextFrame(SpscRingBuffer<float>& ring, float* out, const float* window) const;
+
+	//	Overlap between consecutive windows, 0.5 for a 50% overlap
+	[[nodiscard]] float overlap() const { return 1.0f - static_cast<float>(hop) / static_cast<float>(length); }
+
+private:
+	size_t length;
+	size_t hop;
+};
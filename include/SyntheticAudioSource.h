@@ -0,0 +1,61 @@
+#pragma once
+
+//	Deterministic signal generator. Produces the same samples on every run so the
+//	FFT and render path can be benchmarked and regression tested without a device.
+
+#include "AudioSource.h"
+
+#include <vector>
+
+enum class Waveform {
+	Sine,
+	Chirp,		//	Linear sweep from frequency to endFrequency, repeats every sweepSeconds
+	Noise,		//	White noise from a seeded xorshift generator
+	Impulse,	//	One click every 1 / frequency seconds from frame 0, silence in between, for latency tests
+	Silence
+};
+
+struct SyntheticSignal {
+	Waveform waveform = Waveform::Sine;
+	float frequency = 1000.0f;
+	float endFrequency = 20000.0f;
+	float amplitude = 0.5f;
+	float sweepSeconds = 1.0f;
+	uint32_t seed = 1;
+};
+
+class SyntheticAudioSource final : public AudioSource {
+public:
+	explicit SyntheticAudioSource(SyntheticSignal signal, AudioFormat fmt = {}, uint32_t packetFrames = 480);
+
+	[[nodiscard]] AudioFormat format() const override { return fmt; }
+
+	bool acquirePacket(AudioPacket& packet) override;
+	void releasePacket() override {}
+	bool waitForPacket(std::chrono::milliseconds timeout) override;
+
+	//	A capture thread always gets realtime packets, unpaced it would spin and overrun the ring
+	void onCaptureThreadStart() override;
+	void onCaptureThreadStop() override;
+
+	//	Realtime sources release packets at the sample rate instead of as fast as they are asked
+	void setRealtime(bool enabled);
+
+	[[nodiscard]] uint64_t framesGenerated() const { return frameIndex; }
+
+private:
+	float nextSample();
+
+	SyntheticSignal signal;
+	AudioFormat fmt;
+	uint32_t packetFrames;
+
+	bool realtime = false;
+	bool realtimeBeforeCapture = false;
+	RealtimePacer pacer;
+
+	std::vector<float> buffer;		//	Interleaved, reused for every packet
+	uint64_t frameIndex = 0;
+	double phase = 0.0;
+	uint32_t noiseState;
+};
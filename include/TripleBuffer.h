@@ -0,0 +1,82 @@
+#pragma once
+
+//	Wait-free single-writer/single-reader handoff of the latest value.
+//	Three slots: the writer fills its back slot and swaps it with the shared middle slot, the reader
+//	swaps the middle slot with its front slot whenever the middle holds something new. Neither side
+//	ever blocks or waits on the other, the reader always ends up with the newest published value, and
+//	a value is never written while the reader can see it, so it can not tear. Values the reader did
+//	not pick up in time are overwritten.
+
+#include "SpscRingBuffer.h"		//	CACHE_LINE_SIZE
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+template <typename T>
+class TripleBuffer {
+public:
+	TripleBuffer() = default;
+	explicit TripleBuffer(const T& initial) { reset(initial); }
+
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	//	Sets every slot to value and forgets anything published.
+	//	Only while neither the writer nor the reader is running.
+	void reset(const T& value)
+	{
+		for (Slot& slot : slots) slot.value = value;
+		writer.back = 0;
+		middle.store(1, std::memory_order_relaxed);
+		reader.front = 2;
+	}
+
+	// ----------------------------------------------------
+	// Writer side
+	// ----------------------------------------------------
+
+	//	The slot only the writer can see, fill it then publish()
+	[[nodiscard]] T& writeBuffer() { return slots[writer.back].value; }
+
+	void publish()
+	{
+		//	Release hands the filled slot over, acquire makes sure the reader is done with the one we get back
+		writer.back = middle.exchange(writer.back | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	// ----------------------------------------------------
+	// Reader side
+	// ----------------------------------------------------
+
+	//	Picks up the newest published value if there is one the reader has not seen, returns false otherwise
+	bool update()
+	{
+		if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+		reader.front = middle.exchange(reader.front, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+
+	//	The value picked up by the last update(), stays put until the next one
+	[[nodiscard]] const T& readBuffer() const { return slots[reader.front].value; }
+
+private:
+	static constexpr uint32_t INDEX = 3;
+	static constexpr uint32_t FRESH = 4;	//	Set while the middle slot holds a value the reader has not taken
+
+	//	Each slot and each side's index on its own cache line
+	struct alignas(CACHE_LINE_SIZE) Slot {
+		T value{};
+	};
+	struct alignas(CACHE_LINE_SIZE) WriterState {
+		uint32_t back = 0;
+	};
+	struct alignas(CACHE_LINE_SIZE) ReaderState {
+		uint32_t front = 2;
+	};
+
+	std::array<Slot, 3> slots;
+	WriterState writer;
+	alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> middle{ 1 };
+	ReaderState reader;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+//	Per frame vertex upload without reallocating the buffer every frame.
+//	With GL 4.4 / ARB_buffer_storage the buffer is allocated once, mapped persistently and coherently,
+//	and split into SEGMENTS regions written round robin. A fence after each draw keeps the CPU from
+//	overwriting a region the GPU may still be reading. Without buffer storage (plain GL 3.3) the buffer
+//	is orphaned and refilled each frame instead, which lets the driver hand back fresh storage rather
+//	than synchronising with the previous draw.
+
+#define GLFW_INCLUDE_NONE
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+enum class UploadStrategy {
+	BufferData,			//	glBufferData(GL_DYNAMIC_DRAW) every frame, reallocates the storage
+	Orphaning,			//	Orphan with a null glBufferData then glBufferSubData
+	PersistentMapped	//	Persistent coherent mapping, fenced segments
+};
+
+constexpr const char* UPLOAD_STRATEGY_NAMES[] = { "glBufferData", "Orphaning", "Persistent mapped" };
+
+class VertexRing {
+public:
+	static constexpr size_t SEGMENTS = 3;
+
+	//	Allocates vbo (bound to GL_ARRAY_BUFFER on return) for up to segmentBytes per frame. PersistentMapped
+	//	falls back to Orphaning when the context has no buffer storage, strategy() reports what was chosen.
+	//	Needs a current context. A buffer that has had persistent storage can not be given any other
+	//	(glBufferStorage is immutable), initialising the same name again throws std::logic_error.
+	void init(GLuint vbo, size_t segmentBytes, UploadStrategy wanted = UploadStrategy::PersistentMapped);
+
+	//	Switches an initialised ring to another strategy, same segment size. Leaving persistent storage
+	//	deletes the buffer and carries on in a new one, returns true when name() changed that way so
+	//	whatever points at the old name (VAO attributes, buffer textures) can be pointed at the new one.
+	bool setStrategy(UploadStrategy wanted);
+
+	//	Where to write this frame's vertices, at most segmentBytes. Waits on the fence of the segment
+	//	if the GPU has not finished with it yet.
+	[[nodiscard]] void* map();
+
+	//	Hands the written bytes to GL and returns the first vertex to draw for the given vertex stride
+	GLint unmap(size_t bytes, size_t stride);
+
+	//	Call after the draw that reads the segment, moves on to the next one
+	void fence();
+
+	[[nodiscard]] UploadStrategy strategy() const { return current; }
+	[[nodiscard]] size_t segmentSize() const { return segmentBytes; }
+	[[nodiscard]] GLuint name() const { return buffer; }
+
+	//	True when the context exposes glBufferStorage
+	static bool hasBufferStorage();
+
+private:
+	void release();
+
+	GLuint buffer = 0;
+	size_t segmentBytes = 0;
+	UploadStrategy current = UploadStrategy::BufferData;
+
+	std::byte* mapped = nullptr;		//	PersistentMapped, all SEGMENTS regions back to back
+	std::vector<std::byte> staging;		//	BufferData and Orphaning
+	std::array<GLsync, SEGMENTS> fences{};
+	size_t segment = 0;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+//	WASAPI loopback capture of the default render endpoint (Windows only)
+
+#include "AudioSource.h"
+#include "Globals.h"
+
+#include <windows.h>
+#include <mmdeviceapi.h>
+#include <audioclient.h>
+
+#include <stdexcept>
+
+#define THROW_ON_ERROR(hres, x)  \
+              if (FAILED(hres)) { throw std::runtime_error(x); }
+
+class WasapiAudioSource final : public AudioSource {
+public:
+	WasapiAudioSource();
+	~WasapiAudioSource() noexcept override;
+
+	[[nodiscard]] AudioFormat format() const override;
+	[[nodiscard]] bool isValid() const override { return validAudioDevice; }
+
+	bool acquirePacket(AudioPacket& packet) override;
+	void releasePacket() override;
+
+	//	Waits on the buffer-ready event (AUDCLNT_STREAMFLAGS_EVENTCALLBACK)
+	bool waitForPacket(std::chrono::milliseconds timeout) override;
+
+	void onCaptureThreadStart() override;
+	void onCaptureThreadStop() override;
+
+private:
+	// WASAPI interfaces
+	IMMDeviceEnumerator* pEnumerator = nullptr;
+	IMMDevice* pDevice = nullptr;
+	IAudioClient* pAudioClient = nullptr;
+	IAudioCaptureClient* pCaptureClient = nullptr;
+	REFERENCE_TIME hnsRequestedDuration = REFTIMES_PER_SEC;
+
+	bool validAudioDevice = true;	//	For CI tests, no audio device present
+
+	// Global GUID's for devices
+	const CLSID CLSID_MMDeviceEnumerator = __uuidof(MMDeviceEnumerator);
+	const IID IID_IMMDeviceEnumerator = __uuidof(IMMDeviceEnumerator);
+	const IID IID_IAudioClient = __uuidof(IAudioClient);
+	const IID IID_IAudioCaptureClient = __uuidof(IAudioCaptureClient);
+
+	// Struct to describe the audio properties
+	WAVEFORMATEX* pwfx = nullptr;
+
+	//	Signalled by the audio engine whenever a buffer is ready
+	HANDLE bufferReadyEvent = nullptr;
+
+	//	Frames held by the last successful GetBuffer
+	UINT32 framesHeld = 0;
+};
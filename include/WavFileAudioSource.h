@@ -0,0 +1,54 @@
+#pragma once
+
+//	Memory-mapped WAV reader. Packets point straight into the mapping, nothing is copied.
+//	Supports PCM 16/24/32 bit and 32 bit float, including WAVE_FORMAT_EXTENSIBLE headers.
+
+#include "AudioSource.h"
+
+#include <string>
+
+class WavFileAudioSource final : public AudioSource {
+public:
+	explicit WavFileAudioSource(const std::string& path, uint32_t packetFrames = 480, bool loop = true);
+	~WavFileAudioSource() override;
+
+	[[nodiscard]] AudioFormat format() const override { return fmt; }
+	[[nodiscard]] bool isValid() const override { return totalFrames > 0; }
+
+	bool acquirePacket(AudioPacket& packet) override;
+	void releasePacket() override {}
+	bool waitForPacket(std::chrono::milliseconds timeout) override;
+
+	//	A capture thread always gets realtime packets, unpaced it would spin and overrun the ring
+	void onCaptureThreadStart() override;
+	void onCaptureThreadStop() override;
+
+	//	Realtime playback releases packets at the file's sample rate instead of as fast as they are asked
+	void setRealtime(bool enabled);
+
+	[[nodiscard]] uint64_t frameCount() const { return totalFrames; }
+
+	//	Zero copy span of frames [first, first + count), clamped to the end of the file
+	[[nodiscard]] AudioPacket frames(uint64_t first, uint32_t count) const;
+
+private:
+	void parseHeader();
+	void unmap() noexcept;
+
+	AudioFormat fmt;
+	uint32_t packetFrames;
+	bool loop;
+
+	bool realtime = false;
+	bool realtimeBeforeCapture = false;
+	RealtimePacer pacer;
+
+	const std::byte* mapping = nullptr;
+	size_t mappingSize = 0;
+	void* fileHandle = nullptr;		//	Windows only
+	void* mappingHandle = nullptr;	//	Windows only
+
+	const std::byte* frameData = nullptr;
+	uint64_t totalFrames = 0;
+	uint64_t cursor = 0;
+};
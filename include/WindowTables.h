@@ -0,0 +1,73 @@
+#pragma once
+
+//	Analysis window coefficient tables, generated at compile time per window type and FFT size.
+//	Periodic (DFT-even) cosine-sum windows, normalised to a coherent gain of 1 so a full scale
+//	sine draws the same bar height whichever window is selected.
+
+#include "ConstexprMath.h"
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <span>
+
+enum class WindowType {
+	Rectangular,
+	Hann,
+	Hamming,
+	BlackmanHarris,		//	4 term, -92 dB side lobes
+	FlatTop				//	5 term, amplitude accurate to ~0.01 dB between bins
+};
+
+constexpr const char* WINDOW_NAMES[] = { "Rectangular", "Hann", "Hamming", "Blackman-Harris", "Flat top" };
+constexpr size_t WINDOW_TYPE_COUNT = std::size(WINDOW_NAMES);
+
+
+//	w[n] = sum_k (-1)^k a_k cos(2 pi k n / N)
+constexpr std::array<double, 5> windowCoefficients(const WindowType type)
+{
+	switch (type) {
+	case WindowType::Hann: return { 0.5, 0.5, 0.0, 0.0, 0.0 };
+	case WindowType::Hamming: return { 0.54, 0.46, 0.0, 0.0, 0.0 };
+	case WindowType::BlackmanHarris: return { 0.35875, 0.48829, 0.14128, 0.01168, 0.0 };
+	case WindowType::FlatTop: return { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 };
+	default: return { 1.0, 0.0, 0.0, 0.0, 0.0 };
+	}
+}
+
+
+template <size_t N>
+constexpr std::array<float, N> makeWindow(const WindowType type)
+{
+	const auto a = windowCoefficients(type);
+
+	//	The mean of a cosine sum over a whole period is a0, dividing by it gives unit coherent gain
+	std::array<float, N> w{};
+	for (size_t n = 0; n < N; n++) {
+		double value = 0.0, sign = 1.0;
+		for (size_t k = 0; k < a.size(); k++) {
+			value += sign * a[k] * constexprCos(2.0 * PI * static_cast<double>(k * n) / static_cast<double>(N));
+			sign = -sign;
+		}
+		w[n] = static_cast<float>(value / a[0]);
+	}
+	return w;
+}
+
+
+template <WindowType Type, size_t N>
+inline constexpr std::array<float, N> WINDOW_TABLE = makeWindow<N>(Type);
+
+
+//	Tables only exist for the sizes this is instantiated with
+template <size_t N>
+std::span<const float, N> windowTable(const WindowType type)
+{
+	switch (type) {
+	case WindowType::Hann: return WINDOW_TABLE<WindowType::Hann, N>;
+	case WindowType::Hamming: return WINDOW_TABLE<WindowType::Hamming, N>;
+	case WindowType::BlackmanHarris: return WINDOW_TABLE<WindowType::BlackmanHarris, N>;
+	case WindowType::FlatTop: return WINDOW_TABLE<WindowType::FlatTop, N>;
+	default: return WINDOW_TABLE<WindowType::Rectangular, N>;
+	}
+}
@@ -0,0 +1,8 @@
+//  Shared by every bar program, bound to uniform buffer binding 0 by RenderManager.
+//  Has to match struct BarUniforms in include/RenderManager.h.
+layout (std140) uniform BarUniforms {
+    vec4 BaseColor;
+    int BarCount;
+    int Mode;       //  0 default, 1 symmetric, 2 double symmetric
+    int FirstBar;   //  Where this frame's heights start in the height ring
+};
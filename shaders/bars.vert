@@ -0,0 +1,31 @@
+#version 330 core
+
+//  Instanced bars, no geometry shader. One instance per bar (two in double symmetric mode),
+//  the four strip corners come from gl_VertexID and x from the instance index.
+//  Builds the same quads as default.geom, symmetric.geom and doubleSym.geom.
+
+layout (location = 0) in float aHeight;    //  Normalized uint16, half the top y genMinVerts would give the bar
+
+#include "BarUniforms.glsl"
+
+void main()
+{
+    //  TL, BL, TR, BR
+    float right = float(gl_VertexID >> 1);
+    float top = float(1 - (gl_VertexID & 1));
+    float y = aHeight * 2.0f;
+    float width = 1.0f / float(BarCount);
+
+    if (Mode == 2) {
+        //  Instances 2i and 2i + 1 both read bar i (attribute divisor 2), the odd one mirrors it into the left half
+        float x = float(gl_InstanceID >> 1) * 2.0f * width - 1.0f;
+        float left = (gl_InstanceID & 1) == 0 ? 0.5f + x / 2.0f : -0.5f - x / 2.0f;
+        gl_Position = vec4(left + right * 0.5f * width, mix(-y, y, top), 0.0f, 1.0f);
+    }
+    else {
+        float x = float(gl_InstanceID) * 2.0f * width - 1.0f;
+        float yTop = Mode == 1 ? y : y - 1.0f;
+        float yBottom = Mode == 1 ? -y : -1.0f;
+        gl_Position = vec4(x + right * width, mix(yBottom, yTop, top), 0.0f, 1.0f);
+    }
+}
@@ -1,7 +1,8 @@
 #version 330 core
 
 out vec4 FragColor;
-uniform vec4 BaseColor;
+
+#include "BarUniforms.glsl"
 
 void main()
 {
@@ -0,0 +1,46 @@
+#version 330 core
+
+//  Shades every bar analytically: each fragment works out which bar it falls in and whether it is
+//  under that bar's height. Same bars as bars.vert and the geometry shaders, in every mode.
+
+in vec2 ndc;
+out vec4 FragColor;
+
+uniform samplerBuffer Heights;  //  R16, half the top y of each bar, as the instanced path uploads them
+
+#include "BarUniforms.glsl"
+
+void main()
+{
+    float n = float(BarCount);
+    int bar;
+    bool inside;
+
+    if (Mode == 2) {
+        //  Right half: bar i covers [i / n, (i + 0.5) / n]. Left half mirrors it to [-i / n, -(i - 0.5) / n].
+        if (ndc.x >= 0.0f) {
+            float u = ndc.x * n;
+            bar = int(floor(u));
+            inside = fract(u) < 0.5f;
+        }
+        else {
+            float v = -ndc.x * n;
+            bar = int(ceil(v));
+            inside = v > float(bar) - 0.5f;
+        }
+    }
+    else {
+        //  Bar i covers [2i / n - 1, (2i + 1) / n - 1], half the pitch is gap
+        float u = (ndc.x + 1.0f) * 0.5f * n;
+        bar = int(floor(u));
+        inside = fract(u) < 0.5f;
+    }
+
+    if (!inside || bar < 0 || bar >= BarCount) discard;
+
+    float y = texelFetch(Heights, FirstBar + bar).r * 2.0f;
+    bool under = Mode == 0 ? ndc.y <= y - 1.0f : abs(ndc.y) <= y;
+    if (!under) discard;
+
+    FragColor = BaseColor;
+}
@@ -0,0 +1,11 @@
+#version 330 core
+
+//  One triangle that covers the screen, no vertex data: (-1, -1), (3, -1), (-1, 3)
+
+out vec2 ndc;
+
+void main()
+{
+    ndc = vec2(float((gl_VertexID & 1) << 2) - 1.0f, float((gl_VertexID & 2) << 1) - 1.0f);
+    gl_Position = vec4(ndc, 0.0f, 1.0f);
+}
@@ -0,0 +1,26 @@
+#version 330 core
+
+//  Transform feedback only, nothing is rasterized.
+//  Same decay rule as the CPU smoothing: rising bars jump to their target, falling bars blend
+//  with the previous frame. Writes the bar vertex (as genMinVerts builds it) and the next state.
+
+layout (location = 0) in float target;      //  Raw bar height this frame
+layout (location = 1) in float previous;    //  Raw bar height last frame
+
+uniform float SmoothingCoef;
+uniform float HorizScale;
+uniform float VertScale;
+
+out vec2 barVertex;
+out float nextPrevious;
+
+void main()
+{
+    float height = target;
+    if (previous >= target)
+        height = SmoothingCoef * previous + (1.0f - SmoothingCoef) * target;
+
+    nextPrevious = target;
+    barVertex.x = float(gl_VertexID) * HorizScale - 1.0f;
+    barVertex.y = height <= 0.01f ? 0.01f : height * VertScale + 0.01f;
+}
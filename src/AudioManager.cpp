@@ -1,146 +1,131 @@
 ﻿#include "../include/AudioManager.h"
+#include "../include/Profiler.h"
 
-AudioManager::AudioManager()
+#ifdef _WIN32
+#include "../include/WasapiAudioSource.h"
+#endif
+
+// ----------------------------------------------------
+// Helpers
+// ----------------------------------------------------
+
+//	Platform capture device, null where we have no capture backend yet
+static std::unique_ptr<AudioSource> makeDefaultAudioSource()
 {
-	// Kiss FFT setup
-	cfg = kiss_fft_alloc(FFT_COUNT, 0, nullptr, nullptr);
+#ifdef _WIN32
+	return std::make_unique<WasapiAudioSource>();
+#else
+	return nullptr;
+#endif
+}
 
-	// Allocate mem for the visualization data
-	magnitudes.resize(FFT_COUNT / 2);
-	prevMagnitudes.reserve(FFT_COUNT / 2);
-	colors.resize(BAR_COUNT * 3);
 
-	audioSample.resize(FFT_COUNT);
-	visualData.resize(FFT_COUNT);
+AudioManager::AudioManager() : AudioManager(makeDefaultAudioSource())
+{
+}
 
-	//	Set these before the possible early return
-	defaultShaderProgram = symmetricShaderProgram = doubleSymmetricShaderProgram = 0;
-	barCountUniform1 = barCountUniform2 = barCountUniform3 = colorLocation1 = colorLocation2 = colorLocation3 = 0;
 
-	// Contains high for failure, low for success
+AudioManager::AudioManager(std::unique_ptr<AudioSource> src) : source(std::move(src))
+{
+	// FFT setup
+	spectrumFft = std::make_unique<SpectrumFft>();
 
-	HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
-	THROW_ON_ERROR(hr, "Unable to initialize COM library in AudioManager()");
+	// Allocate mem for the visualization data
+	magnitudes.resize(FFT_COUNT / 2);
+	barHeights.reserve(MAX_BAR_COUNT);
+	colors.reserve(MAX_BAR_COUNT * 3);
+	resizeBars(resolveBarCount());
 
-	// Create instance of COM object in pEnumerator
-	hr = CoCreateInstance(
-		CLSID_MMDeviceEnumerator, nullptr,
-		CLSCTX_ALL, IID_IMMDeviceEnumerator,
-		reinterpret_cast<void **>(&pEnumerator));
-	THROW_ON_ERROR(hr, "Unable to Initialize pEnumerator in AudioManager()")
+	spectrumRe.resize(SpectrumFft::bins);
+	spectrumIm.resize(SpectrumFft::bins);
+	fftInput.resize(FFT_COUNT);
 
+	sampleRing = std::make_unique<SpscRingBuffer<float>>(SAMPLE_RING_CAPACITY);
+	stampRing = std::make_unique<SpscRingBuffer<CaptureStamp>>(CAPTURE_STAMP_CAPACITY);
 
-		// Get the default audio output (eRender for out)
-		hr = pEnumerator->GetDefaultAudioEndpoint(
-			eRender, eConsole, &pDevice);
+	defaultShaderProgram = symmetricShaderProgram = doubleSymmetricShaderProgram = instancedShaderProgram = fullscreenShaderProgram = 0;
 
 	//	If there is no audio device (in the case of running CI tests)
-	if ((((HRESULT)(hr)) < 0)) {
-		std::cerr << "GetDefaultAudioEndpoint failed, hr = 0x"
-			<< std::hex << hr << std::dec << "\n";
+	if (!source || !source->isValid()) {
 		validAudioDevice = false;
 		return;
 	}
 
-
-		// Get the audio client interface and store in pAudioClient
-		hr = pDevice->Activate(
-			IID_IAudioClient, CLSCTX_ALL,
-			nullptr, reinterpret_cast<void **>(&pAudioClient));
-	THROW_ON_ERROR(hr, "Unable to get audio client in AudioManager()")
-
-
-		// Get the format for the audio stream
-		hr = pAudioClient->GetMixFormat(&pwfx);
-	THROW_ON_ERROR(hr, "Unable to get mix format in AudioManager()")
-
-
-		// Initialize the client
-		// LOOPBACK flag allows for listening to the audio being played
-		hr = pAudioClient->Initialize(
-			AUDCLNT_SHAREMODE_SHARED,
-			AUDCLNT_STREAMFLAGS_LOOPBACK,
-			hnsRequestedDuration,
-			0,
-			pwfx,
-			nullptr);
-	THROW_ON_ERROR(hr, "Unable to initialize audio client in AudioManager()")
-
-
-		// Get the capture client to actually listen
-		hr = pAudioClient->GetService(
-			IID_IAudioCaptureClient,
-			reinterpret_cast<void **>(&pCaptureClient));
-	THROW_ON_ERROR(hr, "Unable to get capture client in AudioManager()");
-
-
-	// Start recording audio
-	hr = pAudioClient->Start();
-	THROW_ON_ERROR(hr, "Unable to start audio client in AudioManager()");
+	//	Any channel count and sample format is converted on the way into the sample ring
+	sourceFormat = source->format();
+	if (sourceFormat.channels == 0)
+		throw std::invalid_argument("Audio source reports no channels");
 }
 
 
 AudioManager::~AudioManager() noexcept
 {
+	stopCapture();
+
 	// Release all memory
-	if (pEnumerator) {
-		pEnumerator->Release();
-		pEnumerator = nullptr;
-	}
-	if (pwfx) {
-		CoTaskMemFree(pwfx);
-		pwfx = nullptr;
-	}
-	if (pDevice) {
-		pDevice->Release();
-		pDevice = nullptr;
-	}
-	if (pAudioClient) {
-		pAudioClient->Release();
-		pAudioClient = nullptr;
-	}
-	if (pCaptureClient) {
-		pCaptureClient->Release();
-		pCaptureClient = nullptr;
-	}
-	if (cfg) {
-		free(cfg);
-		cfg = nullptr;
-	}
+	if (source && packet.data) source->releasePacket();
 }
 
 
 AudioManager::AudioManager(AudioManager&& other) noexcept
 {
+	//	The capture thread points at other, it has to be restarted after a move
+	other.stopCapture();
+
 	// Move all data
-	pEnumerator = other.pEnumerator;
-	pDevice = other.pDevice;
-	pAudioClient = other.pAudioClient;
-	pCaptureClient = other.pCaptureClient;
-	hnsRequestedDuration = other.hnsRequestedDuration;
-	pwfx = other.pwfx;
-	cfg = other.cfg;
+	source = std::move(other.source);
+	packet = other.packet;
+	validAudioDevice = other.validAudioDevice;
+	sourceFormat = other.sourceFormat;
+	spectrumFft = std::move(other.spectrumFft);
+	spectrumRe = std::move(other.spectrumRe);
+	spectrumIm = std::move(other.spectrumIm);
 	magnitudes = std::move(other.magnitudes);
-	accumulator = std::move(other.accumulator);
+	barBinner = std::move(other.barBinner);
+	barHeights = std::move(other.barHeights);
+	prevBarHeights = std::move(other.prevBarHeights);
+	barCount = other.barCount;
+	vertexRing = std::exchange(other.vertexRing, {});
+	vertexArray = std::exchange(other.vertexArray, 0);
+	gpuSmoother = std::exchange(other.gpuSmoother, {});
+	heightRing = std::exchange(other.heightRing, {});
+	instancedVAO = std::exchange(other.instancedVAO, 0);
+	instancedDivisor = other.instancedDivisor;
+	renderManager = std::exchange(other.renderManager, {});
+	programCache = std::move(other.programCache);
+	fullscreenVAO = std::exchange(other.fullscreenVAO, 0);
+	heightTexture = std::exchange(other.heightTexture, 0);
+	requestedUpload = other.requestedUpload;
+	fftInput = std::move(other.fftInput);
+	sampleRing = std::move(other.sampleRing);
+	stampRing = std::move(other.stampRing);
+	windowStamp = other.windowStamp;
+	stft = other.stft;
+	requestedHop.store(other.requestedHop.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	requestedWindow.store(other.requestedWindow.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	constantQ = std::move(other.constantQ);
+	cqtStft = other.cqtStft;
+	cqtFft = std::move(other.cqtFft);
+	cqtInput = std::move(other.cqtInput);
+	cqtRe = std::move(other.cqtRe);
+	cqtIm = std::move(other.cqtIm);
+	cqtBinRe = std::move(other.cqtBinRe);
+	cqtBinIm = std::move(other.cqtBinIm);
+	requestedAnalysis.store(other.requestedAnalysis.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	lastAnalysis = other.lastAnalysis;
+	consumedAnalysis = other.consumedAnalysis;
 	colors = std::move(other.colors);
+	settings = other.settings;
 	defaultShaderProgram = other.defaultShaderProgram;
 	symmetricShaderProgram = other.symmetricShaderProgram;
 	doubleSymmetricShaderProgram = other.doubleSymmetricShaderProgram;
-	barCountUniform1 = other.barCountUniform1;
-	barCountUniform2 = other.barCountUniform2;
-	barCountUniform3 = other.barCountUniform3;
-	colorLocation1 = other.colorLocation1;
-	colorLocation2 = other.colorLocation2;
-	colorLocation3 = other.colorLocation3;
+	instancedShaderProgram = other.instancedShaderProgram;
+	fullscreenShaderProgram = other.fullscreenShaderProgram;
 
 
 	// Invalidate the source
-	other.pEnumerator = nullptr;
-	other.pDevice = nullptr;
-	other.pAudioClient = nullptr;
-	other.pCaptureClient = nullptr;
-	other.pwfx = nullptr;
-	other.cfg = nullptr;
+	other.packet = {};
+	other.validAudioDevice = false;
 }
 
 
@@ -150,33 +135,59 @@ AudioManager& AudioManager::operator=(AudioManager&& other) noexcept
 
 
 	// Release existing resources first
-	if (pEnumerator) pEnumerator->Release();
-	if (pDevice) pDevice->Release();
-	if (pAudioClient) pAudioClient->Release();
-	if (pCaptureClient) pCaptureClient->Release();
-	if (pwfx) CoTaskMemFree(pwfx);
-	if (cfg) free(cfg);
+	stopCapture();
+	other.stopCapture();
+	if (source && packet.data) source->releasePacket();
 
 
 	// Move data
-	pEnumerator = other.pEnumerator;
-	pDevice = other.pDevice;
-	pAudioClient = other.pAudioClient;
-	pCaptureClient = other.pCaptureClient;
-	hnsRequestedDuration = other.hnsRequestedDuration;
-	pwfx = other.pwfx;
-	cfg = other.cfg;
+	source = std::move(other.source);
+	packet = other.packet;
+	validAudioDevice = other.validAudioDevice;
+	sourceFormat = other.sourceFormat;
+	spectrumFft = std::move(other.spectrumFft);
+	spectrumRe = std::move(other.spectrumRe);
+	spectrumIm = std::move(other.spectrumIm);
 	magnitudes = std::move(other.magnitudes);
-	accumulator = std::move(other.accumulator);
+	barBinner = std::move(other.barBinner);
+	barHeights = std::move(other.barHeights);
+	prevBarHeights = std::move(other.prevBarHeights);
+	barCount = other.barCount;
+	vertexRing = std::exchange(other.vertexRing, {});
+	vertexArray = std::exchange(other.vertexArray, 0);
+	gpuSmoother = std::exchange(other.gpuSmoother, {});
+	heightRing = std::exchange(other.heightRing, {});
+	instancedVAO = std::exchange(other.instancedVAO, 0);
+	instancedDivisor = other.instancedDivisor;
+	renderManager = std::exchange(other.renderManager, {});
+	programCache = std::move(other.programCache);
+	fullscreenVAO = std::exchange(other.fullscreenVAO, 0);
+	heightTexture = std::exchange(other.heightTexture, 0);
+	requestedUpload = other.requestedUpload;
+	fftInput = std::move(other.fftInput);
+	sampleRing = std::move(other.sampleRing);
+	stampRing = std::move(other.stampRing);
+	windowStamp = other.windowStamp;
+	stft = other.stft;
+	requestedHop.store(other.requestedHop.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	requestedWindow.store(other.requestedWindow.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	constantQ = std::move(other.constantQ);
+	cqtStft = other.cqtStft;
+	cqtFft = std::move(other.cqtFft);
+	cqtInput = std::move(other.cqtInput);
+	cqtRe = std::move(other.cqtRe);
+	cqtIm = std::move(other.cqtIm);
+	cqtBinRe = std::move(other.cqtBinRe);
+	cqtBinIm = std::move(other.cqtBinIm);
+	requestedAnalysis.store(other.requestedAnalysis.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	lastAnalysis = other.lastAnalysis;
+	consumedAnalysis = other.consumedAnalysis;
+	colors = std::move(other.colors);
 
 
 	// Invalidate the source
-	other.pEnumerator = nullptr;
-	other.pDevice = nullptr;
-	other.pAudioClient = nullptr;
-	other.pCaptureClient = nullptr;
-	other.pwfx = nullptr;
-	other.cfg = nullptr;
+	other.packet = {};
+	other.validAudioDevice = false;
 
 	return *this;
 }
@@ -185,27 +196,14 @@ AudioManager& AudioManager::operator=(AudioManager&& other) noexcept
 // Fills the vector with audio samples at various frequencies
 bool AudioManager::getAudioSample()
 {
-	numChannels = pwfx->nChannels;
-
-	// Get the current audio buffer
-	hr = pCaptureClient->GetBuffer(&pData, &numFramesAvailable, &flags, nullptr, nullptr);
-	if (FAILED(hr))
-	{
-		pCaptureClient->ReleaseBuffer(numFramesAvailable);
-		std::cerr << "hr failed with code: " << hr << std::endl;
-		THROW_ON_ERROR(hr, "Failed to get buffer");
-	}
-
-
-
-	// Flags is a bitfield returned by buffer, Bitwise AND to check for silence
-	// If silent, fill the sample with all 0.0f and return to save time
-	if (flags & AUDCLNT_BUFFERFLAGS_SILENT) {
-		std::fill(magnitudes.begin(), magnitudes.end(), 0.0f);
-		pCaptureClient->ReleaseBuffer(numFramesAvailable);
+	packet = {};
+	if (!source || !source->acquirePacket(packet)) {
+		packet = {};
 		return false;
 	}
 
+	//	Silent packets go through vectorizeMagnitudes too, downmixPacket writes them to the ring as zeros
+	//	the same way the capture thread does
 	return true;
 }
 
@@ -213,144 +211,430 @@ bool AudioManager::getAudioSample()
 //	Only run this if GetAudioSample returns true
 void AudioManager::vectorizeMagnitudes()
 {
-	// Copy the audio sample into a kissfft friendly vector
-	const auto* floatData = reinterpret_cast<float*>(pData);
+	spectrumScale.store(static_cast<float>(settings.windowHeight) / 10.0f, std::memory_order_relaxed);
+	downmixPacket(packet);
 
-	for (UINT32 i = 0; i < numFramesAvailable; ++i) {
-		if (numChannels == 2) {
-			// Average left and right
-			accumulator.push_back(0.5f * (floatData[i * 2] + floatData[i * 2 + 1]));
-		}
-		else if (numChannels == 1) {
-			// Mono already
-			accumulator.push_back(floatData[i]);
-		}
+	// Let the source know youre done reading from the buffer so it can overwrite
+	if (source && packet.data) source->releasePacket();
+	packet = {};
+
+	while (analyseNextBlock(magnitudes)) {
+		consumedCaptureTime = analysedCaptureTime;
+		consumedAnalysis = lastAnalysis;
 	}
+}
 
-	if (accumulator.size() >= FFT_COUNT) {
-		for (UINT32 i = 0; i < numFramesAvailable; i++) {
-			if (i < audioSample.size()) {
-				audioSample[i].r = accumulator[i];
-				audioSample[i].i = 0.0f; // no imaginary component
-			}
+
+//	Downmixes and converts a packet straight into the sample ring, producer side
+//	Frames that do not fit are dropped and counted by the ring
+void AudioManager::downmixPacket(const AudioPacket& p)
+{
+	PROFILE_ZONE("downmix");
+	const size_t frameBytes = sourceFormat.bytesPerFrame();
+	const uint32_t numFramesAvailable = p.frames;
+
+	uint32_t frame = 0;
+	while (frame < numFramesAvailable) {
+		const std::span<float> out = sampleRing->writableSpan(numFramesAvailable - frame);
+		if (out.empty()) {
+			sampleRing->recordOverflow(numFramesAvailable - frame);
+			break;
 		}
 
+		const uint32_t n = std::min<uint32_t>(static_cast<uint32_t>(out.size()), numFramesAvailable - frame);
+		if (p.silent)
+			std::fill_n(out.data(), n, 0.0f);
+		else
+			downmixToMono(p.data + static_cast<size_t>(frame) * frameBytes, sourceFormat.sampleFormat, sourceFormat.channels, out.data(), n);
 
-		accumulator.resize(0);
+		sampleRing->commitWrite(n);
+		frame += n;
+	}
+	if (frame == 0) return;
 
-		// Let windows know youre done reading from the buffer so it can overwrite
-		pCaptureClient->ReleaseBuffer(numFramesAvailable);
+	//	Stamped after the samples, the consumer extrapolates from the previous stamp until this one shows up.
+	//	Dropped frames are the newest, so the last one written is that much older than the packet stamp.
+	const auto stamped = p.captureTime == std::chrono::steady_clock::time_point{} ? std::chrono::steady_clock::now() : p.captureTime;
+	const CaptureStamp stamp{ sampleRing->totalWritten(), stamped - framesDuration(numFramesAvailable - frame) };
+	stampRing->push(&stamp, 1);
+}
 
-		if (numFramesAvailable < FFT_COUNT) {
-			std::cout << "Not enough Frames!" << std::endl;
-		}
 
-		// Apply Hanning window
-		//for (UINT32 i = 0; i < FFT_COUNT; ++i) {
-		//	float multiplier = 0.5f * (1.0f - cosf(2.0f * 3.1415926535f * i / (FFT_COUNT - 1)));
-		//	audioSample[i].r *= multiplier;
-		//}
+//	How long count frames last at the source rate
+std::chrono::steady_clock::duration AudioManager::framesDuration(const int64_t count) const
+{
+	return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::nanoseconds(count * 1000000000 / static_cast<int64_t>(sourceFormat.sampleRate)));
+}
 
-		// Do the FFT to get the output data
-		kiss_fft(cfg, audioSample.data(), visualData.data());
 
+//	Capture time of the sample just before position end in the sample ring, consumer side.
+//	Stamps of packets that ended before it are dropped, the first one that reaches it is interpolated
+//	back, and if its packet has not been stamped yet the newest stamp is extrapolated forward.
+std::chrono::steady_clock::time_point AudioManager::sampleCaptureTime(const uint64_t end)
+{
+	for (std::span<const CaptureStamp> queued = stampRing->readableSpan(); !queued.empty(); queued = stampRing->readableSpan()) {
+		windowStamp = queued.front();
+		if (windowStamp.end >= end) break;
+		stampRing->consume(1);
+	}
 
-		// Store the resulting magnitudes back into the original vector
-		// visualData.r will now contain the magnitudes
-		// We only need half the data here because the FFT is symmetric
-		for (UINT32 i = 0; i < FFT_COUNT / 2; ++i) {
-			magnitudes[i] = sqrtf(visualData[i].r * visualData[i].r + visualData[i].i * visualData[i].i);
-			magnitudes[i] = log2(magnitudes[i]);
-			magnitudes[i] *= static_cast<float>(settings.windowHeight) / 10.0f;
-		}
+	//	Nothing stamped yet, only possible for the very first window
+	if (windowStamp.end == 0) return std::chrono::steady_clock::now();
+	return windowStamp.time - framesDuration(static_cast<int64_t>(windowStamp.end) - static_cast<int64_t>(end));
+}
+
+
+void AudioManager::setWindow(const WindowType type)
+{
+	requestedWindow.store(type, std::memory_order_relaxed);
+}
+
+
+void AudioManager::setAnalysis(const SpectrumAnalysis analysis)
+{
+	//	Built before the analysis side can see the switch, and never touched again
+	if (analysis == SpectrumAnalysis::ConstantQ && !cqtFft) {
+		ConstantQLayout layout;
+		layout.sampleRate = sourceFormat.sampleRate;
+		layout.fftSize = CQT_FFT_SIZE;
+		layout.minFrequency = CQT_MIN_FREQUENCY;
+		layout.maxFrequency = std::min(20000.0f, CQT_MIN_FREQUENCY * std::exp2(static_cast<float>(magnitudes.size() - 1) / CQT_BINS_PER_OCTAVE));
+		layout.binsPerOctave = CQT_BINS_PER_OCTAVE;
+		layout.gamma = CQT_GAMMA;
+		layout.gain = static_cast<float>(FFT_COUNT);	//	Same bar height as the Hann windowed FFT for the same sine
+		constantQ.configure(layout);
+
+		cqtInput.resize(CQT_FFT_SIZE);
+		cqtRe.resize(ConstantQFft::bins);
+		cqtIm.resize(ConstantQFft::bins);
+		cqtBinRe.resize(constantQ.binCount());
+		cqtBinIm.resize(constantQ.binCount());
+		cqtFft = std::make_unique<ConstantQFft>();
 	}
+	requestedAnalysis.store(analysis, std::memory_order_release);
 }
 
 
-void AudioManager::RenderAudio(const GLFWwindow* w, const GLuint& VBO, const GLuint& VAO)
+void AudioManager::setStftHop(const uint32_t hop)
 {
-	if (!w) throw (std::invalid_argument("No render window found in RenderAudio()"));
+	if (hop == 0 || hop > FFT_COUNT)
+		throw std::invalid_argument("STFT hop must be between 1 and FFT_COUNT");
+	requestedHop.store(hop, std::memory_order_relaxed);
+}
 
-	if (getAudioSample())
-		vectorizeMagnitudes();
 
-	if (settings.smoothing) smoothMagnitudes();
-	this->genMinVerts();
-	glBindVertexArray(VAO);
+//	Runs the FFT over the next STFT window waiting in the sample ring, consumer side
+//	Returns true if a new spectrum was written to out
+bool AudioManager::analyseNextBlock(std::vector<float>& out)
+{
+	const uint32_t hop = requestedHop.load(std::memory_order_relaxed);
+	const SpectrumAnalysis analysis = requestedAnalysis.load(std::memory_order_acquire);
+	if (analysis != lastAnalysis) {
+		//	Only the newest window of the new length stays queued, so switching never adds lag
+		const size_t length = analysis == SpectrumAnalysis::ConstantQ ? CQT_FFT_SIZE : FFT_COUNT;
+		if (const size_t queued = sampleRing->readAvailable(); queued > length) sampleRing->consume(queued - length);
+		lastAnalysis = analysis;
+	}
+	if (analysis == SpectrumAnalysis::ConstantQ) return analyseConstantQ(out, hop);
 
+	if (hop != stft.hopSize()) stft.setHopSize(hop);
 
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * minVerts.size(), minVerts.data(), GL_DYNAMIC_DRAW);
+	// Copy the window out of the ring with the window function applied on the way,
+	// the ring only advances by the hop
+	const WindowType window = requestedWindow.load(std::memory_order_relaxed);
+	const uint64_t windowEnd = sampleRing->totalRead() + FFT_COUNT;
+	if (!stft.nextFrame(*sampleRing, fftInput.data(), windowTable<FFT_COUNT>(window).data())) return false;
+	analysedCaptureTime = sampleCaptureTime(windowEnd);
+	PROFILE_ZONE("fft");
 
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(
-		0,                  // attribute index (must match your shader's layout(location = 0))
-		2,                  // number of components per vertex attribute
-		GL_FLOAT,           // type
-		GL_TRUE,           // normalized?
-		2 * sizeof(float),  // stride (distance between consecutive vertices)
-		static_cast<void*>(nullptr)            // offset in the buffer
-	);
+	// Do the FFT to get the output data
+	// Audio is purely real so the real transform skips the redundant upper half
+	spectrumFft->forward(fftInput.data(), spectrumRe.data(), spectrumIm.data());
 
 
-	static int prevModeIndx = -1;
+	// Store the resulting log magnitudes back into the original vector, clamped at 0 so empty bins stay 0
+	// Bins 0 to FFT_COUNT / 2 - 1 are drawn, the Nyquist bin is not
+	logMagnitudes(spectrumRe.data(), spectrumIm.data(), out.data(), FFT_COUNT / 2, spectrumScale.load(std::memory_order_relaxed));
 
-	if (prevModeIndx != settings.modeIndex)
-	{
-		switch (settings.modeIndex) {
-		case DEFAULT_M:
+	return true;
+}
 
-			glUseProgram(defaultShaderProgram);
-			glUniform4f(colorLocation1, settings.barColor[0], settings.barColor[1], settings.barColor[2], settings.barColor[3]);
-			glUniform1i(barCountUniform2, BAR_COUNT);
-			prevModeIndx = settings.modeIndex;
-			break;
 
-		case SYMMETRIC_M:
+//	Constant-Q version of the above. The frame goes in unwindowed (the kernels carry their own windows),
+//	one CQT_FFT_SIZE point FFT, then the sparse kernels pick out the bins
+bool AudioManager::analyseConstantQ(std::vector<float>& out, const uint32_t hop)
+{
+	if (hop != cqtStft.hopSize()) cqtStft.setHopSize(hop);
 
-			glUseProgram(symmetricShaderProgram);
-			glUniform4f(colorLocation2, settings.barColor[0], settings.barColor[1], settings.barColor[2], settings.barColor[3]);
-			glUniform1i(barCountUniform2, BAR_COUNT);
-			prevModeIndx = settings.modeIndex;
-			break;
+	const uint64_t windowEnd = sampleRing->totalRead() + CQT_FFT_SIZE;
+	if (!cqtStft.nextFrame(*sampleRing, cqtInput.data())) return false;
+	analysedCaptureTime = sampleCaptureTime(windowEnd);
+	PROFILE_ZONE("cqt");
 
-		case DOUBLE_SYM_M:
+	cqtFft->forward(cqtInput.data(), cqtRe.data(), cqtIm.data());
+	constantQ.apply(cqtRe.data(), cqtIm.data(), cqtBinRe.data(), cqtBinIm.data());
 
-			glUseProgram(doubleSymmetricShaderProgram);
-			glUniform4f(colorLocation3, settings.barColor[0], settings.barColor[1], settings.barColor[2], settings.barColor[3]);
-			glUniform1i(barCountUniform3, BAR_COUNT);
-			prevModeIndx = settings.modeIndex;
-			break;
-		default: ;
+	const size_t bins = constantQ.binCount();
+	logMagnitudes(cqtBinRe.data(), cqtBinIm.data(), out.data(), bins, spectrumScale.load(std::memory_order_relaxed));
+	std::fill(out.begin() + static_cast<std::ptrdiff_t>(bins), out.end(), 0.0f);
+	return true;
+}
+
+
+void AudioManager::startCapture()
+{
+	if (!validAudioDevice || captureThread) return;
+
+	//	Neither thread is running yet, the only time the handoff may be reset
+	SpectrumFrame empty;
+	empty.magnitudes.assign(magnitudes.size(), 0.0f);
+	spectrumHandoff.reset(empty);
+	publishedSequence = consumedSequence = 0;
+
+	stopAnalysis.store(false, std::memory_order_relaxed);
+	analysisThread = std::thread(&AudioManager::analysisLoop, this);
+
+	captureThread = std::make_unique<CaptureThread>(*source, [this](const AudioPacket& p) { onCapturedPacket(p); });
+	captureThread->start();
+}
+
+
+void AudioManager::stopCapture() noexcept
+{
+	if (captureThread) {
+		captureThread->stop();
+		captureThread.reset();
+	}
+
+	if (analysisThread.joinable()) {
+		stopAnalysis.store(true, std::memory_order_relaxed);
+		samplesPublished.fetch_add(1, std::memory_order_release);
+		samplesPublished.notify_one();
+		analysisThread.join();
+	}
+}
+
+
+//	Runs on the capture thread
+void AudioManager::onCapturedPacket(const AudioPacket& p)
+{
+	PROFILE_ZONE("capture");
+	downmixPacket(p);
+
+	//	Wake the analysis thread, notify is cheap when it is not waiting
+	samplesPublished.fetch_add(1, std::memory_order_release);
+	samplesPublished.notify_one();
+}
+
+
+//	Analysis thread, sleeps until the capture thread has pushed new samples
+void AudioManager::analysisLoop()
+{
+	Profiler::setThreadName("analysis");
+	while (!stopAnalysis.load(std::memory_order_relaxed)) {
+		const uint32_t seen = samplesPublished.load(std::memory_order_acquire);
+
+		//	Publish every spectrum so a backlog never starves the render thread
+		while (analyseNextBlock(spectrumHandoff.writeBuffer().magnitudes))
+			publishSpectrum();
+
+		samplesPublished.wait(seen, std::memory_order_acquire);
+	}
+}
+
+
+//	Analysis thread side of the handoff, the magnitudes were already written in place
+void AudioManager::publishSpectrum()
+{
+	SpectrumFrame& frame = spectrumHandoff.writeBuffer();
+	frame.sequence = ++publishedSequence;
+	frame.captureTime = analysedCaptureTime;
+	frame.analysis = lastAnalysis;
+	spectrumHandoff.publish();
+}
+
+
+//	Render thread side, copies the newest spectrum into magnitudes if there is one we have not seen
+bool AudioManager::consumeLatestSpectrum()
+{
+	if (!spectrumHandoff.update()) return false;
+
+	const SpectrumFrame& frame = spectrumHandoff.readBuffer();
+	std::copy(frame.magnitudes.begin(), frame.magnitudes.end(), magnitudes.begin());
+	consumedSequence = frame.sequence;
+	consumedCaptureTime = frame.captureTime;
+	consumedAnalysis = frame.analysis;
+	return true;
+}
+
+
+void AudioManager::RenderAudio(const GLFWwindow* w, const GLuint& VAO)
+{
+	if (!w) throw (std::invalid_argument("No render window found in RenderAudio()"));
+	PROFILE_ZONE("render");
+
+	spectrumScale.store(static_cast<float>(settings.windowHeight) / 10.0f, std::memory_order_relaxed);
+
+	//	With a capture thread running we only pick up the newest finished spectrum,
+	//	otherwise fall back to polling the source once per frame
+	if (captureThread) {
+		captureThread->rethrowIfFailed();
+		consumeLatestSpectrum();
+	}
+	else if (validAudioDevice && getAudioSample())
+		vectorizeMagnitudes();
+
+	//	The feedback pass writes float vertices, so GPU smoothing goes with the geometry shader path.
+	//	Either way the bars are smoothed after binning, so both filter the same per bar signal.
+	const bool instanced = settings.renderPath == RenderPath::Instanced && instancedShaderProgram != 0;
+	const bool fullscreen = settings.renderPath == RenderPath::Fullscreen && fullscreenShaderProgram != 0;
+	const bool gpuSmoothing = !instanced && !fullscreen && settings.smoothing && settings.gpuSmoothing && gpuSmoother.ready();
+	if (const unsigned int count = resolveBarCount(); count != barCount) resizeBars(count);
+	binBars();
+	if (settings.smoothing && !gpuSmoothing) smoothBars();
+
+	renderManager.beginFrame();
+	const auto uploadStart = std::chrono::steady_clock::now();
+	GLint firstVertex = 0;
+	if (instanced) {
+		renderManager.bindVertexArray(instancedVAO);
+		this->genBarHeights(static_cast<uint16_t*>(heightRing.map()));
+		firstVertex = heightRing.unmap(sizeof(uint16_t) * barCount, sizeof(uint16_t));
+
+		//	GL 3.3 has no base instance, so the per instance attribute follows the ring segment instead
+		glBindBuffer(GL_ARRAY_BUFFER, heightRing.name());
+		glVertexAttribPointer(0, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(uint16_t), reinterpret_cast<void*>(static_cast<size_t>(firstVertex) * sizeof(uint16_t)));
+		if (const GLuint divisor = settings.modeIndex == DOUBLE_SYM_M ? 2 : 1; divisor != instancedDivisor) {
+			glVertexAttribDivisor(0, divisor);
+			instancedDivisor = divisor;
 		}
 	}
+	else if (fullscreen) {
+		//	The buffer texture reads the ring directly, only the offset of this frame's segment changes
+		renderManager.bindVertexArray(fullscreenVAO);
+		this->genBarHeights(static_cast<uint16_t*>(heightRing.map()));
+		firstVertex = heightRing.unmap(sizeof(uint16_t) * barCount, sizeof(uint16_t));
+		renderManager.bindTexture(GL_TEXTURE_BUFFER, heightTexture);
+	}
+	else if (gpuSmoothing) {
+		//	Only the raw bar heights go up, the feedback pass writes the vertices. It binds its own
+		//	program and VAO, so the cache has to forget what it thought was bound.
+		const auto [horizScale, vertScale] = minVertScales();
+		gpuSmoother.run(barHeights.data(), barCount, settings.smoothingCoef, horizScale, vertScale);
+		renderManager.invalidate();
+		renderManager.bindVertexArray(gpuSmoother.vertexArray());
+	}
+	else {
+		//	The VAO already points at the ring, only the vertex data changes from frame to frame
+		renderManager.bindVertexArray(VAO);
+		this->genMinVerts(static_cast<float*>(vertexRing.map()));
+		firstVertex = vertexRing.unmap(sizeof(float) * 2 * barCount, sizeof(float) * 2);
+	}
+	const auto uploadDuration = std::chrono::steady_clock::now() - uploadStart;
+	PROFILE_SAMPLE("upload", uploadDuration);
+	uploadTime += uploadDuration;
+	uploadFrames++;
+
+	//	Every program reads the same block, unchanged values cost nothing
+	PROFILE_ZONE("draw");
+	renderManager.setBaseColor(settings.barColor);
+	renderManager.setBarCount(static_cast<int32_t>(barCount));
+	renderManager.setMode(static_cast<int32_t>(settings.modeIndex));
+	if (fullscreen) renderManager.setFirstBar(firstVertex);
+	renderManager.flushUniforms();
+
+	if (instanced) {
+		renderManager.useProgram(instancedShaderProgram);
+		const GLsizei instances = static_cast<GLsizei>(barCount) * (settings.modeIndex == DOUBLE_SYM_M ? 2 : 1);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instances);
+		heightRing.fence();
+	}
+	else if (fullscreen) {
+		//	One triangle whatever the bar count, the fragment shader finds the bar under each pixel
+		renderManager.useProgram(fullscreenShaderProgram);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		heightRing.fence();
+	}
+	else {
+		renderManager.useProgram(modeProgram());
+		glDrawArrays(GL_POINTS, firstVertex, static_cast<GLsizei>(barCount));
+		if (!gpuSmoothing) vertexRing.fence();
+	}
+}
 
-	glDrawArrays(GL_POINTS, 0, minVerts.size() / 2);
-	glBindVertexArray(0);
+
+GLuint AudioManager::modeProgram() const {
+	switch (settings.modeIndex) {
+	case SYMMETRIC_M: return symmetricShaderProgram;
+	case DOUBLE_SYM_M: return doubleSymmetricShaderProgram;
+	default: return defaultShaderProgram;
+	}
 }
 
 
-void AudioManager::genMinVerts() {
-	static bool first = true;
-	const float pixPerBar = static_cast<float>(settings.windowWidth) / static_cast<float>(BAR_COUNT);
+//	The weight table is only rebuilt when the bar layout changes
+void AudioManager::binBars() {
+	PROFILE_ZONE("binning");
+	BarLayout layout;
+	layout.binCount = magnitudes.size();
+	layout.fftSize = FFT_COUNT;
+	layout.sampleRate = sourceFormat.sampleRate;
+	layout.barCount = barCount;
+	layout.scale = settings.barScale;
+	if (consumedAnalysis == SpectrumAnalysis::ConstantQ) {
+		layout.binCount = constantQ.binCount();
+		layout.fftSize = CQT_FFT_SIZE;
+		layout.binsPerOctave = constantQ.layout().binsPerOctave;
+		layout.firstBinFrequency = constantQ.layout().minFrequency;
+	}
+
+	barBinner.configure(layout);
+	barBinner.apply(magnitudes.data(), barHeights.data());
+}
+
+
+unsigned int AudioManager::resolveBarCount() const {
+	const unsigned int wanted = settings.barCount == BAR_COUNT_AUTO
+		? static_cast<unsigned int>(std::max(settings.windowWidth, 0)) / AUTO_BAR_PIXELS
+		: settings.barCount;
+	return std::clamp(wanted, MIN_BAR_COUNT, MAX_BAR_COUNT);
+}
+
+
+void AudioManager::resizeBars(const unsigned int count) {
+	barCount = count;
+	barHeights.resize(count);
+	colors.resize(count * 3);
+
+	//	Smoothing state belongs to the old bars
+	prevBarHeights.clear();
+	if (gpuSmoother.ready()) gpuSmoother.reset();
+}
+
+
+std::pair<float, float> AudioManager::minVertScales() const {
+	const float pixPerBar = static_cast<float>(settings.windowWidth) / static_cast<float>(barCount);
 
 	const float horizScale = 2.0f * static_cast<float>(pixPerBar) / static_cast<float>(settings.windowWidth);
 	const float vertScale = this->settings.barHeightScale * 1 / this->settings.windowHeight;
+	return { horizScale, vertScale };
+}
 
-	if (first) minVerts.resize(BAR_COUNT * 2);
 
-	for (int i = 0; i < BAR_COUNT; i++) {
-		minVerts[i * 2] = static_cast<float>(i) * horizScale - 1.0f;	//	x
-		if (magnitudes[i] <= 0.01f)			// y
-			minVerts[i * 2 + 1] = 0.01f;
-		else
-			minVerts[i * 2 + 1] = magnitudes[i] * vertScale + 0.01f;  // controls for min bar height  
-	}
+void AudioManager::genMinVerts(float* minVerts) const {
+	const auto [horizScale, vertScale] = minVertScales();
+	genBarVertices(barHeights.data(), barCount, horizScale, vertScale, minVerts);
+}
+
+
+void AudioManager::genBarHeights(uint16_t* heights) const {
+	genBarHeights16(barHeights.data(), barCount, minVertScales().second, heights);
 }
 
 
 void AudioManager::genColors() {
-	for (int i = 0; i < BAR_COUNT; i++) {
+	for (unsigned int i = 0; i < barCount; i++) {
 		int index = i * 3;
 		colors[index] = settings.baseColor[0];
 		colors[index + 1] = settings.baseColor[1];
@@ -383,90 +667,113 @@ void AudioManager::openGLInit(GLuint& VBO, GLuint& VAO) {
 	//glfwSwapInterval(1); // Enable vsync
 
 
-	defaultShaderProgram = glCreateProgram();
-	symmetricShaderProgram = glCreateProgram();
-	doubleSymmetricShaderProgram = glCreateProgram();
-
-	int success;
+	//	Sources are compiled in, linked programs come from the binary cache when the driver and the sources match
+	const auto linkOrAbort = [this](const char* name, const std::initializer_list<ShaderStage> stages) {
+		const GLuint program = programCache.link(name, stages);
+		if (!program) {
+			std::cerr << "Failed to link " << name << " shaders\n";
+			std::abort();
+		}
+		glValidateProgram(program);
+		return program;
+	};
 
-	GLuint vertexShader;
-	compileShader(fileToString("../shaders/default.vert").data(), vertexShader, GL_VERTEX_SHADER, success);
-	GLuint fragmentShader;
-	compileShader(fileToString("../shaders/default.frag").data(), fragmentShader, GL_FRAGMENT_SHADER, success);
-	GLuint symGeomShader;
-	compileShader(fileToString("../shaders/symmetric.geom").data(), symGeomShader, GL_GEOMETRY_SHADER, success);
-	GLuint defGeomShader;
-	compileShader(fileToString("../shaders/default.geom").data(), defGeomShader, GL_GEOMETRY_SHADER, success);
-	GLuint dblSymGeomShader;
-	compileShader(fileToString("../shaders/doubleSym.geom").data(), dblSymGeomShader, GL_GEOMETRY_SHADER, success);
+	const std::string_view vertexShader = shaderSource("default.vert");
+	const std::string_view fragmentShader = shaderSource("default.frag");
 
+	defaultShaderProgram = linkOrAbort("default", {
+		{ GL_VERTEX_SHADER, vertexShader }, { GL_GEOMETRY_SHADER, shaderSource("default.geom") }, { GL_FRAGMENT_SHADER, fragmentShader } });
+	symmetricShaderProgram = linkOrAbort("symmetric", {
+		{ GL_VERTEX_SHADER, vertexShader }, { GL_GEOMETRY_SHADER, shaderSource("symmetric.geom") }, { GL_FRAGMENT_SHADER, fragmentShader } });
+	doubleSymmetricShaderProgram = linkOrAbort("doubleSymmetric", {
+		{ GL_VERTEX_SHADER, vertexShader }, { GL_GEOMETRY_SHADER, shaderSource("doubleSym.geom") }, { GL_FRAGMENT_SHADER, fragmentShader } });
 
+	//	Instanced path, same fragment shader and no geometry stage
+	instancedShaderProgram = linkOrAbort("instanced", {
+		{ GL_VERTEX_SHADER, shaderSource("bars.vert") }, { GL_FRAGMENT_SHADER, fragmentShader } });
 
-	glAttachShader(defaultShaderProgram, vertexShader);
-	glAttachShader(defaultShaderProgram, fragmentShader);
-	glAttachShader(defaultShaderProgram, defGeomShader);
-	glLinkProgram(defaultShaderProgram);
+	//	Fullscreen path, its own fragment shader does all the work
+	fullscreenShaderProgram = linkOrAbort("fullscreen", {
+		{ GL_VERTEX_SHADER, shaderSource("fullscreen.vert") }, { GL_FRAGMENT_SHADER, shaderSource("fullscreen.frag") } });
 
-	glGetProgramiv(defaultShaderProgram, GL_LINK_STATUS, &success);
-	if (!success) {
-		std::cerr << "Failed to link default shaders\n";
-		std::abort();
-	}
-
-
-	glAttachShader(symmetricShaderProgram, vertexShader);
-	glAttachShader(symmetricShaderProgram, fragmentShader);
-	glAttachShader(symmetricShaderProgram, symGeomShader);
-	glLinkProgram(symmetricShaderProgram);
-
-	glGetProgramiv(symmetricShaderProgram, GL_LINK_STATUS, &success);
-	if (!success) {
-		std::cerr << "Failed to link symmetric shaders\n";
-		std::abort();
-	}
+	//	Samplers can not live in the uniform block, Heights always reads texture unit 0
+	glUseProgram(fullscreenShaderProgram);
+	glUniform1i(glGetUniformLocation(fullscreenShaderProgram, "Heights"), 0);
 
+	//  Set up buffers, the attribute layout never changes so the VAO is configured once here
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
 
-	glAttachShader(doubleSymmetricShaderProgram, vertexShader);
-	glAttachShader(doubleSymmetricShaderProgram, fragmentShader);
-	glAttachShader(doubleSymmetricShaderProgram, dblSymGeomShader);
-	glLinkProgram(doubleSymmetricShaderProgram);
+	//	Optional, CPU smoothing stays available if the feedback program does not link
+	int success;
+	GLuint smoothingShader;
+	compileShader(shaderSource("smoothing.vert").data(), smoothingShader, GL_VERTEX_SHADER, success);
+	if (!gpuSmoother.init(smoothingShader, MAX_BAR_COUNT, requestedUpload))
+		std::cerr << "Failed to link the smoothing feedback program, GPU smoothing disabled\n";
+	glDeleteShader(smoothingShader);
 
+	glBindVertexArray(VAO);
+	vertexArray = VAO;
+	vertexRing.init(VBO, sizeof(float) * 2 * MAX_BAR_COUNT, requestedUpload);
 
-	glValidateProgram(defaultShaderProgram);
-	glValidateProgram(symmetricShaderProgram);
-	glValidateProgram(doubleSymmetricShaderProgram);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(
+		0,                  // attribute index (must match your shader's layout(location = 0))
+		2,                  // number of components per vertex attribute
+		GL_FLOAT,           // type
+		GL_TRUE,           // normalized?
+		2 * sizeof(float),  // stride (distance between consecutive vertices)
+		static_cast<void*>(nullptr)            // offset in the buffer
+	);
 
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-	glDeleteShader(symGeomShader);
-	glDeleteShader(defGeomShader);
-	glDeleteShader(dblSymGeomShader);
+	//	Instanced path: no per vertex data, one normalised uint16 height per instance
+	GLuint heightBuffer;
+	glGenVertexArrays(1, &instancedVAO);
+	glGenBuffers(1, &heightBuffer);
+	glBindVertexArray(instancedVAO);
+	heightRing.init(heightBuffer, sizeof(uint16_t) * MAX_BAR_COUNT, requestedUpload);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(uint16_t), static_cast<void*>(nullptr));
+	glVertexAttribDivisor(0, 1);
+	glBindVertexArray(0);
 
+	//	Fullscreen path: no vertex data at all, the heights are a buffer texture over the same ring
+	glGenVertexArrays(1, &fullscreenVAO);
+	glGenTextures(1, &heightTexture);
+	glBindTexture(GL_TEXTURE_BUFFER, heightTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R16, heightRing.name());
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
 
-	// init uniforms
-	glUseProgram(getDefaultShader());
-	colorLocation1 = glGetUniformLocation(getDefaultShader(), "BaseColor");
-	barCountUniform1 = glGetUniformLocation(getDefaultShader(), "BarCount");
-	glUniform4f(colorLocation1, settings.barColor[0], settings.barColor[1], settings.barColor[2], settings.barColor[3]);
-	glUniform1i(barCountUniform1, BAR_COUNT);
+	//	Last, it assumes nothing is bound yet
+	renderManager.init({ defaultShaderProgram, symmetricShaderProgram, doubleSymmetricShaderProgram, instancedShaderProgram, fullscreenShaderProgram });
+}
 
 
-	glUseProgram(getSymmetricShader());
-	colorLocation2 = glGetUniformLocation(getSymmetricShader(), "BaseColor");
-	barCountUniform2 = glGetUniformLocation(getSymmetricShader(), "BarCount");
-	glUniform4f(colorLocation2, settings.barColor[0], settings.barColor[1], settings.barColor[2], settings.barColor[3]);
-	glUniform1i(barCountUniform2, BAR_COUNT);
+void AudioManager::setUploadStrategy(const UploadStrategy strategy) {
+	requestedUpload = strategy;
+	resetUploadTime();
+	if (!vertexRing.segmentSize()) return;
 
+	//	Persistent storage is immutable, leaving it gives a ring a new buffer and whatever read the
+	//	old one is pointed at the new one. The instanced VAO and the smoother set theirs every frame.
+	if (vertexRing.setStrategy(strategy)) {
+		glBindVertexArray(vertexArray);
+		glBindBuffer(GL_ARRAY_BUFFER, vertexRing.name());
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_TRUE, 2 * sizeof(float), static_cast<void*>(nullptr));
+		glBindVertexArray(0);
+	}
+	if (heightRing.setStrategy(strategy)) {
+		glBindTexture(GL_TEXTURE_BUFFER, heightTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_R16, heightRing.name());
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+	gpuSmoother.setUploadStrategy(strategy);
+	renderManager.invalidate();
+}
 
-	glUseProgram(getDoubleSymmetricShader());
-	colorLocation3 = glGetUniformLocation(getDoubleSymmetricShader(), "BaseColor");
-	barCountUniform3 = glGetUniformLocation(getDoubleSymmetricShader(), "BarCount");
-	glUniform4f(colorLocation3, settings.barColor[0], settings.barColor[1], settings.barColor[2], settings.barColor[3]);
-	glUniform1i(barCountUniform3, BAR_COUNT);
 
-	//  Set up buffers 
-	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
+std::chrono::nanoseconds AudioManager::getAverageUploadTime() const {
+	return uploadFrames ? uploadTime / static_cast<int64_t>(uploadFrames) : std::chrono::nanoseconds(0);
 }
 
 
@@ -487,15 +794,13 @@ void AudioManager::compileShader(const char* source, GLuint& name, const GLenum
 }
 
 
-void AudioManager::smoothMagnitudes() {
-	if (prevMagnitudes.size() != magnitudes.size()) prevMagnitudes.resize(magnitudes.size());
+void AudioManager::smoothBars() {
+	PROFILE_ZONE("smoothing");
+	if (prevBarHeights.size() != barCount) prevBarHeights.assign(barCount, 0.0f);
 
-	for (int i = 0; i < magnitudes.size(); i++) {
-		float smoothedHeight = settings.smoothingCoef * prevMagnitudes[i] + (1 - settings.smoothingCoef) * magnitudes[i];
-		if (prevMagnitudes[i] >= magnitudes[i]) {
-			prevMagnitudes[i] = magnitudes[i];
-			magnitudes[i] = smoothedHeight;
-		}
-		else prevMagnitudes[i] = magnitudes[i];
+	for (unsigned int i = 0; i < barCount; i++) {
+		const float target = barHeights[i];
+		barHeights[i] = smoothedHeight(settings.smoothingCoef, prevBarHeights[i], target);
+		prevBarHeights[i] = target;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "../include/BarBinner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// ----------------------------------------------------
+// Frequency scales
+// ----------------------------------------------------
+
+static double toScale(const BarScale scale, const double hz)
+{
+	switch (scale) {
+	case BarScale::Linear: return hz;
+	case BarScale::Mel: return 2595.0 * std::log10(1.0 + hz / 700.0);
+	default: return std::log2(hz);
+	}
+}
+
+
+static double fromScale(const BarScale scale, const double u)
+{
+	switch (scale) {
+	case BarScale::Linear: return u;
+	case BarScale::Mel: return 700.0 * (std::pow(10.0, u / 2595.0) - 1.0);
+	default: return std::exp2(u);
+	}
+}
+
+
+// ----------------------------------------------------
+// BarBinner
+// ----------------------------------------------------
+
+bool BarBinner::configure(const BarLayout& layout)
+{
+	if (layout == current && !rowStart.empty()) return false;
+
+	if (layout.binCount == 0 || layout.fftSize == 0 || layout.barCount == 0 || layout.sampleRate == 0)
+		throw std::invalid_argument("Bar layout needs bins, an FFT size, bars and a sample rate");
+	if (!(layout.minFrequency > 0.0f && layout.minFrequency < layout.maxFrequency))
+		throw std::invalid_argument("Bar layout needs 0 < minFrequency < maxFrequency");
+	if (layout.binsPerOctave && !(layout.firstBinFrequency > 0.0f))
+		throw std::invalid_argument("Constant-Q bar layout needs a first bin frequency");
+
+	current = layout;
+	rowStart.clear();		//	So a layout that throws in build() is never taken as built
+	build();
+	return true;
+}
+
+
+double BarBinner::binPosition(const double hz) const
+{
+	if (current.binsPerOctave) return current.binsPerOctave * std::log2(hz / current.firstBinFrequency);
+	return hz * static_cast<double>(current.fftSize) / static_cast<double>(current.sampleRate);
+}
+
+
+double BarBinner::binFrequency(const double position) const
+{
+	if (current.binsPerOctave) return current.firstBinFrequency * std::exp2(position / current.binsPerOctave);
+	return position * static_cast<double>(current.sampleRate) / static_cast<double>(current.fftSize);
+}
+
+
+void BarBinner::build()
+{
+	const size_t bars = current.barCount;
+	const double top = std::min<double>(current.maxFrequency, binFrequency(static_cast<double>(current.binCount) - 0.5));
+
+	//	Linear bins reach down to 0 Hz, constant-Q bins stop half a bin below the first one
+	const double bottom = current.binsPerOctave
+		? std::max<double>(current.minFrequency, binFrequency(-0.5))
+		: std::min<double>(current.minFrequency, top * 0.5);
+	if (!(top > bottom)) throw std::invalid_argument("Bar layout leaves no frequencies between minFrequency and the last bin");
+
+	barEdges.resize(bars + 1);
+	if (current.scale == BarScale::Octave) {
+		//	Whole number of bands per octave, band i centred on 1 kHz * 2^(i / bandsPerOctave) and spanning
+		//	(i -/+ 0.5) / bandsPerOctave octaves. The fewest bands per octave that fit every bar inside
+		//	[bottom, top], so no band is past the last bin or below the first, the last one as high as fits.
+		//	Rounding bands per octave up can leave spare octaves, which come off the bottom.
+		const double lowest = std::log2(bottom / 1000.0), highest = std::log2(top / 1000.0);
+		double bandsPerOctave = std::max(1.0, std::ceil(static_cast<double>(bars) / (highest - lowest)));
+		double first = std::floor(bandsPerOctave * highest + 0.5) - static_cast<double>(bars);
+		while (first < std::ceil(bandsPerOctave * lowest + 0.5)) {
+			bandsPerOctave++;
+			first = std::floor(bandsPerOctave * highest + 0.5) - static_cast<double>(bars);
+		}
+		for (size_t b = 0; b <= bars; b++)
+			barEdges[b] = static_cast<float>(1000.0 * std::exp2((first + static_cast<double>(b) - 0.5) / bandsPerOctave));
+	}
+	else {
+		const double lo = toScale(current.scale, bottom), hi = toScale(current.scale, top);
+		for (size_t b = 0; b <= bars; b++)
+			barEdges[b] = static_cast<float>(fromScale(current.scale, lo + (hi - lo) * static_cast<double>(b) / static_cast<double>(bars)));
+	}
+
+	rowStart.assign(1, 0);
+	firstBin.clear();
+	weights.clear();
+
+	//	Bin k covers [k - 0.5, k + 0.5) bin widths, each bar takes the overlapping share of every bin it touches
+	for (size_t b = 0; b < bars; b++) {
+		const double lo = binPosition(barEdges[b]), hi = binPosition(barEdges[b + 1]);
+		const auto begin = static_cast<size_t>(std::max(0.0, std::floor(lo + 0.5)));
+		const size_t end = std::min(current.binCount, static_cast<size_t>(std::max(0.0, std::floor(hi + 0.5))) + 1);
+
+		//	The first bin always contains lo, only the last one can touch the bar without overlapping
+		double total = 0.0;
+		const size_t rowBegin = weights.size();
+		firstBin.push_back(static_cast<uint32_t>(begin));
+		for (size_t k = begin; k < end && hi > lo; k++) {
+			const double overlap = std::max(0.0, std::min(hi, k + 0.5) - std::max(lo, k - 0.5));
+			weights.push_back(static_cast<float>(overlap));
+			total += overlap;
+		}
+		while (weights.size() > rowBegin && weights.back() == 0.0f) weights.pop_back();
+
+		for (size_t e = rowBegin; e < weights.size(); e++)
+			weights[e] = static_cast<float>(weights[e] / total);
+		if (weights.size() == rowBegin) firstBin.back() = 0;	//	Bar above the last bin, stays at 0
+		rowStart.push_back(static_cast<uint32_t>(weights.size()));
+	}
+}
+
+
+void BarBinner::apply(const float* spectrum, float* bars) const
+{
+	for (size_t b = 0; b < firstBin.size(); b++) {
+		const float* w = weights.data() + rowStart[b];
+		const float* s = spectrum + firstBin[b];
+		const size_t count = rowStart[b + 1] - rowStart[b];
+
+		//	Four independent partial sums so wide (high frequency) bars vectorise without -ffast-math
+		float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		size_t e = 0;
+		for (; e + 4 <= count; e += 4)
+			for (size_t lane = 0; lane < 4; lane++) acc[lane] += w[e + lane] * s[e + lane];
+		for (; e < count; e++) acc[0] += w[e] * s[e];
+
+		bars[b] = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+	}
+}
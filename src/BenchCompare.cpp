@@ -0,0 +1,100 @@
+//	Compares benchmark reports and fails when a percentile got slower, for gating merges on performance.
+//
+//	BenchCompare <base> <candidate> [--threshold <percent>] [--min-delta-us <us>] [--percentiles 50,95,99]
+//
+//	base and candidate are both report files, or both directories of reports (benchmarks/out), in which
+//	case every report in base is compared with the candidate report of the same name.
+//	Exit code 0 if nothing regressed, 1 if something did, 2 on bad arguments or unreadable reports.
+
+#include "../include/ReportCompare.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static JsonValue readReport(const fs::path& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) throw std::runtime_error("Unable to open " + path.string());
+
+	std::ostringstream ss;
+	ss << file.rdbuf();
+	return JsonValue::parse(ss.str());
+}
+
+
+static std::vector<double> parsePercentiles(const std::string& list)
+{
+	std::vector<double> percentiles;
+	std::istringstream in(list);
+	for (std::string item; std::getline(in, item, ',');)
+		percentiles.push_back(std::stod(item));
+	return percentiles;
+}
+
+
+static int usage()
+{
+	std::cerr << "Usage: BenchCompare <base> <candidate> [--threshold <percent>] [--min-delta-us <us>] [--percentiles 50,95,99]\n";
+	return 2;
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 3) return usage();
+
+	const fs::path base = argv[1], candidate = argv[2];
+	CompareOptions options;
+	try {
+		for (int i = 3; i < argc; i++) {
+			if (i + 1 >= argc) return usage();
+			if (std::strcmp(argv[i], "--threshold") == 0) options.thresholdPercent = std::stod(argv[++i]);
+			else if (std::strcmp(argv[i], "--min-delta-us") == 0) options.minDeltaNs = std::stod(argv[++i]) * 1000.0;
+			else if (std::strcmp(argv[i], "--percentiles") == 0) options.percentiles = parsePercentiles(argv[++i]);
+			else return usage();
+		}
+	}
+	catch (const std::exception&) {
+		return usage();
+	}
+
+	//	Pairs of reports to compare, matched by file name for directories
+	std::vector<std::pair<fs::path, fs::path>> pairs;
+	if (fs::is_directory(base) && fs::is_directory(candidate)) {
+		for (const auto& entry : fs::directory_iterator(base)) {
+			if (entry.path().extension() != ".json") continue;
+			const fs::path match = candidate / entry.path().filename();
+			if (fs::exists(match)) pairs.emplace_back(entry.path(), match);
+			else std::cout << entry.path().filename().string() << ": no candidate report, skipped\n";
+		}
+	}
+	else pairs.emplace_back(base, candidate);
+	std::sort(pairs.begin(), pairs.end());
+
+	size_t regressions = 0, missing = 0;
+	try {
+		for (const auto& [before, after] : pairs) {
+			std::cout << before.filename().string() << "\n";
+			for (const Regression& regression : compareReports(readReport(before), readReport(after), options, std::cout))
+				++(regression.missing ? missing : regressions);
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return 2;
+	}
+
+	std::cout << (regressions ? std::to_string(regressions) + " regression(s) beyond " : std::string("No regressions beyond "))
+		<< options.thresholdPercent << "%\n";
+	if (missing) std::cout << missing << " timer(s) missing from the candidate\n";
+	return regressions || missing ? EXIT_FAILURE : EXIT_SUCCESS;
+}
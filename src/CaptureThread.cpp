@@ -0,0 +1,73 @@
+#include "../include/CaptureThread.h"
+#include "../include/Profiler.h"
+
+#include <iostream>
+#include <utility>
+
+CaptureThread::CaptureThread(AudioSource& source, PacketSink sink)
+	: source(source), sink(std::move(sink))
+{
+}
+
+
+CaptureThread::~CaptureThread() noexcept
+{
+	stop();
+}
+
+
+void CaptureThread::start()
+{
+	if (running()) return;
+
+	stopRequested.store(false, std::memory_order_relaxed);
+	failed.store(false, std::memory_order_relaxed);
+	error = nullptr;
+	thread = std::thread(&CaptureThread::run, this);
+}
+
+
+void CaptureThread::stop() noexcept
+{
+	stopRequested.store(true, std::memory_order_relaxed);
+	if (thread.joinable()) thread.join();
+}
+
+
+void CaptureThread::rethrowIfFailed()
+{
+	//	Acquire pairs with the release in run() so error is visible here
+	if (failed.load(std::memory_order_acquire)) {
+		stop();
+		failed.store(false, std::memory_order_relaxed);
+		std::rethrow_exception(std::exchange(error, nullptr));
+	}
+}
+
+
+void CaptureThread::run()
+{
+	Profiler::setThreadName("capture");
+	source.onCaptureThreadStart();
+
+	try {
+		AudioPacket packet;
+		while (!stopRequested.load(std::memory_order_relaxed)) {
+			source.waitForPacket(WAIT_TIMEOUT);
+
+			//	Drain everything the device has queued, not just one packet per wake
+			while (!stopRequested.load(std::memory_order_relaxed) && source.acquirePacket(packet)) {
+				sink(packet);
+				source.releasePacket();
+				packetCounter.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	}
+	catch (...) {
+		std::cerr << "Capture thread stopped after an error\n";
+		error = std::current_exception();
+		failed.store(true, std::memory_order_release);
+	}
+
+	source.onCaptureThreadStop();
+}
@@ -0,0 +1,120 @@
+#include "../include/ConstantQ.h"
+
+extern "C" {
+#include "kiss_fft.h"
+}
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+constexpr double TWO_PI = 6.283185307179586;
+
+bool ConstantQ::configure(const ConstantQLayout& layout)
+{
+	if (layout == current && !rowStart.empty()) return false;
+
+	if (layout.sampleRate == 0 || layout.fftSize < 2 || layout.fftSize % 2 != 0 || layout.binsPerOctave == 0)
+		throw std::invalid_argument("Constant-Q layout needs a sample rate, an even FFT size and bins per octave");
+	if (!(layout.minFrequency > 0.0f && layout.minFrequency < layout.maxFrequency && layout.minFrequency < 0.5f * static_cast<float>(layout.sampleRate)))
+		throw std::invalid_argument("Constant-Q layout needs 0 < minFrequency < maxFrequency and minFrequency below Nyquist");
+	if (!(layout.gamma >= 0.0f) || !(layout.threshold >= 0.0f && layout.threshold < 1.0f))
+		throw std::invalid_argument("Constant-Q layout needs gamma >= 0 and 0 <= threshold < 1");
+
+	current = layout;
+	build();
+	return true;
+}
+
+
+float ConstantQ::binFrequency(const size_t bin) const
+{
+	return current.minFrequency * static_cast<float>(std::exp2(static_cast<double>(bin) / current.binsPerOctave));
+}
+
+
+void ConstantQ::build()
+{
+	const size_t n = current.fftSize, half = n / 2;
+	const double fs = current.sampleRate;
+	//	A little below Nyquist, so the top kernels do not spill over it
+	const double top = std::min<double>(current.maxFrequency, 0.45 * fs);
+	const double alpha = std::exp2(1.0 / current.binsPerOctave) - 1.0;
+	const auto bins = static_cast<size_t>(std::floor(current.binsPerOctave * std::log2(top / current.minFrequency))) + 1;
+
+	lengths.clear();
+	rowStart.assign(1, 0);
+	firstBin.clear();
+	weightsRe.clear();
+	weightsIm.clear();
+
+	kiss_fft_cfg cfg = kiss_fft_alloc(static_cast<int>(n), 0, nullptr, nullptr);
+	std::vector<kiss_fft_cpx> temporal(n), spectral(n);
+	std::vector<double> magnitude(half + 1);
+
+	for (size_t k = 0; k < bins; k++) {
+		const double frequency = binFrequency(k);
+		const auto length = std::clamp<size_t>(static_cast<size_t>(std::lround(fs / (alpha * frequency + current.gamma))), 2, n);
+		lengths.push_back(length);
+
+		//	Periodic Hann, normalised by its length so the magnitude does not depend on it
+		std::fill(temporal.begin(), temporal.end(), kiss_fft_cpx{ 0.0f, 0.0f });
+		for (size_t m = 0; m < length; m++) {
+			const double w = current.gain * (0.5 - 0.5 * std::cos(TWO_PI * static_cast<double>(m) / static_cast<double>(length))) / static_cast<double>(length);
+			const double phase = TWO_PI * frequency * static_cast<double>(m) / fs;
+			temporal[n - length + m] = { static_cast<float>(w * std::cos(phase)), static_cast<float>(w * std::sin(phase)) };
+		}
+		kiss_fft(cfg, temporal.data(), spectral.data());
+
+		//	Only the non-negative frequencies exist in a real FFT, the analytic kernel has next to nothing below
+		double peak = 0.0;
+		for (size_t j = 0; j <= half; j++) {
+			magnitude[j] = std::hypot(spectral[j].r, spectral[j].i);
+			peak = std::max(peak, magnitude[j]);
+		}
+		const double cutoff = peak * current.threshold;
+		size_t begin = 0, end = half + 1;
+		while (begin < end && magnitude[begin] < cutoff) begin++;
+		while (end > begin && magnitude[end - 1] < cutoff) end--;
+
+		//	Sum over j of X[j] * conj(K[j]) / n is the correlation of the frame with the kernel (Parseval)
+		firstBin.push_back(static_cast<uint32_t>(begin));
+		for (size_t j = begin; j < end; j++) {
+			weightsRe.push_back(spectral[j].r / static_cast<float>(n));
+			weightsIm.push_back(-spectral[j].i / static_cast<float>(n));
+		}
+		rowStart.push_back(static_cast<uint32_t>(weightsRe.size()));
+	}
+
+	free(cfg);
+}
+
+
+void ConstantQ::apply(const float* re, const float* im, float* outRe, float* outIm) const
+{
+	for (size_t k = 0; k < firstBin.size(); k++) {
+		const float* wr = weightsRe.data() + rowStart[k];
+		const float* wi = weightsIm.data() + rowStart[k];
+		const float* xr = re + firstBin[k];
+		const float* xi = im + firstBin[k];
+		const size_t count = rowStart[k + 1] - rowStart[k];
+
+		//	Four independent partial sums per part, as in BarBinner::apply
+		float accRe[4] = { 0.0f, 0.0f, 0.0f, 0.0f }, accIm[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		size_t j = 0;
+		for (; j + 4 <= count; j += 4) {
+			for (size_t lane = 0; lane < 4; lane++) {
+				accRe[lane] += xr[j + lane] * wr[j + lane] - xi[j + lane] * wi[j + lane];
+				accIm[lane] += xr[j + lane] * wi[j + lane] + xi[j + lane] * wr[j + lane];
+			}
+		}
+		for (; j < count; j++) {
+			accRe[0] += xr[j] * wr[j] - xi[j] * wi[j];
+			accIm[0] += xr[j] * wi[j] + xi[j] * wr[j];
+		}
+
+		outRe[k] = (accRe[0] + accRe[1]) + (accRe[2] + accRe[3]);
+		outIm[k] = (accIm[0] + accIm[1]) + (accIm[2] + accIm[3]);
+	}
+}
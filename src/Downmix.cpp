@@ -0,0 +1,155 @@
+#include "../include/Downmix.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DOWNMIX_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define DOWNMIX_NEON
+#endif
+
+// ----------------------------------------------------
+// Sample readers
+// ----------------------------------------------------
+
+//	read() converts one little-endian sample to float unscaled, scale maps the full range to [-1, 1)
+template <SampleFormat F> struct SampleReader;
+
+template <> struct SampleReader<SampleFormat::Float32> {
+	static constexpr size_t bytes = 4;
+	static constexpr float scale = 1.0f;
+	static float read(const std::byte* p) { float v; std::memcpy(&v, p, sizeof(v)); return v; }
+};
+
+template <> struct SampleReader<SampleFormat::Int16> {
+	static constexpr size_t bytes = 2;
+	static constexpr float scale = 1.0f / 32768.0f;
+	static float read(const std::byte* p) { int16_t v; std::memcpy(&v, p, sizeof(v)); return static_cast<float>(v); }
+};
+
+template <> struct SampleReader<SampleFormat::Int24> {
+	static constexpr size_t bytes = 3;
+	static constexpr float scale = 1.0f / 8388608.0f;
+	static float read(const std::byte* p)
+	{
+		//	Assemble in the top three bytes so the arithmetic shift sign-extends
+		const uint32_t raw = (static_cast<uint32_t>(p[0]) << 8) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 24);
+		return static_cast<float>(static_cast<int32_t>(raw) >> 8);
+	}
+};
+
+template <> struct SampleReader<SampleFormat::Int32> {
+	static constexpr size_t bytes = 4;
+	static constexpr float scale = 1.0f / 2147483648.0f;
+	static float read(const std::byte* p) { int32_t v; std::memcpy(&v, p, sizeof(v)); return static_cast<float>(v); }
+};
+
+
+// ----------------------------------------------------
+// Kernels
+// ----------------------------------------------------
+
+//	Channels is fixed at compile time for the common layouts (the channel loop unrolls and the
+//	frame loop vectorises), 0 means read it from channels at runtime
+template <SampleFormat F, uint16_t Channels>
+static void downmixFrames(const std::byte* in, const uint16_t channels, float* out, const size_t frames)
+{
+	using Reader = SampleReader<F>;
+	const size_t count = Channels ? Channels : channels;
+	const size_t frameBytes = count * Reader::bytes;
+	const float gain = Reader::scale / static_cast<float>(count);
+
+	for (size_t i = 0; i < frames; i++) {
+		const std::byte* frame = in + i * frameBytes;
+		float sum = 0.0f;
+		for (size_t c = 0; c < count; c++) sum += Reader::read(frame + c * Reader::bytes);
+		out[i] = sum * gain;
+	}
+}
+
+
+//	Stereo float and int16 are what shared mode endpoints hand out almost always, so they
+//	get explicit deinterleaving. The scalar kernels finish the tail.
+static void downmixStereoFloat(const std::byte* in, float* out, const size_t frames)
+{
+	size_t i = 0;
+#if defined(DOWNMIX_SSE2)
+	const auto* f = reinterpret_cast<const float*>(in);
+	const __m128 half = _mm_set1_ps(0.5f);
+	for (; i + 4 <= frames; i += 4) {
+		const __m128 a = _mm_loadu_ps(f + 2 * i);
+		const __m128 b = _mm_loadu_ps(f + 2 * i + 4);
+		const __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+		_mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+	}
+#elif defined(DOWNMIX_NEON)
+	const auto* f = reinterpret_cast<const float*>(in);
+	for (; i + 4 <= frames; i += 4) {
+		const float32x4x2_t lr = vld2q_f32(f + 2 * i);
+		vst1q_f32(out + i, vmulq_n_f32(vaddq_f32(lr.val[0], lr.val[1]), 0.5f));
+	}
+#endif
+	downmixFrames<SampleFormat::Float32, 2>(in + i * 8, 2, out + i, frames - i);
+}
+
+
+static void downmixStereoInt16(const std::byte* in, float* out, const size_t frames)
+{
+	size_t i = 0;
+#if defined(DOWNMIX_SSE2)
+	//	madd against ones sums each left/right pair into 32 bits
+	const __m128i ones = _mm_set1_epi16(1);
+	const __m128 gain = _mm_set1_ps(0.5f / 32768.0f);
+	for (; i + 4 <= frames; i += 4) {
+		const __m128i lr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 4));
+		_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_madd_epi16(lr, ones)), gain));
+	}
+#elif defined(DOWNMIX_NEON)
+	const auto* s = reinterpret_cast<const int16_t*>(in);
+	for (; i + 4 <= frames; i += 4) {
+		const int16x4x2_t lr = vld2_s16(s + 2 * i);
+		vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vaddl_s16(lr.val[0], lr.val[1])), 0.5f / 32768.0f));
+	}
+#endif
+	downmixFrames<SampleFormat::Int16, 2>(in + i * 4, 2, out + i, frames - i);
+}
+
+
+template <SampleFormat F>
+static void downmixFormat(const std::byte* in, const uint16_t channels, float* out, const size_t frames)
+{
+	switch (channels) {
+	case 1: downmixFrames<F, 1>(in, channels, out, frames); break;
+	case 2: downmixFrames<F, 2>(in, channels, out, frames); break;
+	case 4: downmixFrames<F, 4>(in, channels, out, frames); break;
+	case 6: downmixFrames<F, 6>(in, channels, out, frames); break;	//	5.1
+	case 8: downmixFrames<F, 8>(in, channels, out, frames); break;	//	7.1
+	default: downmixFrames<F, 0>(in, channels, out, frames);
+	}
+}
+
+
+void downmixToMono(const std::byte* in, const SampleFormat format, const uint16_t channels, float* out, const size_t frames)
+{
+	if (channels == 0) return;
+
+	switch (format) {
+	case SampleFormat::Float32:
+		if (channels == 2) downmixStereoFloat(in, out, frames);
+		else downmixFormat<SampleFormat::Float32>(in, channels, out, frames);
+		break;
+	case SampleFormat::Int16:
+		if (channels == 2) downmixStereoInt16(in, out, frames);
+		else downmixFormat<SampleFormat::Int16>(in, channels, out, frames);
+		break;
+	case SampleFormat::Int24:
+		downmixFormat<SampleFormat::Int24>(in, channels, out, frames);
+		break;
+	case SampleFormat::Int32:
+		downmixFormat<SampleFormat::Int32>(in, channels, out, frames);
+		break;
+	}
+}
@@ -0,0 +1,496 @@
+//	Headless per stage benchmarks of the analysis pipeline, no window, audio device or GPU needed.
+//
+//	DspBench [--wav <file>] [--reps <n>] [--quick] [--out <dir>]
+//
+//	Every stage (downmix, STFT windowing, FFT, log magnitudes, smoothing, bar binning and vertex
+//	generation) runs on its own over a synthetic chirp or a recorded wav file, across FFT sizes and
+//	bar counts. The constant-Q analysis is timed against the linear FFT at the size that matches its
+//	low frequency resolution. Each stage is warmed up while its batch size is calibrated, then timed over --reps
+//	batches; the spread is over those repetitions. Results go to stdout and to <dir>/dsp.json
+//	(default benchmarks/out), which BenchCompare can gate on.
+
+#include "../include/BarBinner.h"
+#include "../include/BarVertices.h"
+#include "../include/ConstantQ.h"
+#include "../include/Downmix.h"
+#include "../include/Globals.h"
+#include "../include/LatencyHistogram.h"
+#include "../include/ReportCompare.h"
+#include "../include/SpectrumFft.h"
+#include "../include/SpectrumKernels.h"
+#include "../include/SpscRingBuffer.h"
+#include "../include/Stft.h"
+#include "../include/SyntheticAudioSource.h"
+#include "../include/WavFileAudioSource.h"
+#include "../include/WindowTables.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//	Set by CMake at configure time
+#ifndef AUDIOVIS_GIT_COMMIT
+#define AUDIOVIS_GIT_COMMIT "unknown"
+#endif
+
+using benchClock = std::chrono::steady_clock;
+
+//	Keeps results alive so the optimizer can't drop the work being timed
+static volatile float sink = 0.0f;
+
+struct Options {
+	std::string wav;
+	int repetitions = 30;
+	std::chrono::microseconds minBatchTime{ 5000 };	//	Shortest batch, well above the clock resolution
+	std::filesystem::path outputDirectory = "benchmarks/out";
+};
+
+//	Audio every stage reads: a few packets as the source delivered them, and the mono signal
+struct Input {
+	std::string name;
+	AudioFormat format;
+	std::vector<std::byte> packet;		//	PACKET_FRAMES interleaved frames in format
+	std::vector<float> mono;
+};
+
+constexpr uint32_t PACKET_FRAMES = 480;
+constexpr size_t SIGNAL_SAMPLES = size_t(1) << 16;
+constexpr unsigned int COMPARE_BARS = 256;		//	Bars the constant-Q comparison bins onto
+
+struct StageResult {
+	std::string name;
+	LatencyHistogram nsPerCall;
+	double samplesPerCall;			//	Input samples one call consumes, for the throughput column
+};
+
+
+// ----------------------------------------------------
+// Measurement
+// ----------------------------------------------------
+
+//	Doubles the batch until it takes minBatchTime (which doubles as the warm up), then records the
+//	ns per call of every repetition
+template <typename Fn>
+static LatencyHistogram measure(const Options& options, Fn&& fn)
+{
+	auto timeBatch = [&fn](const size_t calls) {
+		const auto start = benchClock::now();
+		for (size_t i = 0; i < calls; i++) fn();
+		return std::chrono::duration<double, std::nano>(benchClock::now() - start);
+	};
+
+	size_t batch = 1;
+	while (timeBatch(batch) < options.minBatchTime && batch < (size_t(1) << 26)) batch *= 2;
+
+	LatencyHistogram histogram;
+	for (int r = 0; r < options.repetitions; r++)
+		histogram.record(static_cast<uint64_t>(std::llround(timeBatch(batch).count() / static_cast<double>(batch))));
+	return histogram;
+}
+
+
+static void printResult(const StageResult& result)
+{
+	const LatencyHistogram& h = result.nsPerCall;
+	const double median = static_cast<double>(h.percentile(50.0));
+	char line[160];
+	std::snprintf(line, sizeof(line), "  %-24s %10.0f %10.1f %10llu %12.2f\n",
+		result.name.c_str(), median, h.stddev(), static_cast<unsigned long long>(h.percentile(90.0)),
+		median > 0.0 ? result.samplesPerCall / median * 1e3 : 0.0);
+	std::cout << line;
+}
+
+
+// ----------------------------------------------------
+// Input
+// ----------------------------------------------------
+
+static Input loadInput(const Options& options)
+{
+	std::unique_ptr<AudioSource> source;
+	Input input;
+	if (options.wav.empty()) {
+		input.name = "synthetic chirp";
+		source = std::make_unique<SyntheticAudioSource>(SyntheticSignal{ Waveform::Chirp, 50.0f, 20000.0f, 0.5f, 1.0f, 1 }, AudioFormat{}, PACKET_FRAMES);
+	}
+	else {
+		input.name = options.wav;
+		source = std::make_unique<WavFileAudioSource>(options.wav, PACKET_FRAMES, true);
+		if (!source->isValid()) throw std::runtime_error("No audio in " + options.wav);
+	}
+	input.format = source->format();
+
+	input.mono.resize(SIGNAL_SAMPLES);
+	for (size_t filled = 0; filled < SIGNAL_SAMPLES;) {
+		AudioPacket packet;
+		if (!source->acquirePacket(packet)) throw std::runtime_error("Source ran dry");
+
+		const size_t bytes = static_cast<size_t>(packet.frames) * input.format.bytesPerFrame();
+		if (input.packet.empty() && packet.frames == PACKET_FRAMES)
+			input.packet.assign(packet.data, packet.data + bytes);
+
+		const size_t n = std::min<size_t>(packet.frames, SIGNAL_SAMPLES - filled);
+		downmixToMono(packet.data, input.format.sampleFormat, input.format.channels, input.mono.data() + filled, n);
+		source->releasePacket();
+		filled += n;
+	}
+	if (input.packet.empty()) throw std::runtime_error("Source delivers no full packets");
+	return input;
+}
+
+
+//	The mono signal repeated over channels in format, so every sample format can be timed from any input
+static std::vector<std::byte> packPacket(const std::vector<float>& mono, const AudioFormat& format)
+{
+	std::vector<std::byte> packet(PACKET_FRAMES * format.bytesPerFrame());
+	std::byte* out = packet.data();
+	for (uint32_t f = 0; f < PACKET_FRAMES; f++) {
+		for (uint16_t c = 0; c < format.channels; c++) {
+			if (format.sampleFormat == SampleFormat::Int16) {
+				const auto s = static_cast<int16_t>(std::clamp(mono[f], -1.0f, 1.0f) * 32767.0f);
+				std::memcpy(out, &s, sizeof(s));
+			}
+			else std::memcpy(out, &mono[f], sizeof(float));
+			out += format.bytesPerSample();
+		}
+	}
+	return packet;
+}
+
+
+// ----------------------------------------------------
+// Stages
+// ----------------------------------------------------
+
+static void benchDownmix(const Options& options, const Input& input, std::vector<StageResult>& results)
+{
+	auto bench = [&](const std::string& name, const std::vector<std::byte>& packet, const AudioFormat& format) {
+		std::vector<float> mono(PACKET_FRAMES);
+		results.push_back({ name, measure(options, [&] {
+			downmixToMono(packet.data(), format.sampleFormat, format.channels, mono.data(), PACKET_FRAMES);
+			sink = mono[1];
+		}), static_cast<double>(PACKET_FRAMES) });
+		printResult(results.back());
+	};
+
+	const AudioFormat f32{ 48000, 2, SampleFormat::Float32 }, i16{ 48000, 2, SampleFormat::Int16 };
+	if (!options.wav.empty())
+		bench("downmix-source", input.packet, input.format);
+	bench("downmix-f32x2", packPacket(input.mono, f32), f32);
+	bench("downmix-i16x2", packPacket(input.mono, i16), i16);
+}
+
+
+//	Window, FFT and magnitudes at one FFT size, with the hop at 50% overlap
+template <size_t N>
+static void benchSpectrum(const Options& options, const Input& input, std::vector<StageResult>& results)
+{
+	using Engine = std::conditional_t<N % 2 == 0 && fftSupportsSize(N / 2), RealFft<N>, KissRealFft<N>>;
+	constexpr size_t hop = N / 2, bins = N / 2;
+	const std::string size = std::to_string(N);
+	auto add = [&](const std::string& stage, LatencyHistogram histogram) {
+		results.push_back({ stage + "-" + size, std::move(histogram), static_cast<double>(hop) });
+		printResult(results.back());
+	};
+
+	//	Windowing: the hop goes into the ring and the next window comes out multiplied
+	std::vector<float> frame(N);
+	{
+		SpscRingBuffer<float> ring(4 * N);
+		Stft stft(N, hop);
+		const float* window = WINDOW_TABLE<WindowType::Hann, N>.data();
+		ring.push(input.mono.data(), N - hop);
+		size_t position = N - hop;
+		add("window", measure(options, [&] {
+			if (position + hop > input.mono.size()) position = 0;
+			ring.push(input.mono.data() + position, hop);
+			position += hop;
+			stft.nextFrame(ring, frame.data(), window);
+			sink = frame[1];
+		}));
+	}
+
+	auto fft = std::make_unique<Engine>();
+	std::vector<float> re(N / 2 + 1), im(N / 2 + 1);
+	add("fft", measure(options, [&] {
+		fft->forward(frame.data(), re.data(), im.data());
+		sink = re[1];
+	}));
+
+	fft->forward(input.mono.data(), re.data(), im.data());
+	std::vector<float> magnitudes(bins);
+	add("magnitude", measure(options, [&] {
+		logMagnitudes(re.data(), im.data(), magnitudes.data(), bins, 108.0f);
+		sink = magnitudes[1];
+	}));
+}
+
+
+//	Binning, smoothing and vertex generation at each bar count, from FFT_COUNT spectra like the app
+static void benchBars(const Options& options, const Input& input, std::vector<StageResult>& results)
+{
+	constexpr size_t bins = FFT_COUNT / 2;
+	SpectrumFft fft;
+	std::vector<float> re(FFT_COUNT / 2 + 1), im(FFT_COUNT / 2 + 1);
+
+	//	Two spectra a hop apart, so smoothing sees bars both rising and falling
+	std::vector<std::vector<float>> spectra(2, std::vector<float>(bins));
+	for (size_t s = 0; s < 2; s++) {
+		fft.forward(input.mono.data() + s * FFT_HOP, re.data(), im.data());
+		logMagnitudes(re.data(), im.data(), spectra[s].data(), bins, 108.0f);
+	}
+	const std::vector<float>& spectrum = spectra[0];
+
+	for (const unsigned int barCount : { 16u, 64u, 256u, 1024u, MAX_BAR_COUNT }) {
+		const std::string size = std::to_string(barCount);
+		auto add = [&](const std::string& stage, LatencyHistogram histogram) {
+			results.push_back({ stage + "-" + size, std::move(histogram), static_cast<double>(FFT_COUNT / 2) });
+			printResult(results.back());
+		};
+
+		BarLayout layout;
+		layout.binCount = bins;
+		layout.fftSize = FFT_COUNT;
+		layout.sampleRate = input.format.sampleRate;
+		layout.barCount = barCount;
+		BarBinner binner;
+		binner.configure(layout);
+
+		std::vector<float> bars(barCount), vertices(barCount * 2);
+		std::vector<uint16_t> heights(barCount);
+		add("binning", measure(options, [&] {
+			binner.apply(spectrum.data(), bars.data());
+			sink = bars[0];
+		}));
+
+		std::vector<std::vector<float>> targets(2, std::vector<float>(barCount));
+		for (size_t s = 0; s < 2; s++) binner.apply(spectra[s].data(), targets[s].data());
+		std::vector<float> previous(barCount, 0.0f), smoothed(barCount);
+		size_t which = 0;
+		add("smoothing", measure(options, [&] {
+			const std::vector<float>& target = targets[which];
+			for (size_t i = 0; i < barCount; i++) {
+				smoothed[i] = smoothedHeight(0.9f, previous[i], target[i]);
+				previous[i] = target[i];
+			}
+			which ^= 1;
+			sink = smoothed[1];
+		}));
+
+		//	Scales of a 1920 x 1080 window, as minVertScales() gives them
+		const float horizScale = 2.0f / static_cast<float>(barCount), vertScale = 1.0f / 1080.0f;
+		add("vertices", measure(options, [&] {
+			genBarVertices(bars.data(), barCount, horizScale, vertScale, vertices.data());
+			sink = vertices[1];
+		}));
+		add("heights16", measure(options, [&] {
+			genBarHeights16(bars.data(), barCount, vertScale, heights.data());
+			sink = static_cast<float>(heights[0]);
+		}));
+	}
+}
+
+
+//	The linear FFT at the first power of two whose bins are no wider than the narrowest constant-Q bin
+//	(sampleRate / length), with its log magnitudes, and the binning of all those bins onto the bars
+template <size_t N>
+static void benchMatchedFft(const Options& options, const Input& input, const std::string& name, const size_t length, std::vector<StageResult>& results)
+{
+	if constexpr (N < SIGNAL_SAMPLES) {
+		if (N < length) {
+			benchMatchedFft<N * 2>(options, input, name, length, results);
+			return;
+		}
+	}
+
+	using Engine = std::conditional_t<N <= 8192 && fftSupportsSize(N / 2), RealFft<N>, KissRealFft<N>>;
+	constexpr size_t bins = N / 2;
+	auto add = [&](const std::string& stage, LatencyHistogram histogram) {
+		results.push_back({ name + "-" + stage, std::move(histogram), static_cast<double>(FFT_HOP) });
+		printResult(results.back());
+	};
+
+	auto fft = std::make_unique<Engine>();
+	std::vector<float> re(bins + 1), im(bins + 1), magnitudes(bins);
+	add("linear-" + std::to_string(N), measure(options, [&] {
+		fft->forward(input.mono.data(), re.data(), im.data());
+		logMagnitudes(re.data(), im.data(), magnitudes.data(), bins, 108.0f);
+		sink = magnitudes[1];
+	}));
+
+	BarLayout layout;
+	layout.binCount = bins;
+	layout.fftSize = N;
+	layout.sampleRate = input.format.sampleRate;
+	layout.barCount = COMPARE_BARS;
+	BarBinner binner;
+	binner.configure(layout);
+	std::vector<float> bars(COMPARE_BARS);
+	add("linear-binning", measure(options, [&] {
+		binner.apply(magnitudes.data(), bars.data());
+		sink = bars[0];
+	}));
+}
+
+
+//	Constant-Q over one N point FFT: the kernels alone, the whole analysis per hop and the binning,
+//	then the linear FFT that resolves the lowest bin as finely
+template <size_t N>
+static void benchConstantQ(const Options& options, const Input& input, const std::string& name, const float gamma, std::vector<StageResult>& results)
+{
+	using Engine = std::conditional_t<N <= 8192 && fftSupportsSize(N / 2), RealFft<N>, KissRealFft<N>>;
+	ConstantQLayout layout;
+	layout.sampleRate = input.format.sampleRate;
+	layout.fftSize = N;
+	layout.minFrequency = CQT_MIN_FREQUENCY;
+	layout.binsPerOctave = CQT_BINS_PER_OCTAVE;
+	layout.gamma = gamma;
+	layout.gain = static_cast<float>(FFT_COUNT);
+	ConstantQ cqt;
+	cqt.configure(layout);
+	const size_t bins = cqt.binCount();
+
+	char summary[160];
+	std::snprintf(summary, sizeof(summary), "  %s: FFT %zu, %zu bins, %zu kernel weights, longest kernel %zu samples (%.2f Hz)\n",
+		name.c_str(), N, bins, cqt.weightCount(), cqt.longestKernel(), input.format.sampleRate / static_cast<double>(cqt.longestKernel()));
+	std::cout << summary;
+
+	auto add = [&](const std::string& stage, LatencyHistogram histogram) {
+		results.push_back({ name + "-" + stage, std::move(histogram), static_cast<double>(FFT_HOP) });
+		printResult(results.back());
+	};
+
+	auto fft = std::make_unique<Engine>();
+	std::vector<float> re(N / 2 + 1), im(N / 2 + 1), binRe(bins), binIm(bins), magnitudes(bins);
+	fft->forward(input.mono.data(), re.data(), im.data());
+	add("kernels", measure(options, [&] {
+		cqt.apply(re.data(), im.data(), binRe.data(), binIm.data());
+		logMagnitudes(binRe.data(), binIm.data(), magnitudes.data(), bins, 108.0f);
+		sink = magnitudes[1];
+	}));
+	add("total", measure(options, [&] {
+		fft->forward(input.mono.data(), re.data(), im.data());
+		cqt.apply(re.data(), im.data(), binRe.data(), binIm.data());
+		logMagnitudes(binRe.data(), binIm.data(), magnitudes.data(), bins, 108.0f);
+		sink = magnitudes[1];
+	}));
+
+	BarLayout barLayout;
+	barLayout.binCount = bins;
+	barLayout.fftSize = N;
+	barLayout.sampleRate = input.format.sampleRate;
+	barLayout.barCount = COMPARE_BARS;
+	barLayout.binsPerOctave = CQT_BINS_PER_OCTAVE;
+	barLayout.firstBinFrequency = CQT_MIN_FREQUENCY;
+	BarBinner binner;
+	binner.configure(barLayout);
+	std::vector<float> bars(COMPARE_BARS);
+	add("binning", measure(options, [&] {
+		binner.apply(magnitudes.data(), bars.data());
+		sink = bars[0];
+	}));
+
+	benchMatchedFft<512>(options, input, name, cqt.longestKernel(), results);
+}
+
+
+// ----------------------------------------------------
+// Main
+// ----------------------------------------------------
+
+static bool parseArguments(const int argc, char** argv, Options& options)
+{
+	for (int i = 1; i < argc; i++) {
+		const bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--wav") == 0 && hasValue) options.wav = argv[++i];
+		else if (std::strcmp(argv[i], "--reps") == 0 && hasValue) options.repetitions = std::max(std::atoi(argv[++i]), 1);
+		else if (std::strcmp(argv[i], "--out") == 0 && hasValue) options.outputDirectory = argv[++i];
+		else if (std::strcmp(argv[i], "--quick") == 0) {
+			//	Smoke test sized, the numbers are only indicative
+			options.repetitions = 5;
+			options.minBatchTime = std::chrono::microseconds(500);
+		}
+		else return false;
+	}
+	return true;
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!parseArguments(argc, argv, options)) {
+		std::cerr << "Usage: DspBench [--wav <file>] [--reps <n>] [--quick] [--out <dir>]\n";
+		return 2;
+	}
+
+	Input input;
+	try {
+		input = loadInput(options);
+	}
+	catch (const std::exception& e) {
+		std::cerr << "DspBench: " << e.what() << "\n";
+		return 2;
+	}
+
+	std::cout << "DSP stages over " << input.name << " (" << input.format.sampleRate << " Hz, " << input.format.channels
+			  << " ch), " << options.repetitions << " repetitions, kernels " << spectrumKernelIsa() << "\n";
+	char header[160];
+	std::snprintf(header, sizeof(header), "  %-24s %10s %10s %10s %12s\n", "stage", "median ns", "stddev", "p90 ns", "Msamples/s");
+	std::cout << header;
+
+	std::vector<StageResult> results;
+	benchDownmix(options, input, results);
+	benchSpectrum<256>(options, input, results);
+	benchSpectrum<FFT_COUNT>(options, input, results);
+	benchSpectrum<512>(options, input, results);
+	benchSpectrum<1024>(options, input, results);
+	benchSpectrum<2048>(options, input, results);
+	benchSpectrum<4096>(options, input, results);
+	benchSpectrum<8192>(options, input, results);
+	benchBars(options, input, results);
+
+	//	The app's variable-Q layout, and constant-Q all the way down, which needs a 2^16 point FFT
+	benchConstantQ<CQT_FFT_SIZE>(options, input, "cqt", CQT_GAMMA, results);
+	benchConstantQ<SIGNAL_SAMPLES>(options, input, "cqt-pure", 0.0f, results);
+
+	//	Same layout as the PerformanceManager reports, so BenchCompare reads both
+	JsonValue metadata;
+	metadata.set("commit", AUDIOVIS_GIT_COMMIT);
+	metadata.set("input", input.name);
+	metadata.set("sampleRate", input.format.sampleRate);
+	metadata.set("kernels", spectrumKernelIsa());
+	metadata.set("repetitions", options.repetitions);
+
+	JsonValue timers;
+	for (const StageResult& result : results)
+		timers.set(result.name, histogramReport(result.nsPerCall));
+
+	JsonValue report;
+	report.set("format", "audiovis-perf-1");
+	report.set("label", "dsp");
+	report.set("metadata", std::move(metadata));
+	report.set("timers", std::move(timers));
+
+	std::error_code error;
+	std::filesystem::create_directories(options.outputDirectory, error);
+	const std::filesystem::path file = options.outputDirectory / "dsp.json";
+	std::ofstream out(file, std::ios::trunc);
+	if (error || !out) {
+		std::cerr << "Unable to write " << file.string() << "\n";
+		return 2;
+	}
+	out << report << "\n";
+	std::cout << "Report: " << file.string() << "\n";
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,94 @@
+#include "../include/GpuSmoother.h"
+
+#include <algorithm>
+#include <vector>
+
+bool GpuSmoother::init(const GLuint vertexShader, const size_t maxBars, const UploadStrategy upload)
+{
+	program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	const char* varyings[] = { "barVertex", "nextPrevious" };
+	glTransformFeedbackVaryings(program, 2, varyings, GL_SEPARATE_ATTRIBS);
+	glLinkProgram(program);
+
+	int success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		glDeleteProgram(program);
+		program = 0;
+		return false;
+	}
+
+	coefLocation = glGetUniformLocation(program, "SmoothingCoef");
+	horizScaleLocation = glGetUniformLocation(program, "HorizScale");
+	vertScaleLocation = glGetUniformLocation(program, "VertScale");
+	capacity = maxBars;
+
+	glGenVertexArrays(1, &feedbackArray);
+	glGenVertexArrays(1, &drawArray);
+	glGenBuffers(2, state.data());
+	glGenBuffers(1, &vertices);
+
+	GLuint targets;
+	glGenBuffers(1, &targets);
+	glBindVertexArray(feedbackArray);
+	targetRing.init(targets, sizeof(float) * capacity, upload);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vertices);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(float) * 2 * capacity), nullptr, GL_DYNAMIC_COPY);
+	glBindVertexArray(drawArray);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), static_cast<void*>(nullptr));
+	glBindVertexArray(0);
+
+	reset();
+	return true;
+}
+
+
+void GpuSmoother::reset()
+{
+	const std::vector<float> zeros(capacity, 0.0f);
+	for (const GLuint buffer : state) {
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(float) * capacity), zeros.data(), GL_DYNAMIC_COPY);
+	}
+	readState = 0;
+}
+
+
+void GpuSmoother::run(const float* targets, const size_t count, const float coef, const float horizScale, const float vertScale)
+{
+	auto* upload = static_cast<float*>(targetRing.map());
+	std::copy(targets, targets + count, upload);
+	const GLint first = targetRing.unmap(sizeof(float) * count, sizeof(float));
+
+	//	Both inputs start at bar 0 so gl_VertexID is the bar index. The target offset moves with the
+	//	ring segment and the state with the swap, so the two pointers are set every frame.
+	glBindVertexArray(feedbackArray);
+	glBindBuffer(GL_ARRAY_BUFFER, targetRing.name());
+	glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, sizeof(float), reinterpret_cast<void*>(static_cast<size_t>(first) * sizeof(float)));
+	glBindBuffer(GL_ARRAY_BUFFER, state[readState]);
+	glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), static_cast<void*>(nullptr));
+
+	glUseProgram(program);
+	glUniform1f(coefLocation, coef);
+	glUniform1f(horizScaleLocation, horizScale);
+	glUniform1f(vertScaleLocation, vertScale);
+
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, vertices);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, state[1 - readState]);
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(count));
+	glEndTransformFeedback();
+	glDisable(GL_RASTERIZER_DISCARD);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, 0);
+
+	targetRing.fence();
+	glBindVertexArray(0);
+	readState = 1 - readState;
+}
@@ -0,0 +1,297 @@
+#include "../include/Json.h"
+
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+// ----------------------------------------------------
+// Parsing
+// ----------------------------------------------------
+
+namespace {
+	class Parser {
+	public:
+		explicit Parser(const std::string_view text) : text(text) {}
+
+		JsonValue document()
+		{
+			JsonValue v = parseValue();
+			skipSpace();
+			if (pos != text.size()) fail("trailing characters");
+			return v;
+		}
+
+	private:
+		std::string_view text;
+		size_t pos = 0;
+
+		[[noreturn]] void fail(const char* what) const
+		{
+			throw std::runtime_error(std::string("JSON parse error at offset ") + std::to_string(pos) + ": " + what);
+		}
+
+		void skipSpace()
+		{
+			while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) pos++;
+		}
+
+		bool consume(const char c)
+		{
+			skipSpace();
+			if (pos < text.size() && text[pos] == c) {
+				pos++;
+				return true;
+			}
+			return false;
+		}
+
+		void expect(const char c)
+		{
+			if (!consume(c)) fail("unexpected character");
+		}
+
+		bool literal(const std::string_view word)
+		{
+			if (text.substr(pos, word.size()) != word) return false;
+			pos += word.size();
+			return true;
+		}
+
+		JsonValue parseValue()
+		{
+			skipSpace();
+			if (pos >= text.size()) fail("unexpected end");
+
+			switch (text[pos]) {
+			case '{': return parseObject();
+			case '[': return parseArray();
+			case '"': return parseString();
+			default: break;
+			}
+
+			if (literal("true")) return true;
+			if (literal("false")) return false;
+			if (literal("null")) return nullptr;
+			return parseNumber();
+		}
+
+		JsonValue parseObject()
+		{
+			expect('{');
+			JsonValue::Object object;
+			if (consume('}')) return object;
+			do {
+				skipSpace();
+				std::string key = parseString().string();
+				expect(':');
+				object.emplace_back(std::move(key), parseValue());
+			} while (consume(','));
+			expect('}');
+			return object;
+		}
+
+		JsonValue parseArray()
+		{
+			expect('[');
+			JsonValue::Array array;
+			if (consume(']')) return array;
+			do {
+				array.push_back(parseValue());
+			} while (consume(','));
+			expect(']');
+			return array;
+		}
+
+		JsonValue parseString()
+		{
+			if (pos >= text.size() || text[pos] != '"') fail("expected a string");
+			pos++;
+
+			std::string s;
+			while (pos < text.size() && text[pos] != '"') {
+				char c = text[pos++];
+				if (c != '\\') {
+					s += c;
+					continue;
+				}
+				if (pos >= text.size()) fail("unterminated escape");
+				switch (c = text[pos++]) {
+				case 'n': s += '\n'; break;
+				case 't': s += '\t'; break;
+				case 'r': s += '\r'; break;
+				case 'b': s += '\b'; break;
+				case 'f': s += '\f'; break;
+				case 'u': {
+					//	Reports only ever escape control characters, anything else becomes '?'
+					if (pos + 4 > text.size()) fail("short unicode escape");
+					unsigned code = 0;
+					std::from_chars(text.data() + pos, text.data() + pos + 4, code, 16);
+					s += code < 0x80 ? static_cast<char>(code) : '?';
+					pos += 4;
+					break;
+				}
+				default: s += c;
+				}
+			}
+			if (pos >= text.size()) fail("unterminated string");
+			pos++;
+			return s;
+		}
+
+		JsonValue parseNumber()
+		{
+			const size_t start = pos;
+			while (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) || std::string_view("+-.eE").find(text[pos]) != std::string_view::npos))
+				pos++;
+			if (start == pos) fail("unexpected character");
+
+			//	strtod rather than from_chars, floating point from_chars is missing from older libstdc++
+			const std::string number(text.substr(start, pos - start));
+			char* end = nullptr;
+			const double v = std::strtod(number.c_str(), &end);
+			if (end != number.c_str() + number.size()) fail("malformed number");
+			return v;
+		}
+	};
+
+
+	void writeString(std::ostream& out, const std::string& s)
+	{
+		out << '"';
+		for (const char c : s) {
+			switch (c) {
+			case '"': out << "\\\""; break;
+			case '\\': out << "\\\\"; break;
+			case '\n': out << "\\n"; break;
+			case '\t': out << "\\t"; break;
+			case '\r': out << "\\r"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char escaped[8];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+					out << escaped;
+				}
+				else out << c;
+			}
+		}
+		out << '"';
+	}
+
+
+	void writeNumber(std::ostream& out, const double n)
+	{
+		//	Whole numbers (counts, nanoseconds) without a fraction, the rest round trip exactly
+		if (!std::isfinite(n)) {
+			out << "null";
+			return;
+		}
+		char buffer[32];
+		if (n == std::floor(n) && std::fabs(n) < 9007199254740992.0)
+			std::snprintf(buffer, sizeof(buffer), "%.0f", n);
+		else
+			std::snprintf(buffer, sizeof(buffer), "%.17g", n);
+		out << buffer;
+	}
+}
+
+
+JsonValue JsonValue::parse(const std::string_view text)
+{
+	return Parser(text).document();
+}
+
+
+// ----------------------------------------------------
+// Access
+// ----------------------------------------------------
+
+double JsonValue::number() const
+{
+	if (!isNumber()) throw std::runtime_error("JSON value is not a number");
+	return std::get<double>(value);
+}
+
+
+const std::string& JsonValue::string() const
+{
+	if (!isString()) throw std::runtime_error("JSON value is not a string");
+	return std::get<std::string>(value);
+}
+
+
+const JsonValue::Array& JsonValue::array() const
+{
+	if (!isArray()) throw std::runtime_error("JSON value is not an array");
+	return std::get<Array>(value);
+}
+
+
+const JsonValue::Object& JsonValue::object() const
+{
+	if (!isObject()) throw std::runtime_error("JSON value is not an object");
+	return std::get<Object>(value);
+}
+
+
+const JsonValue* JsonValue::find(const std::string_view key) const
+{
+	if (!isObject()) return nullptr;
+	for (const auto& [name, member] : std::get<Object>(value))
+		if (name == key) return &member;
+	return nullptr;
+}
+
+
+JsonValue& JsonValue::set(std::string key, JsonValue member)
+{
+	if (isNull()) value = Object();
+	if (!isObject()) throw std::runtime_error("JSON value is not an object");
+	auto& object = std::get<Object>(value);
+	object.emplace_back(std::move(key), std::move(member));
+	return object.back().second;
+}
+
+
+// ----------------------------------------------------
+// Writing
+// ----------------------------------------------------
+
+void JsonValue::write(std::ostream& out, const int indent) const
+{
+	const std::string pad(static_cast<size_t>(indent + 2), ' ');
+	const std::string closePad(static_cast<size_t>(indent), ' ');
+
+	if (isNull()) out << "null";
+	else if (const auto* b = std::get_if<bool>(&value)) out << (*b ? "true" : "false");
+	else if (const auto* n = std::get_if<double>(&value)) writeNumber(out, *n);
+	else if (const auto* s = std::get_if<std::string>(&value)) writeString(out, *s);
+	else if (const auto* a = std::get_if<Array>(&value)) {
+		bool flat = a->size() <= 4;
+		for (const JsonValue& element : *a) flat &= element.isNumber();
+
+		out << '[';
+		for (size_t i = 0; i < a->size(); i++) {
+			if (i) out << ',';
+			if (flat) out << (i ? " " : "");
+			else out << '\n' << pad;
+			(*a)[i].write(out, indent + 2);
+		}
+		if (!flat && !a->empty()) out << '\n' << closePad;
+		out << ']';
+	}
+	else {
+		const auto& o = std::get<Object>(value);
+		out << '{';
+		for (size_t i = 0; i < o.size(); i++) {
+			out << (i ? ",\n" : "\n") << pad;
+			writeString(out, o[i].first);
+			out << ": ";
+			o[i].second.write(out, indent + 2);
+		}
+		if (!o.empty()) out << '\n' << closePad;
+		out << '}';
+	}
+}
@@ -0,0 +1,232 @@
+#include "../include/MicroBenchmarks.h"
+#include "../include/Fft.h"
+#include "../include/SpectrumKernels.h"
+#include "../include/SpscRingBuffer.h"
+
+extern "C" {
+#include "kiss_fft.h"
+#include "kiss_fftr.h"
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using benchClock = std::chrono::steady_clock;
+
+//	Keeps results alive so the optimizer can't drop the work being timed
+static volatile float sink = 0.0f;
+
+// ----------------------------------------------------
+// Sample ring
+// ----------------------------------------------------
+
+//	Streams samples from a producer thread to a consumer thread in packet sized chunks,
+//	the same shape as capture -> analysis
+void runSampleRingBenchmark(std::ostream& out)
+{
+	constexpr size_t totalSamples = size_t(1) << 26;
+	constexpr size_t chunkSizes[] = { 64, 480, 4096 };
+
+	out << "Sample ring (SPSC, producer thread -> consumer thread)\n";
+
+	for (const size_t chunk : chunkSizes) {
+		SpscRingBuffer<float> ring(1 << 15);
+		std::vector<float> in(chunk, 1.0f), drain(chunk);
+
+		const auto start = benchClock::now();
+
+		std::thread producer([&] {
+			size_t sent = 0;
+			while (sent < totalSamples) {
+				//	Back off instead of dropping so every sample is timed end to end
+				const size_t n = ring.push(in.data(), std::min(chunk, std::min(totalSamples - sent, ring.writeAvailable())));
+				if (n == 0) std::this_thread::yield();
+				sent += n;
+			}
+		});
+
+		size_t received = 0;
+		while (received < totalSamples) {
+			const size_t n = ring.pop(drain.data(), chunk);
+			if (n == 0) std::this_thread::yield();
+			received += n;
+			sink = drain[0];
+		}
+		producer.join();
+
+		const std::chrono::duration<double> elapsed = benchClock::now() - start;
+		out << "  chunk " << chunk << ":\t" << static_cast<double>(totalSamples) / elapsed.count() / 1e6
+			<< " Msamples/s\t(overflows " << ring.overflowCount() << ")\n";
+	}
+}
+
+
+// ----------------------------------------------------
+// FFT
+// ----------------------------------------------------
+
+//	Complex kiss_fft fed real samples (the old AudioManager path) against kiss_fftr, per size
+void runFftBenchmark(std::ostream& out)
+{
+	constexpr int sizes[] = { 256, 480, 512, 1024, 2048, 4096, 8192 };
+	constexpr size_t samplesPerSize = size_t(1) << 23;
+
+	out << "FFT (complex kiss_fft vs real kiss_fftr), ns per transform\n";
+
+	for (const int n : sizes) {
+		std::vector<float> input(n);
+		for (int i = 0; i < n; i++) input[i] = std::sin(0.05f * static_cast<float>(i));
+
+		const size_t iterations = std::max<size_t>(samplesPerSize / n, 16);
+
+		//	Complex path, includes packing the real samples into complex input like AudioManager did
+		kiss_fft_cfg complexCfg = kiss_fft_alloc(n, 0, nullptr, nullptr);
+		std::vector<kiss_fft_cpx> complexIn(n), complexOut(n);
+
+		auto start = benchClock::now();
+		for (size_t it = 0; it < iterations; it++) {
+			for (int i = 0; i < n; i++) {
+				complexIn[i].r = input[i];
+				complexIn[i].i = 0.0f;
+			}
+			kiss_fft(complexCfg, complexIn.data(), complexOut.data());
+			sink = complexOut[1].r;
+		}
+		const std::chrono::duration<double, std::nano> complexTime = benchClock::now() - start;
+		free(complexCfg);
+
+		//	Real path, N / 2 + 1 bins straight from the float samples
+		kiss_fftr_cfg realCfg = kiss_fftr_alloc(n, 0, nullptr, nullptr);
+		std::vector<kiss_fft_cpx> realOut(n / 2 + 1);
+
+		start = benchClock::now();
+		for (size_t it = 0; it < iterations; it++) {
+			kiss_fftr(realCfg, input.data(), realOut.data());
+			sink = realOut[1].r;
+		}
+		const std::chrono::duration<double, std::nano> realTime = benchClock::now() - start;
+		free(realCfg);
+
+		const double complexNs = complexTime.count() / static_cast<double>(iterations);
+		const double realNs = realTime.count() / static_cast<double>(iterations);
+		out << "  N = " << n << ":\tkiss_fft " << complexNs << "\tkiss_fftr " << realNs
+			<< "\t(" << complexNs / realNs << "x)\n";
+	}
+}
+
+
+// ----------------------------------------------------
+// Compile-time FFT engine
+// ----------------------------------------------------
+
+template <typename Fn>
+static double nsPerCall(const size_t iterations, Fn&& fn)
+{
+	const auto start = benchClock::now();
+	for (size_t it = 0; it < iterations; it++) fn();
+	const std::chrono::duration<double, std::nano> elapsed = benchClock::now() - start;
+	return elapsed.count() / static_cast<double>(iterations);
+}
+
+
+template <size_t N>
+static void benchFftEngine(std::ostream& out)
+{
+	const size_t iterations = std::max<size_t>((size_t(1) << 23) / N, 16);
+
+	std::vector<float> re(N), im(N, 0.0f), outRe(N), outIm(N);
+	for (size_t i = 0; i < N; i++) re[i] = std::sin(0.05f * static_cast<float>(i));
+
+	//	Complex: kiss_fft on AoS buffers against Fft<N> on split arrays
+	kiss_fft_cfg complexCfg = kiss_fft_alloc(static_cast<int>(N), 0, nullptr, nullptr);
+	std::vector<kiss_fft_cpx> complexIn(N), complexOut(N);
+	for (size_t i = 0; i < N; i++) complexIn[i] = { re[i], 0.0f };
+	const double kissComplex = nsPerCall(iterations, [&] {
+		kiss_fft(complexCfg, complexIn.data(), complexOut.data());
+		sink = complexOut[1].r;
+	});
+	free(complexCfg);
+
+	auto fft = std::make_unique<Fft<N>>();
+	const double engineComplex = nsPerCall(iterations, [&] {
+		fft->forward(re.data(), im.data(), outRe.data(), outIm.data());
+		sink = outRe[1];
+	});
+
+	//	Real: kiss_fftr against RealFft<N>
+	kiss_fftr_cfg realCfg = kiss_fftr_alloc(static_cast<int>(N), 0, nullptr, nullptr);
+	const double kissReal = nsPerCall(iterations, [&] {
+		kiss_fftr(realCfg, re.data(), complexOut.data());
+		sink = complexOut[1].r;
+	});
+	free(realCfg);
+
+	auto realFft = std::make_unique<RealFft<N>>();
+	const double engineReal = nsPerCall(iterations, [&] {
+		realFft->forward(re.data(), outRe.data(), outIm.data());
+		sink = outRe[1];
+	});
+
+	out << "  N = " << N << ":\tcomplex kiss " << kissComplex << "\tFft<N> " << engineComplex
+		<< "\t| real kiss " << kissReal << "\tRealFft<N> " << engineReal << "\n";
+}
+
+
+void runFftEngineBenchmark(std::ostream& out)
+{
+	out << "FFT engine (kissfft vs compile-time Fft<N>), ns per transform\n";
+
+	benchFftEngine<480>(out);
+	benchFftEngine<512>(out);
+	benchFftEngine<1024>(out);
+	benchFftEngine<2048>(out);
+	benchFftEngine<4096>(out);
+	benchFftEngine<8192>(out);
+}
+
+
+// ----------------------------------------------------
+// Spectrum kernels
+// ----------------------------------------------------
+
+//	The old per-bin sqrtf / double log2 / multiply loop against logMagnitudes
+void runMagnitudeKernelBenchmark(std::ostream& out)
+{
+	constexpr size_t binCounts[] = { 240, 4096 };
+	constexpr size_t binsPerCount = size_t(1) << 26;
+	constexpr float scale = 108.0f;
+
+	out << "Log magnitude kernel (" << spectrumKernelIsa() << "), ns per bin\n";
+
+	for (const size_t bins : binCounts) {
+		std::vector<float> re(bins), im(bins), result(bins);
+		for (size_t i = 0; i < bins; i++) {
+			re[i] = 1.0f + static_cast<float>(i);
+			im[i] = 0.5f * static_cast<float>(i);
+		}
+
+		const size_t iterations = binsPerCount / bins;
+
+		const double scalarNs = nsPerCall(iterations, [&] {
+			for (size_t i = 0; i < bins; i++) {
+				result[i] = sqrtf(re[i] * re[i] + im[i] * im[i]);
+				result[i] = static_cast<float>(log2(result[i]));
+				result[i] *= scale;
+			}
+			sink = result[1];
+		}) / static_cast<double>(bins);
+
+		const double kernelNs = nsPerCall(iterations, [&] {
+			logMagnitudes(re.data(), im.data(), result.data(), bins, scale);
+			sink = result[1];
+		}) / static_cast<double>(bins);
+
+		out << "  " << bins << " bins:\tscalar libm " << scalarNs << "\tkernel " << kernelNs
+			<< "\t(" << scalarNs / kernelNs << "x)\n";
+	}
+}
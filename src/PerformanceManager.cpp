@@ -1,6 +1,29 @@
 #include "../include/PerformanceManager.h"
-#include <iostream>
+#include "../include/ReportCompare.h"
+
+#define GLFW_INCLUDE_NONE
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+//  Set by CMake at configure time
+#ifndef AUDIOVIS_GIT_COMMIT
+#define AUDIOVIS_GIT_COMMIT "unknown"
+#endif
 
 using us = std::chrono::microseconds;
 using timePoint = std::chrono::steady_clock::time_point;
@@ -15,6 +38,82 @@ static us calculateTimeDifference(const timePoint& start,
     return std::chrono::duration_cast<us>(end - start);
 }
 
+static us averageOf(const LatencyHistogram& histogram)
+{
+    return std::chrono::duration_cast<us>(std::chrono::duration<double, std::nano>(histogram.mean()));
+}
+
+//  x86 brand string, "unknown" elsewhere
+static std::string cpuName()
+{
+    std::array<unsigned int, 12> brand{};
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    std::array<int, 4> regs{};
+    __cpuid(regs.data(), 0x80000000);
+    if (static_cast<unsigned int>(regs[0]) < 0x80000004) return "unknown";
+    for (int i = 0; i < 3; i++) {
+        __cpuid(regs.data(), 0x80000002 + i);
+        std::memcpy(&brand[i * 4], regs.data(), sizeof(regs));
+    }
+#elif defined(__x86_64__) || defined(__i386__)
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000004) return "unknown";
+    for (unsigned int i = 0; i < 3; i++)
+        __get_cpuid(0x80000002 + i, &brand[i * 4], &brand[i * 4 + 1], &brand[i * 4 + 2], &brand[i * 4 + 3]);
+#else
+    return "unknown";
+#endif
+    std::string name(reinterpret_cast<const char*>(brand.data()), strnlen(reinterpret_cast<const char*>(brand.data()), sizeof(brand)));
+    name.erase(0, name.find_first_not_of(' '));
+    name.erase(name.find_last_not_of(' ') + 1);
+    return name;
+}
+
+static std::string glString(const GLenum name)
+{
+    const auto* s = reinterpret_cast<const char*>(glGetString(name));
+    return s ? s : "unknown";
+}
+
+static std::string utcTimestamp()
+{
+    const std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &now);
+#else
+    gmtime_r(&now, &utc);
+#endif
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    return buffer;
+}
+
+static JsonValue zoneReport(const ZoneStats& zone)
+{
+    JsonValue report;
+    report.set("unit", "ns");
+    report.set("count", zone.count);
+    report.set("threads", zone.threads);
+    report.set("total", zone.totalNs);
+    report.set("min", zone.minNs);
+    report.set("max", zone.maxNs);
+    report.set("mean", zone.meanNs());
+    return report;
+}
+
+static void printTimer(const char* name, const LatencyHistogram& histogram)
+{
+    const auto toUs = [](const double ns) { return ns / 1000.0; };
+    std::cout << name << " (us, " << histogram.count() << " samples)\n";
+    std::cout << "    min " << toUs(static_cast<double>(histogram.min()))
+              << "  mean " << toUs(histogram.mean())
+              << "  stddev " << toUs(histogram.stddev())
+              << "  max " << toUs(static_cast<double>(histogram.max())) << "\n";
+    std::cout << "    p50 " << toUs(static_cast<double>(histogram.percentile(50.0)))
+              << "  p95 " << toUs(static_cast<double>(histogram.percentile(95.0)))
+              << "  p99 " << toUs(static_cast<double>(histogram.percentile(99.0))) << "\n";
+}
+
 // ----------------------------------------------------
 // Benchmark API Functions
 // ----------------------------------------------------
@@ -26,7 +125,12 @@ PerformanceManager::PerformanceManager()
 
 PerformanceManager::~PerformanceManager()
 {
-    if (systemTimerRunning) {
+    if (Profiler::tracing())
+        writeTrace();
+
+    //  Nothing unwritten, or nothing measured since the last report
+    const bool recorded = frameTimes.count() || fftTimes.count() || renderTimes.count() || latencies.count();
+    if (systemTimerRunning && recorded) {
         stopSystemTimer();
         writePerformanceData();
     }
@@ -47,9 +151,10 @@ us PerformanceManager::stopFrameTimer()
     const us duration = calculateTimeDifference(startFrameTime, end);
 
     frameTimerRunning = false;
-    frameCounter++;
+    frameTimes.record(end - startFrameTime);
+    static const uint32_t frameZone = Profiler::zoneIndex("frame");
+    Profiler::record(frameZone, startFrameTime, end);
     mostRecentFrameTime_us = duration.count();
-    frameTimeAccumulator_us += duration.count();
 
     return duration;
 }
@@ -69,9 +174,8 @@ us PerformanceManager::stopFFTTimer()
     const us duration = calculateTimeDifference(startFFTTime, end);
 
     fftTimerRunning = false;
-    fftCounter++;
+    fftTimes.record(end - startFFTTime);
     mostRecentFFTTime_us = duration.count();
-    fftTimeAccumulator_us += duration.count();
 
     return duration;
 }
@@ -91,33 +195,160 @@ us PerformanceManager::stopRenderTimer()
     const us duration = calculateTimeDifference(startRenderTime, end);
 
     renderTimerRunning = false;
-    renderCounter++;
+    renderTimes.record(end - startRenderTime);
     mostRecentRenderTime_us = duration.count();
-    renderTimeAccumulator_us += duration.count();
 
     return duration;
 }
 
-void PerformanceManager::writePerformanceData()     //  Writes to std::cout for now, will write to JSON eventually.
+us PerformanceManager::recordLatency(const timePoint captureTime)
+{
+    if (captureTime == timePoint{})
+        return us(0);
+
+    //  A capture stamp from the device clock can be a hair ahead of ours, that counts as no latency
+    const auto latency = std::max(std::chrono::steady_clock::now() - captureTime, std::chrono::steady_clock::duration::zero());
+    latencies.record(latency);
+    mostRecentLatency_us = std::chrono::duration_cast<us>(latency).count();
+
+    return us(mostRecentLatency_us);
+}
+
+std::filesystem::path PerformanceManager::writePerformanceData(const std::string& label)
 {
     if (systemTimerRunning)
         systemRunTime = stopSystemTimer();
 
+    const us averageFrameTime = getAverageFrameTime();
+
     std::cout << std::endl
               << std::endl;
     std::cout << "----------------------------------------------------\n";
-    std::cout << "             Performance Summary\n";
+    std::cout << "             Performance Summary (" << label << ")\n";
     std::cout << "----------------------------------------------------\n";
     std::cout << "System Runtime:      " << getSystemRunTime() << "\n";
-    std::cout << "Frames Measured:     " << frameCounter  << "\n";
-    std::cout << "FFTs Measured:       " << fftCounter    << "\n";
-    std::cout << "Renders Measured:    " << renderCounter << "\n";
+    std::cout << "Frames Measured:     " << frameTimes.count()  << "\n";
+    std::cout << "FFTs Measured:       " << fftTimes.count()    << "\n";
+    std::cout << "Renders Measured:    " << renderTimes.count() << "\n";
+    std::cout << "Latencies Measured:  " << latencies.count()   << "\n";
     std::cout << std::endl;
     std::cout << "----------------------------------------------------\n";
-    std::cout << "Average Frame Time:  " << getAverageFrameTime() << "\n";
-    std::cout << "Average FPS:         " << static_cast<unsigned int>(1.0f / (static_cast<double>(getAverageFrameTime().count()) / 10e6)) << "\n";
-    std::cout << "Average FFT Time:    " << getAverageFFTTime() << "\n";
-    std::cout << "Average Render Time: " << getAverageRenderTime() << "\n";
+    std::cout << "Average FPS:         " << (averageFrameTime.count() ? 1000000 / averageFrameTime.count() : 0) << "\n";
+    printTimer("Frame Time", frameTimes);
+    printTimer("FFT Time", fftTimes);
+    printTimer("Render Time", renderTimes);
+    printTimer("Audio to Screen Latency", latencies);
+    for (const ZoneStats& zone : getZones())
+        std::cout << "Zone " << zone.name << " (us, " << zone.count << " samples)  mean " << zone.meanNs() / 1000.0
+                  << "  max " << static_cast<double>(zone.maxNs) / 1000.0 << "\n";
+
+    std::error_code error;
+    std::filesystem::create_directories(outputDirectory, error);
+    const std::filesystem::path file = outputDirectory / (label + ".json");
+    std::ofstream out(file, std::ios::trunc);
+    if (error || !out) {
+        std::cerr << "Unable to write performance report " << file.string() << "\n";
+        return {};
+    }
+
+    out << buildReport(label) << "\n";
+    std::cout << "Report:              " << file.string() << "\n";
+    return file;
+}
+
+
+JsonValue PerformanceManager::buildReport(const std::string& label) const
+{
+    JsonValue metadata;
+    metadata.set("commit", AUDIOVIS_GIT_COMMIT);
+    metadata.set("timestamp", utcTimestamp());
+    metadata.set("cpu", cpuName());
+    metadata.set("glVendor", glVendor);
+    metadata.set("glRenderer", glRenderer);
+    metadata.set("glVersion", glVersion);
+    metadata.set("fftSize", runInfo.fftSize);
+    metadata.set("sampleRate", runInfo.sampleRate);
+    metadata.set("barCount", runInfo.barCount);
+    metadata.set("mode", runInfo.mode);
+    metadata.set("renderPath", runInfo.renderPath);
+
+    JsonValue timers;
+    timers.set("frame", histogramReport(frameTimes));
+    timers.set("fft", histogramReport(fftTimes));
+    timers.set("render", histogramReport(renderTimes));
+    timers.set("latency", histogramReport(latencies));
+
+    JsonValue zones = JsonValue::Object{};
+    for (const ZoneStats& zone : getZones())
+        zones.set(zone.name, zoneReport(zone));
+
+    JsonValue report;
+    report.set("format", "audiovis-perf-1");
+    report.set("label", label);
+    report.set("metadata", std::move(metadata));
+    report.set("runtimeSeconds", std::chrono::duration<double>(systemRunTime).count());
+    report.set("timers", std::move(timers));
+    report.set("zones", std::move(zones));
+    return report;
+}
+
+
+std::filesystem::path PerformanceManager::writeTrace(const std::string& label) const
+{
+    std::error_code error;
+    std::filesystem::create_directories(outputDirectory, error);
+    const std::filesystem::path file = outputDirectory / (label + ".trace.json");
+    std::ofstream out(file, std::ios::trunc);
+    if (error || !out) {
+        std::cerr << "Unable to write trace " << file.string() << "\n";
+        return {};
+    }
+
+    //  Complete ("X") events carry begin and duration, timestamps are in microseconds
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << std::fixed << std::setprecision(3);
+    bool first = true;
+    auto separator = [&] { out << (first ? "" : ",\n"); first = false; };
+
+    uint64_t events = 0, dropped = 0;
+    for (const ThreadTrace& thread : Profiler::collectTrace()) {
+        separator();
+        const std::string name = thread.name ? thread.name : "thread " + std::to_string(thread.thread);
+        out << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << thread.thread << R"(,"args":{"name":)" << JsonValue(name) << "}}";
+
+        for (const TraceEvent& event : thread.events) {
+            separator();
+            out << R"({"name":)" << JsonValue(Profiler::zoneName(event.zone)) << R"(,"cat":"zone","ph":"X","pid":1,"tid":)" << thread.thread
+                << R"(,"ts":)" << static_cast<double>(event.startNs) / 1000.0 << R"(,"dur":)" << static_cast<double>(event.durationNs) / 1000.0 << "}";
+        }
+        events += thread.events.size();
+        dropped += thread.dropped;
+    }
+    out << "\n]}\n";
+
+    std::cout << "Trace:               " << file.string() << " (" << events << " events, " << dropped << " overwritten)\n";
+    return file;
+}
+
+
+void PerformanceManager::setRunInfo(RunInfo info)
+{
+    runInfo = std::move(info);
+    glVendor = glString(GL_VENDOR);
+    glRenderer = glString(GL_RENDERER);
+    glVersion = glString(GL_VERSION);
+}
+
+
+void PerformanceManager::resetTimers()
+{
+    frameTimes.reset();
+    fftTimes.reset();
+    renderTimes.reset();
+    latencies.reset();
+    mostRecentFrameTime_us = mostRecentFFTTime_us = mostRecentRenderTime_us = mostRecentLatency_us = 0;
+    Profiler::reset();
+    startSystemTimer();
 }
 
 
@@ -139,25 +370,30 @@ us PerformanceManager::getCurrentFrameTime() const
 {
     return std::chrono::microseconds (mostRecentFrameTime_us);
 }
+us PerformanceManager::getCurrentLatency() const
+{
+    return std::chrono::microseconds(mostRecentLatency_us);
+}
 us PerformanceManager::getAverageFFTTime() const
 {
-    if (fftCounter == 0) return std::chrono::microseconds(0);
-    return std::chrono::microseconds(fftTimeAccumulator_us/fftCounter);
+    return averageOf(fftTimes);
 }
 us PerformanceManager::getAverageRenderTime() const
 {
-    if (renderCounter == 0) return std::chrono::microseconds(0);
-    return std::chrono::microseconds(renderTimeAccumulator_us/renderCounter);
+    return averageOf(renderTimes);
 }
 us PerformanceManager::getAverageFrameTime() const
 {
-    if (frameCounter == 0) return std::chrono::microseconds(0);
-    return std::chrono::microseconds(frameTimeAccumulator_us/frameCounter);
+    return averageOf(frameTimes);
+}
+us PerformanceManager::getAverageLatency() const
+{
+    return averageOf(latencies);
 }
 
 std::chrono::seconds PerformanceManager::getSystemRunTime() const
 {
-    return std::chrono::seconds(static_cast<int>(static_cast<double>(systemRunTime.count()) / 10e6)); // Divide by 10e6 to get seconds
+    return std::chrono::duration_cast<std::chrono::seconds>(systemRunTime);
 }
 
 
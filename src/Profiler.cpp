@@ -0,0 +1,238 @@
+#include "../include/Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+//	Zone names, written under the lock and published by the count
+static std::array<const char*, Profiler::MAX_ZONES> zoneNames{};
+static std::atomic<uint32_t> zoneCount{ 0 };
+static std::mutex registration;
+
+static std::atomic<uint32_t> currentGeneration{ 0 };
+
+static std::atomic<bool> tracingEnabled{ false };
+static std::atomic<uint32_t> threadCount{ 0 };
+static const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+std::atomic<Profiler::ThreadBuffer*> Profiler::buffers{ nullptr };
+
+
+uint32_t Profiler::zoneIndex(const char* name)
+{
+	std::lock_guard lock(registration);
+	const uint32_t count = zoneCount.load(std::memory_order_relaxed);
+	for (uint32_t i = 0; i < count; i++)
+		if (std::strcmp(zoneNames[i], name) == 0) return i;
+
+	if (count == MAX_ZONES) return MAX_ZONES;
+	zoneNames[count] = name;
+	zoneCount.store(count + 1, std::memory_order_release);
+	return count;
+}
+
+
+const char* Profiler::zoneName(const uint32_t zone)
+{
+	return zone < zoneCount.load(std::memory_order_acquire) ? zoneNames[zone] : "unknown";
+}
+
+
+Profiler::ThreadBuffer& Profiler::localBuffer()
+{
+	//	Hands the buffer back when the thread exits
+	struct Owner {
+		ThreadBuffer* buffer = acquireBuffer();
+		~Owner() { buffer->inUse.store(false, std::memory_order_release); }
+	};
+	thread_local Owner owner;
+	return *owner.buffer;
+}
+
+
+Profiler::ThreadBuffer* Profiler::acquireBuffer()
+{
+	const uint32_t thread = threadCount.fetch_add(1, std::memory_order_relaxed);
+
+	//	Take over the buffer of a thread that exited, ring included
+	for (ThreadBuffer* buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+		bool free = false;
+		if (buffer->inUse.load(std::memory_order_relaxed) || !buffer->inUse.compare_exchange_strong(free, true, std::memory_order_acquire)) continue;
+
+		buffer->traceFirst.store(buffer->traceWritten.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		buffer->name.store(nullptr, std::memory_order_relaxed);
+		buffer->thread.store(thread, std::memory_order_relaxed);
+		return buffer;
+	}
+
+	auto* buffer = new ThreadBuffer;
+	buffer->generation.store(currentGeneration.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	buffer->thread.store(thread, std::memory_order_relaxed);
+	ThreadBuffer* head = buffers.load(std::memory_order_relaxed);
+	do buffer->next = head;
+	while (!buffers.compare_exchange_weak(head, buffer, std::memory_order_seq_cst, std::memory_order_relaxed));
+	return buffer;
+}
+
+
+void Profiler::record(const uint32_t zone, const uint64_t ns)
+{
+	if (zone >= MAX_ZONES) return;
+	ThreadBuffer& buffer = localBuffer();
+
+	//	Only this thread writes its counters, so loads and stores are enough
+	constexpr auto relaxed = std::memory_order_relaxed;
+	const uint32_t generation = currentGeneration.load(relaxed);
+	if (buffer.generation.load(relaxed) != generation) {
+		for (Counters& counters : buffer.zones) {
+			counters.count.store(0, relaxed);
+			counters.totalNs.store(0, relaxed);
+			counters.minNs.store(std::numeric_limits<uint64_t>::max(), relaxed);
+			counters.maxNs.store(0, relaxed);
+		}
+		buffer.generation.store(generation, std::memory_order_release);
+	}
+
+	Counters& counters = buffer.zones[zone];
+	counters.totalNs.store(counters.totalNs.load(relaxed) + ns, relaxed);
+	if (ns < counters.minNs.load(relaxed)) counters.minNs.store(ns, relaxed);
+	if (ns > counters.maxNs.load(relaxed)) counters.maxNs.store(ns, relaxed);
+	counters.count.store(counters.count.load(relaxed) + 1, std::memory_order_release);
+}
+
+
+void Profiler::record(const uint32_t zone, const std::chrono::steady_clock::time_point start, const std::chrono::steady_clock::time_point end)
+{
+	const auto ns = [](const std::chrono::steady_clock::duration d) {
+		return static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count(), 0));
+	};
+	record(zone, ns(end - start));
+	if (zone >= MAX_ZONES || !tracingEnabled.load(std::memory_order_relaxed)) return;
+
+	ThreadBuffer& buffer = localBuffer();
+	TraceSlot* ring = buffer.trace.load(std::memory_order_acquire);
+	if (!ring) return;
+
+	//	The slot is written before the count that publishes it
+	constexpr auto relaxed = std::memory_order_relaxed;
+	const uint64_t written = buffer.traceWritten.load(relaxed);
+	TraceSlot& slot = ring[written & (TRACE_CAPACITY - 1)];
+	slot.zone.store(zone, relaxed);
+	slot.startNs.store(ns(start - traceEpoch), relaxed);
+	slot.durationNs.store(ns(end - start), relaxed);
+	buffer.traceWritten.store(written + 1, std::memory_order_release);
+}
+
+
+std::vector<ZoneStats> Profiler::snapshot()
+{
+	const uint32_t count = zoneCount.load(std::memory_order_acquire);
+	std::vector<ZoneStats> zones(count);
+	for (uint32_t i = 0; i < count; i++) {
+		zones[i].name = zoneNames[i];
+		zones[i].minNs = std::numeric_limits<uint64_t>::max();
+	}
+
+	//	Buffers still on an older generation have recorded nothing since the reset
+	const uint32_t generation = currentGeneration.load(std::memory_order_relaxed);
+	for (const ThreadBuffer* buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+		if (buffer->generation.load(std::memory_order_acquire) != generation) continue;
+
+		for (uint32_t i = 0; i < count; i++) {
+			const Counters& counters = buffer->zones[i];
+			const uint64_t samples = counters.count.load(std::memory_order_acquire);
+			if (samples == 0) continue;
+
+			ZoneStats& zone = zones[i];
+			zone.count += samples;
+			zone.totalNs += counters.totalNs.load(std::memory_order_relaxed);
+			zone.minNs = std::min(zone.minNs, counters.minNs.load(std::memory_order_relaxed));
+			zone.maxNs = std::max(zone.maxNs, counters.maxNs.load(std::memory_order_relaxed));
+			zone.threads++;
+		}
+	}
+
+	std::erase_if(zones, [](const ZoneStats& zone) { return zone.count == 0; });
+	return zones;
+}
+
+
+void Profiler::reset()
+{
+	currentGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void Profiler::allocateTrace(ThreadBuffer& buffer)
+{
+	if (buffer.trace.load(std::memory_order_acquire)) return;
+	auto* ring = new TraceSlot[TRACE_CAPACITY];
+	TraceSlot* expected = nullptr;
+	if (!buffer.trace.compare_exchange_strong(expected, ring, std::memory_order_acq_rel)) delete[] ring;
+}
+
+
+void Profiler::setTracing(const bool enabled)
+{
+	tracingEnabled.store(enabled, std::memory_order_seq_cst);
+	if (!enabled) return;
+	for (ThreadBuffer* buffer = buffers.load(std::memory_order_seq_cst); buffer; buffer = buffer->next)
+		allocateTrace(*buffer);
+}
+
+
+bool Profiler::tracing()
+{
+	return tracingEnabled.load(std::memory_order_relaxed);
+}
+
+
+std::vector<ThreadTrace> Profiler::collectTrace()
+{
+	std::vector<ThreadTrace> traces;
+	for (const ThreadBuffer* buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+		const TraceSlot* ring = buffer->trace.load(std::memory_order_acquire);
+		if (!ring) continue;
+
+		ThreadTrace& trace = traces.emplace_back();
+		trace.thread = buffer->thread.load(std::memory_order_relaxed);
+		trace.name = buffer->name.load(std::memory_order_relaxed);
+
+		const uint64_t written = buffer->traceWritten.load(std::memory_order_acquire);
+		const uint64_t owned = std::min(buffer->traceFirst.load(std::memory_order_relaxed), written);
+		const uint64_t first = std::max(owned, written > TRACE_CAPACITY ? written - TRACE_CAPACITY : 0);
+		trace.events.reserve(static_cast<size_t>(written - first));
+		for (uint64_t i = first; i < written; i++) {
+			const TraceSlot& slot = ring[i & (TRACE_CAPACITY - 1)];
+			trace.events.push_back({ slot.zone.load(std::memory_order_relaxed), slot.startNs.load(std::memory_order_relaxed),
+				slot.durationNs.load(std::memory_order_relaxed) });
+		}
+
+		//	Whatever the owner wrapped onto while we copied may be torn, drop it
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64_t after = buffer->traceWritten.load(std::memory_order_relaxed);
+		const uint64_t valid = after > TRACE_CAPACITY ? after - TRACE_CAPACITY : 0;
+		const auto torn = static_cast<size_t>(std::min(valid > first ? valid - first : 0, written - first));
+		trace.events.erase(trace.events.begin(), trace.events.begin() + static_cast<std::ptrdiff_t>(torn));
+		trace.dropped = first - owned + torn;
+	}
+
+	std::sort(traces.begin(), traces.end(), [](const ThreadTrace& a, const ThreadTrace& b) { return a.thread < b.thread; });
+	return traces;
+}
+
+
+void Profiler::setThreadName(const char* name)
+{
+	ThreadBuffer& buffer = localBuffer();
+	buffer.name.store(name, std::memory_order_relaxed);
+
+	//	Either this sees tracing on or setTracing() sees this buffer in the list
+	if (tracingEnabled.load(std::memory_order_seq_cst)) allocateTrace(buffer);
+}
+
+
+std::chrono::steady_clock::time_point Profiler::epoch()
+{
+	return traceEpoch;
+}
@@ -0,0 +1,272 @@
+#include "../include/ProgramCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+//	GL 4.1 tokens, not in a 3.3 core loader
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+using GetProgramBinaryFn = void (APIENTRYP)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+using ProgramBinaryFn = void (APIENTRYP)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+using ProgramParameteriFn = void (APIENTRYP)(GLuint program, GLenum pname, GLint value);
+
+//	File header in front of the driver's blob
+struct BinaryHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t key;
+	uint32_t format;
+	uint32_t length;
+};
+
+static constexpr char BINARY_MAGIC[4] = { 'A', 'V', 'P', 'B' };
+static constexpr uint32_t BINARY_VERSION = 1;
+
+// ----------------------------------------------------
+// Program binary lookup
+// ----------------------------------------------------
+
+struct ProgramBinaryApi {
+	GetProgramBinaryFn getProgramBinary = nullptr;
+	ProgramBinaryFn programBinary = nullptr;
+	ProgramParameteriFn programParameteri = nullptr;
+
+	explicit operator bool() const { return getProgramBinary && programBinary && programParameteri; }
+};
+
+//	Same as glBufferStorage in VertexRing: fetched by hand, and only trusted when the version or
+//	extension string backs it up. A driver can also support the calls but offer no formats.
+static ProgramBinaryApi loadProgramBinary()
+{
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+	bool supported = major > 4 || (major == 4 && minor >= 1);
+	if (!supported) {
+		GLint extensions = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+		for (GLint i = 0; i < extensions && !supported; i++) {
+			const auto* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+			supported = name && std::strcmp(name, "GL_ARB_get_program_binary") == 0;
+		}
+	}
+	if (!supported) return {};
+
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	if (formats <= 0) return {};
+
+	return {
+		reinterpret_cast<GetProgramBinaryFn>(glfwGetProcAddress("glGetProgramBinary")),
+		reinterpret_cast<ProgramBinaryFn>(glfwGetProcAddress("glProgramBinary")),
+		reinterpret_cast<ProgramParameteriFn>(glfwGetProcAddress("glProgramParameteri"))
+	};
+}
+
+
+bool ProgramCache::hasProgramBinary()
+{
+	return static_cast<bool>(loadProgramBinary());
+}
+
+
+// ----------------------------------------------------
+// Keys
+// ----------------------------------------------------
+
+static constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+static uint64_t fnv1a(uint64_t hash, const void* data, const size_t bytes)
+{
+	const auto* p = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < bytes; i++) {
+		hash ^= p[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+
+uint64_t ProgramCache::sourceHash(const std::initializer_list<ShaderStage> stages)
+{
+	uint64_t hash = FNV_OFFSET;
+	for (const ShaderStage& stage : stages) {
+		hash = fnv1a(hash, &stage.type, sizeof(stage.type));
+		const uint64_t length = stage.source.size();
+		hash = fnv1a(hash, &length, sizeof(length));
+		hash = fnv1a(hash, stage.source.data(), stage.source.size());
+	}
+	return hash;
+}
+
+
+//	A binary is only valid for the driver that produced it
+static uint64_t driverHash(uint64_t hash)
+{
+	for (const GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+		const auto* s = reinterpret_cast<const char*>(glGetString(name));
+		if (s) hash = fnv1a(hash, s, std::strlen(s) + 1);
+	}
+	return hash;
+}
+
+
+// ----------------------------------------------------
+// Binary files
+// ----------------------------------------------------
+
+static bool loadBinary(const ProgramBinaryApi& api, const GLuint program, const std::filesystem::path& file, const uint64_t key)
+{
+	std::ifstream in(file, std::ios::binary);
+	if (!in) return false;
+
+	BinaryHeader header{};
+	if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+	if (std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0 || header.version != BINARY_VERSION || header.key != key)
+		return false;
+
+	std::vector<char> blob(header.length);
+	if (!in.read(blob.data(), static_cast<std::streamsize>(blob.size()))) return false;
+
+	//	The driver may still refuse it (e.g. same strings but a different build), which is just a miss
+	api.programBinary(program, header.format, blob.data(), static_cast<GLsizei>(blob.size()));
+	GLint success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	return success != 0;
+}
+
+
+//	Best effort, a cache that can not be written only costs the next startup a relink
+static void storeBinary(const ProgramBinaryApi& api, const GLuint program, const std::filesystem::path& file, const uint64_t key)
+{
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return;
+
+	std::vector<char> blob(static_cast<size_t>(length));
+	GLenum format = 0;
+	api.getProgramBinary(program, length, &length, &format, blob.data());
+	if (length <= 0) return;
+
+	std::error_code error;
+	std::filesystem::create_directories(file.parent_path(), error);
+	if (error) return;
+
+	//	Written next to the entry and renamed over it, a crash mid-write never leaves a torn binary
+	BinaryHeader header{};
+	std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+	header.version = BINARY_VERSION;
+	header.key = key;
+	header.format = format;
+	header.length = static_cast<uint32_t>(length);
+
+	std::filesystem::path temp = file;
+	temp += ".tmp";
+	{
+		std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+		if (!out) return;
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(blob.data(), length);
+		if (!out) return;
+	}
+	std::filesystem::rename(temp, file, error);
+}
+
+
+// ----------------------------------------------------
+// ProgramCache
+// ----------------------------------------------------
+
+std::filesystem::path ProgramCache::defaultDirectory()
+{
+	std::error_code error;
+	const std::filesystem::path temp = std::filesystem::temp_directory_path(error);
+	return error ? std::filesystem::path() : temp / "AudioVis" / "shader-cache";
+}
+
+
+GLuint ProgramCache::link(const std::string_view name, const std::initializer_list<ShaderStage> stages)
+{
+	const ProgramBinaryApi api = directory.empty() ? ProgramBinaryApi{} : loadProgramBinary();
+	const uint64_t key = api ? driverHash(sourceHash(stages)) : 0;
+	const std::filesystem::path file = directory / (std::string(name) + ".bin");
+
+	GLuint program = glCreateProgram();
+	if (api && loadBinary(api, program, file, key)) {
+		hitCount++;
+		return program;
+	}
+	missCount++;
+
+	//	A rejected binary can leave the program in a failed state, start over from source
+	glDeleteProgram(program);
+	program = glCreateProgram();
+
+	std::vector<GLuint> shaders;
+	bool compiled = true;
+	for (const ShaderStage& stage : stages) {
+		const GLuint shader = glCreateShader(stage.type);
+		const char* source = stage.source.data();
+		const auto length = static_cast<GLint>(stage.source.size());
+		glShaderSource(shader, 1, &source, &length);
+		glCompileShader(shader);
+
+		GLint success = 0;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success) {
+			GLint len = 0;
+			glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &len);
+			std::string log(static_cast<size_t>(len), '\0');
+			glGetShaderInfoLog(shader, len, nullptr, log.data());
+			std::cerr << "Shader compile failed (" << name << "):\n" << log << "\n";
+			compiled = false;
+		}
+
+		glAttachShader(program, shader);
+		shaders.push_back(shader);
+	}
+
+	GLint success = 0;
+	if (compiled) {
+		if (api) api.programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glLinkProgram(program);
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+	}
+
+	for (const GLuint shader : shaders) {
+		glDetachShader(program, shader);
+		glDeleteShader(shader);
+	}
+
+	if (!success) {
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	if (api) storeBinary(api, program, file, key);
+	return program;
+}
+
+
+void ProgramCache::clear()
+{
+	if (directory.empty()) return;
+
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+		if (entry.path().extension() == ".bin") std::filesystem::remove(entry.path(), error);
+}
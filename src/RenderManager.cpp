@@ -0,0 +1,111 @@
+#include "../include/RenderManager.h"
+
+#include <cstddef>
+#include <cstring>
+
+void RenderManager::init(const std::initializer_list<GLuint> programs)
+{
+	if (!uniformBuffer) glGenBuffers(1, &uniformBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(BarUniforms), &staged, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, UNIFORM_BINDING, uniformBuffer);
+	uploaded = staged;
+
+	//	No layout(binding) in GLSL 3.30, the block is attached from here
+	for (const GLuint program : programs) {
+		const GLuint block = glGetUniformBlockIndex(program, "BarUniforms");
+		if (block != GL_INVALID_INDEX) glUniformBlockBinding(program, block, UNIFORM_BINDING);
+	}
+	invalidate();
+}
+
+
+void RenderManager::beginFrame()
+{
+	previous = current;
+	current = {};
+}
+
+
+void RenderManager::useProgram(const GLuint program)
+{
+	if (program == boundProgram) {
+		current.programBindsSkipped++;
+		return;
+	}
+	glUseProgram(program);
+	boundProgram = program;
+	current.programBinds++;
+}
+
+
+void RenderManager::bindVertexArray(const GLuint vertexArray)
+{
+	if (vertexArray == boundVertexArray) {
+		current.vertexArrayBindsSkipped++;
+		return;
+	}
+	glBindVertexArray(vertexArray);
+	boundVertexArray = vertexArray;
+	current.vertexArrayBinds++;
+}
+
+
+void RenderManager::bindTexture(const GLenum target, const GLuint texture)
+{
+	if (target == boundTextureTarget && texture == boundTexture) {
+		current.textureBindsSkipped++;
+		return;
+	}
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(target, texture);
+	boundTextureTarget = target;
+	boundTexture = texture;
+	current.textureBinds++;
+}
+
+
+void RenderManager::setBaseColor(const float* rgba)
+{
+	std::memcpy(staged.baseColor, rgba, sizeof(staged.baseColor));
+}
+
+
+void RenderManager::setBarCount(const int32_t count) { staged.barCount = count; }
+void RenderManager::setMode(const int32_t mode) { staged.mode = mode; }
+void RenderManager::setFirstBar(const int32_t first) { staged.firstBar = first; }
+
+
+void RenderManager::flushUniforms()
+{
+	//	Only the span between the first and last changed word goes up
+	const auto* now = reinterpret_cast<const unsigned char*>(&staged);
+	const auto* before = reinterpret_cast<const unsigned char*>(&uploaded);
+	size_t first = sizeof(BarUniforms), last = 0;
+	for (size_t word = 0; word < sizeof(BarUniforms); word += 4) {
+		if (std::memcmp(now + word, before + word, 4) == 0) continue;
+		if (first == sizeof(BarUniforms)) first = word;
+		last = word + 4;
+	}
+
+	if (first == sizeof(BarUniforms)) {
+		current.uniformUploadsSkipped++;
+		return;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(first), static_cast<GLsizeiptr>(last - first), now + first);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	uploaded = staged;
+	current.uniformUploads++;
+}
+
+
+void RenderManager::invalidate()
+{
+	boundProgram = ~0u;
+	boundVertexArray = ~0u;
+	boundTextureTarget = 0;
+	boundTexture = ~0u;
+}
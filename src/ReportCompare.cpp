@@ -0,0 +1,98 @@
+#include "../include/ReportCompare.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+JsonValue histogramReport(const LatencyHistogram& histogram)
+{
+	constexpr std::pair<const char*, double> reported[] = { { "50", 50.0 }, { "90", 90.0 }, { "95", 95.0 }, { "99", 99.0 }, { "99.9", 99.9 } };
+	JsonValue percentiles;
+	for (const auto& [name, p] : reported)
+		percentiles.set(name, histogram.percentile(p));
+
+	JsonValue::Array buckets;
+	histogram.forEachBucket([&](const uint64_t top, const uint64_t count) {
+		buckets.emplace_back(JsonValue::Array{ top, count });
+	});
+
+	JsonValue timer;
+	timer.set("unit", "ns");
+	timer.set("count", histogram.count());
+	timer.set("min", histogram.min());
+	timer.set("max", histogram.max());
+	timer.set("mean", histogram.mean());
+	timer.set("stddev", histogram.stddev());
+	timer.set("percentiles", std::move(percentiles));
+	timer.set("buckets", std::move(buckets));
+	return timer;
+}
+
+
+static double timerCount(const JsonValue& timer)
+{
+	const JsonValue* count = timer.find("count");
+	if (!count) throw std::runtime_error("Report timer has no count");
+	return count->number();
+}
+
+
+double reportPercentile(const JsonValue& timer, const double percent)
+{
+	const JsonValue* buckets = timer.find("buckets");
+	if (!buckets) throw std::runtime_error("Report timer has no buckets");
+
+	const double total = timerCount(timer);
+	if (total <= 0.0) return 0.0;
+
+	//	Same rule as LatencyHistogram::percentile: the top of the bucket holding the rank, within min and max
+	const double rank = std::max(std::ceil(std::clamp(percent, 0.0, 100.0) / 100.0 * total), 1.0);
+	const double lowest = timer.find("min") ? timer.find("min")->number() : 0.0;
+	const double highest = timer.find("max") ? timer.find("max")->number() : INFINITY;
+
+	double seen = 0.0;
+	for (const JsonValue& bucket : buckets->array()) {
+		seen += bucket.array().at(1).number();
+		if (seen >= rank) return std::clamp(bucket.array().at(0).number(), lowest, highest);
+	}
+	return highest;
+}
+
+
+std::vector<Regression> compareReports(const JsonValue& base, const JsonValue& candidate, const CompareOptions& options, std::ostream& out)
+{
+	const JsonValue* baseTimers = base.find("timers");
+	const JsonValue* candidateTimers = candidate.find("timers");
+	if (!baseTimers || !candidateTimers) throw std::runtime_error("Report has no timers");
+
+	std::vector<Regression> regressions;
+	for (const auto& [name, baseTimer] : baseTimers->object()) {
+		if (timerCount(baseTimer) <= 0.0) continue;
+
+		const JsonValue* candidateTimer = candidateTimers->find(name);
+		if (!candidateTimer || timerCount(*candidateTimer) <= 0.0) {
+			char line[160];
+			std::snprintf(line, sizeof(line), "  %-24s %s in the candidate report  MISSING\n", name.c_str(), candidateTimer ? "empty" : "missing");
+			out << line;
+			regressions.push_back({ name, 0.0, reportPercentile(baseTimer, 50.0), 0.0, true });
+			continue;
+		}
+
+		for (const double p : options.percentiles) {
+			const double before = reportPercentile(baseTimer, p);
+			const double after = reportPercentile(*candidateTimer, p);
+			const double change = before > 0.0 ? (after - before) / before * 100.0 : 0.0;
+			const bool regressed = change > options.thresholdPercent && after - before > options.minDeltaNs;
+
+			char line[160];
+			std::snprintf(line, sizeof(line), "  %-24s p%-5g %12.1f us -> %12.1f us  %+7.1f%%%s\n",
+				name.c_str(), p, before / 1000.0, after / 1000.0, change, regressed ? "  REGRESSION" : "");
+			out << line;
+
+			if (regressed) regressions.push_back({ name, p, before, after, false });
+		}
+	}
+	return regressions;
+}
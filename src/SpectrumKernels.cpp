@@ -0,0 +1,167 @@
+#include "../include/SpectrumKernels.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SPECTRUM_KERNEL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPECTRUM_KERNEL_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SPECTRUM_KERNEL_NEON
+#endif
+
+//	Minimax fit of log2(1 + t) = t * (c0 + c1 t + c2 t^2 + c3 t^3 + c4 t^4) for t in [0, 1)
+constexpr float LOG2_C0 = 1.4419655694640763f;
+constexpr float LOG2_C1 = -0.7096623683635953f;
+constexpr float LOG2_C2 = 0.4175944177013197f;
+constexpr float LOG2_C3 = -0.1962680091814493f;
+constexpr float LOG2_C4 = 0.04638469101884451f;
+
+constexpr uint32_t MANTISSA_MASK = 0x007fffff;
+constexpr uint32_t ONE_BITS = 0x3f800000;	//	1.0f, exponent 127
+
+float fastLog2(const float x)
+{
+	const auto bits = std::bit_cast<uint32_t>(x);
+	const auto exponent = static_cast<float>(static_cast<int32_t>(bits >> 23) - 127);
+	const float t = std::bit_cast<float>((bits & MANTISSA_MASK) | ONE_BITS) - 1.0f;
+
+	const float poly = LOG2_C0 + t * (LOG2_C1 + t * (LOG2_C2 + t * (LOG2_C3 + t * LOG2_C4)));
+	return exponent + t * poly;
+}
+
+
+//	Same computation as the vector paths, also used for their tails
+static inline float logMagnitude(const float re, const float im, const float halfScale, const float floorLog2)
+{
+	return halfScale * std::max(2.0f * floorLog2, fastLog2(re * re + im * im));
+}
+
+
+#if defined(SPECTRUM_KERNEL_AVX2)
+
+static inline __m256 fastLog2(const __m256 x)
+{
+	const __m256i bits = _mm256_castps_si256(x);
+	const __m256 exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+	const __m256 t = _mm256_sub_ps(_mm256_castsi256_ps(_mm256_or_si256(
+		_mm256_and_si256(bits, _mm256_set1_epi32(MANTISSA_MASK)), _mm256_set1_epi32(ONE_BITS))), _mm256_set1_ps(1.0f));
+
+	__m256 poly = _mm256_set1_ps(LOG2_C4);
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, t), _mm256_set1_ps(LOG2_C3));
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, t), _mm256_set1_ps(LOG2_C2));
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, t), _mm256_set1_ps(LOG2_C1));
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, t), _mm256_set1_ps(LOG2_C0));
+	return _mm256_add_ps(exponent, _mm256_mul_ps(t, poly));
+}
+
+
+void logMagnitudes(const float* re, const float* im, float* out, const size_t count, const float scale, const float floorLog2)
+{
+	const __m256 halfScale = _mm256_set1_ps(0.5f * scale);
+	const __m256 floor2 = _mm256_set1_ps(2.0f * floorLog2);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256 r = _mm256_loadu_ps(re + i);
+		const __m256 m = _mm256_loadu_ps(im + i);
+		const __m256 power = _mm256_add_ps(_mm256_mul_ps(r, r), _mm256_mul_ps(m, m));
+		_mm256_storeu_ps(out + i, _mm256_mul_ps(halfScale, _mm256_max_ps(floor2, fastLog2(power))));
+	}
+
+	for (; i < count; i++) out[i] = logMagnitude(re[i], im[i], 0.5f * scale, floorLog2);
+}
+
+
+const char* spectrumKernelIsa() { return "AVX2"; }
+
+#elif defined(SPECTRUM_KERNEL_SSE2)
+
+static inline __m128 fastLog2(const __m128 x)
+{
+	const __m128i bits = _mm_castps_si128(x);
+	const __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+	const __m128 t = _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(
+		_mm_and_si128(bits, _mm_set1_epi32(MANTISSA_MASK)), _mm_set1_epi32(ONE_BITS))), _mm_set1_ps(1.0f));
+
+	__m128 poly = _mm_set1_ps(LOG2_C4);
+	poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(LOG2_C3));
+	poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(LOG2_C2));
+	poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(LOG2_C1));
+	poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(LOG2_C0));
+	return _mm_add_ps(exponent, _mm_mul_ps(t, poly));
+}
+
+
+void logMagnitudes(const float* re, const float* im, float* out, const size_t count, const float scale, const float floorLog2)
+{
+	const __m128 halfScale = _mm_set1_ps(0.5f * scale);
+	const __m128 floor2 = _mm_set1_ps(2.0f * floorLog2);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128 r = _mm_loadu_ps(re + i);
+		const __m128 m = _mm_loadu_ps(im + i);
+		const __m128 power = _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(m, m));
+		_mm_storeu_ps(out + i, _mm_mul_ps(halfScale, _mm_max_ps(floor2, fastLog2(power))));
+	}
+
+	for (; i < count; i++) out[i] = logMagnitude(re[i], im[i], 0.5f * scale, floorLog2);
+}
+
+
+const char* spectrumKernelIsa() { return "SSE2"; }
+
+#elif defined(SPECTRUM_KERNEL_NEON)
+
+static inline float32x4_t fastLog2(const float32x4_t x)
+{
+	const uint32x4_t bits = vreinterpretq_u32_f32(x);
+	const float32x4_t exponent = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127)));
+	const float32x4_t t = vsubq_f32(vreinterpretq_f32_u32(vorrq_u32(
+		vandq_u32(bits, vdupq_n_u32(MANTISSA_MASK)), vdupq_n_u32(ONE_BITS))), vdupq_n_f32(1.0f));
+
+	float32x4_t poly = vdupq_n_f32(LOG2_C4);
+	poly = vmlaq_f32(vdupq_n_f32(LOG2_C3), poly, t);
+	poly = vmlaq_f32(vdupq_n_f32(LOG2_C2), poly, t);
+	poly = vmlaq_f32(vdupq_n_f32(LOG2_C1), poly, t);
+	poly = vmlaq_f32(vdupq_n_f32(LOG2_C0), poly, t);
+	return vmlaq_f32(exponent, t, poly);
+}
+
+
+void logMagnitudes(const float* re, const float* im, float* out, const size_t count, const float scale, const float floorLog2)
+{
+	const float32x4_t halfScale = vdupq_n_f32(0.5f * scale);
+	const float32x4_t floor2 = vdupq_n_f32(2.0f * floorLog2);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const float32x4_t r = vld1q_f32(re + i);
+		const float32x4_t m = vld1q_f32(im + i);
+		const float32x4_t power = vmlaq_f32(vmulq_f32(r, r), m, m);
+		vst1q_f32(out + i, vmulq_f32(halfScale, vmaxq_f32(floor2, fastLog2(power))));
+	}
+
+	for (; i < count; i++) out[i] = logMagnitude(re[i], im[i], 0.5f * scale, floorLog2);
+}
+
+
+const char* spectrumKernelIsa() { return "NEON"; }
+
+#else
+
+void logMagnitudes(const float* re, const float* im, float* out, const size_t count, const float scale, const float floorLog2)
+{
+	for (size_t i = 0; i < count; i++) out[i] = logMagnitude(re[i], im[i], 0.5f * scale, floorLog2);
+}
+
+
+const char* spectrumKernelIsa() { return "scalar"; }
+
+#endif
@@ -0,0 +1,46 @@
+#include "../include/Stft.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+Stft::Stft(const size_t windowLength, const size_t hopSize) : length(windowLength), hop(windowLength)
+{
+	if (windowLength == 0) throw std::invalid_argument("STFT window length must be non-zero");
+	setHopSize(hopSize);
+}
+
+
+void Stft::setHopSize(const size_t hopSize)
+{
+	if (hopSize == 0 || hopSize > length)
+		throw std::invalid_argument("STFT hop must be between 1 and the window length");
+	hop = hopSize;
+}
+
+
+bool Stft::nextFrame(SpscRingBuffer<float>& ring, float* out) const
+{
+	const auto [first, second] = ring.peek(length);
+	if (first.empty()) return false;
+
+	std::copy(first.begin(), first.end(), out);
+	std::copy(second.begin(), second.end(), out + first.size());
+
+	//	Only the hop leaves the ring, the rest is the start of the next window
+	ring.consume(hop);
+	return true;
+}
+
+
+bool Stft::nextFrame(SpscRingBuffer<float>& ring, float* out, const float* window) const
+{
+	const auto [first, second] = ring.peek(length);
+	if (first.empty()) return false;
+
+	const size_t split = first.size();
+	for (size_t i = 0; i < split; i++) out[i] = first[i] * window[i];
+	for (size_t i = 0; i < second.size(); i++) out[split + i] = second[i] * window[split + i];
+
+	ring.consume(hop);
+	return true;
+}
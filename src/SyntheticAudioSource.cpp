@@ -0,0 +1,118 @@
+#include "../include/SyntheticAudioSource.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+constexpr double TWO_PI = 6.283185307179586;
+
+SyntheticAudioSource::SyntheticAudioSource(const SyntheticSignal signal, const AudioFormat fmt, const uint32_t packetFrames)
+	: signal(signal), fmt(fmt), packetFrames(packetFrames), noiseState(signal.seed ? signal.seed : 1)
+{
+	if (fmt.sampleFormat != SampleFormat::Float32)
+		throw std::invalid_argument("SyntheticAudioSource only generates float32 samples");
+	if (fmt.channels == 0 || fmt.sampleRate == 0 || packetFrames == 0)
+		throw std::invalid_argument("Invalid format for SyntheticAudioSource");
+
+	buffer.resize(static_cast<size_t>(packetFrames) * fmt.channels);
+}
+
+
+bool SyntheticAudioSource::acquirePacket(AudioPacket& packet)
+{
+	if (realtime) {
+		if (!pacer.ready(packetFrames, fmt.sampleRate)) return false;
+		pacer.advance(packetFrames);
+	}
+
+	const uint16_t channels = fmt.channels;
+
+	for (uint32_t i = 0; i < packetFrames; i++) {
+		const float sample = nextSample();
+		for (uint16_t c = 0; c < channels; c++)
+			buffer[i * channels + c] = sample;
+	}
+
+	packet.data = reinterpret_cast<const std::byte*>(buffer.data());
+	packet.frames = packetFrames;
+	packet.silent = signal.waveform == Waveform::Silence;
+	packet.captureTime = realtime ? pacer.releasedUntil(fmt.sampleRate) : std::chrono::steady_clock::now();
+	return true;
+}
+
+
+bool SyntheticAudioSource::waitForPacket(const std::chrono::milliseconds timeout)
+{
+	if (!realtime) return true;
+
+	pacer.waitUntilReady(packetFrames, fmt.sampleRate, timeout);
+	return pacer.ready(packetFrames, fmt.sampleRate);
+}
+
+
+void SyntheticAudioSource::setRealtime(const bool enabled)
+{
+	realtime = enabled;
+	pacer.reset();
+}
+
+
+void SyntheticAudioSource::onCaptureThreadStart()
+{
+	realtimeBeforeCapture = realtime;
+	if (!realtime) setRealtime(true);
+}
+
+
+void SyntheticAudioSource::onCaptureThreadStop()
+{
+	if (!realtimeBeforeCapture) setRealtime(false);
+}
+
+
+float SyntheticAudioSource::nextSample()
+{
+	const double sampleRate = fmt.sampleRate;
+	double value = 0.0;
+
+	switch (signal.waveform) {
+	case Waveform::Sine:
+		value = std::sin(phase);
+		phase += TWO_PI * signal.frequency / sampleRate;
+		break;
+
+	case Waveform::Chirp: {
+		//	Instantaneous frequency ramps linearly, phase is integrated so the sweep is continuous
+		const auto sweepFrames = static_cast<uint64_t>(signal.sweepSeconds * sampleRate);
+		const double t = sweepFrames ? static_cast<double>(frameIndex % sweepFrames) / static_cast<double>(sweepFrames) : 0.0;
+		const double freq = signal.frequency + (signal.endFrequency - signal.frequency) * t;
+		value = std::sin(phase);
+		phase += TWO_PI * freq / sampleRate;
+		break;
+	}
+
+	case Waveform::Noise:
+		//	xorshift32, mapped to [-1, 1)
+		noiseState ^= noiseState << 13;
+		noiseState ^= noiseState >> 17;
+		noiseState ^= noiseState << 5;
+		value = static_cast<double>(noiseState) / 2147483648.0 - 1.0;
+		break;
+
+	case Waveform::Impulse: {
+		const auto period = std::max<uint64_t>(static_cast<uint64_t>(sampleRate / signal.frequency + 0.5), 1);
+		value = frameIndex % period == 0 ? 1.0 : 0.0;
+		break;
+	}
+
+	case Waveform::Silence:
+	default:
+		break;
+	}
+
+	//	Keep the phase small so long runs don't lose precision
+	if (phase >= TWO_PI) phase -= TWO_PI;
+
+	frameIndex++;
+	return static_cast<float>(value * signal.amplitude);
+}
@@ -0,0 +1,163 @@
+#include "../include/VertexRing.h"
+
+#include <cstring>
+#include <stdexcept>
+
+//	GL 4.4 tokens, not in a 3.3 core loader
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+using BufferStorageFn = void (APIENTRYP)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+// ----------------------------------------------------
+// Buffer storage lookup
+// ----------------------------------------------------
+
+//	The loader only covers 3.3, so glBufferStorage is fetched by hand. A non null address alone
+//	proves nothing on some drivers, the version or extension string has to back it up.
+static BufferStorageFn loadBufferStorage()
+{
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+	bool supported = major > 4 || (major == 4 && minor >= 4);
+	if (!supported) {
+		GLint extensions = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+		for (GLint i = 0; i < extensions && !supported; i++) {
+			const auto* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+			supported = name && std::strcmp(name, "GL_ARB_buffer_storage") == 0;
+		}
+	}
+
+	return supported ? reinterpret_cast<BufferStorageFn>(glfwGetProcAddress("glBufferStorage")) : nullptr;
+}
+
+
+bool VertexRing::hasBufferStorage()
+{
+	return loadBufferStorage() != nullptr;
+}
+
+
+// ----------------------------------------------------
+// VertexRing
+// ----------------------------------------------------
+
+void VertexRing::init(const GLuint vbo, const size_t bytes, const UploadStrategy wanted)
+{
+	if (vbo == 0 || bytes == 0) throw std::invalid_argument("VertexRing needs a buffer and a segment size");
+
+	if (vbo == buffer && current == UploadStrategy::PersistentMapped)
+		throw std::logic_error("Buffer storage is immutable, re-initialise VertexRing with a new buffer name");
+
+	release();
+	buffer = vbo;
+	segmentBytes = bytes;
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	const BufferStorageFn bufferStorage = wanted == UploadStrategy::PersistentMapped ? loadBufferStorage() : nullptr;
+	if (bufferStorage) {
+		constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		const auto total = static_cast<GLsizeiptr>(segmentBytes * SEGMENTS);
+		bufferStorage(GL_ARRAY_BUFFER, total, nullptr, flags);
+		mapped = static_cast<std::byte*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, total, flags));
+		if (!mapped) throw std::runtime_error("Unable to map the vertex buffer");
+
+		current = UploadStrategy::PersistentMapped;
+		return;
+	}
+
+	current = wanted == UploadStrategy::BufferData ? UploadStrategy::BufferData : UploadStrategy::Orphaning;
+	staging.resize(segmentBytes);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(segmentBytes), nullptr, GL_STREAM_DRAW);
+}
+
+
+bool VertexRing::setStrategy(const UploadStrategy wanted)
+{
+	if (segmentBytes == 0) throw std::logic_error("VertexRing::setStrategy needs an initialised ring");
+	if (wanted == current) return false;
+
+	GLuint vbo = buffer;
+	const bool renamed = current == UploadStrategy::PersistentMapped;
+	if (renamed) {
+		release();
+		glDeleteBuffers(1, &buffer);
+		buffer = 0;
+		glGenBuffers(1, &vbo);
+	}
+	init(vbo, segmentBytes, wanted);
+	return renamed;
+}
+
+
+void* VertexRing::map()
+{
+	if (current != UploadStrategy::PersistentMapped) return staging.data();
+
+	//	Normally long signalled, SEGMENTS - 1 frames have been submitted since this one was fenced
+	if (GLsync& sync = fences[segment]) {
+		GLbitfield flags = 0;
+		for (;;) {
+			const GLenum status = glClientWaitSync(sync, flags, 1000000);
+			if (status != GL_TIMEOUT_EXPIRED) break;
+			flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		}
+		glDeleteSync(sync);
+		sync = nullptr;
+	}
+	return mapped + segment * segmentBytes;
+}
+
+
+GLint VertexRing::unmap(const size_t bytes, const size_t stride)
+{
+	switch (current) {
+	case UploadStrategy::PersistentMapped:
+		//	Coherent mapping, the writes are visible to the next draw without a flush
+		return static_cast<GLint>(segment * segmentBytes / stride);
+
+	case UploadStrategy::Orphaning:
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(segmentBytes), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(bytes), staging.data());
+		return 0;
+
+	default:
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(bytes), staging.data(), GL_DYNAMIC_DRAW);
+		return 0;
+	}
+}
+
+
+void VertexRing::fence()
+{
+	if (current != UploadStrategy::PersistentMapped) return;
+
+	fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	segment = (segment + 1) % SEGMENTS;
+}
+
+
+void VertexRing::release()
+{
+	for (GLsync& sync : fences) {
+		if (sync) glDeleteSync(sync);
+		sync = nullptr;
+	}
+	segment = 0;
+	staging.clear();
+
+	if (mapped) {
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		mapped = nullptr;
+	}
+}
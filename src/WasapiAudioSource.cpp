@@ -0,0 +1,201 @@
+#include "../include/WasapiAudioSource.h"
+
+#include <mmreg.h>
+
+#include <iostream>
+
+WasapiAudioSource::WasapiAudioSource()
+{
+	// Contains high for failure, low for success
+	HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	THROW_ON_ERROR(hr, "Unable to initialize COM library in WasapiAudioSource()");
+
+	// Create instance of COM object in pEnumerator
+	hr = CoCreateInstance(
+		CLSID_MMDeviceEnumerator, nullptr,
+		CLSCTX_ALL, IID_IMMDeviceEnumerator,
+		reinterpret_cast<void **>(&pEnumerator));
+	THROW_ON_ERROR(hr, "Unable to Initialize pEnumerator in WasapiAudioSource()")
+
+
+	// Get the default audio output (eRender for out)
+	hr = pEnumerator->GetDefaultAudioEndpoint(
+		eRender, eConsole, &pDevice);
+
+	//	If there is no audio device (in the case of running CI tests)
+	if (FAILED(hr)) {
+		std::cerr << "GetDefaultAudioEndpoint failed, hr = 0x"
+			<< std::hex << hr << std::dec << "\n";
+		validAudioDevice = false;
+		return;
+	}
+
+
+	// Get the audio client interface and store in pAudioClient
+	hr = pDevice->Activate(
+		IID_IAudioClient, CLSCTX_ALL,
+		nullptr, reinterpret_cast<void **>(&pAudioClient));
+	THROW_ON_ERROR(hr, "Unable to get audio client in WasapiAudioSource()")
+
+
+	// Get the format for the audio stream
+	hr = pAudioClient->GetMixFormat(&pwfx);
+	THROW_ON_ERROR(hr, "Unable to get mix format in WasapiAudioSource()")
+
+
+	// Initialize the client
+	// LOOPBACK flag allows for listening to the audio being played
+	// EVENTCALLBACK lets the capture thread sleep until the engine has a buffer for us
+	hr = pAudioClient->Initialize(
+		AUDCLNT_SHAREMODE_SHARED,
+		AUDCLNT_STREAMFLAGS_LOOPBACK | AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+		hnsRequestedDuration,
+		0,
+		pwfx,
+		nullptr);
+	THROW_ON_ERROR(hr, "Unable to initialize audio client in WasapiAudioSource()")
+
+
+	bufferReadyEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (!bufferReadyEvent) throw std::runtime_error("Unable to create buffer event in WasapiAudioSource()");
+
+	hr = pAudioClient->SetEventHandle(bufferReadyEvent);
+	THROW_ON_ERROR(hr, "Unable to set event handle in WasapiAudioSource()")
+
+
+	// Get the capture client to actually listen
+	hr = pAudioClient->GetService(
+		IID_IAudioCaptureClient,
+		reinterpret_cast<void **>(&pCaptureClient));
+	THROW_ON_ERROR(hr, "Unable to get capture client in WasapiAudioSource()");
+
+
+	// Start recording audio
+	hr = pAudioClient->Start();
+	THROW_ON_ERROR(hr, "Unable to start audio client in WasapiAudioSource()");
+}
+
+
+WasapiAudioSource::~WasapiAudioSource() noexcept
+{
+	if (pAudioClient) pAudioClient->Stop();
+
+	// Release all memory
+	if (pCaptureClient) {
+		pCaptureClient->Release();
+		pCaptureClient = nullptr;
+	}
+	if (pAudioClient) {
+		pAudioClient->Release();
+		pAudioClient = nullptr;
+	}
+	if (pDevice) {
+		pDevice->Release();
+		pDevice = nullptr;
+	}
+	if (pEnumerator) {
+		pEnumerator->Release();
+		pEnumerator = nullptr;
+	}
+	if (pwfx) {
+		CoTaskMemFree(pwfx);
+		pwfx = nullptr;
+	}
+	if (bufferReadyEvent) {
+		CloseHandle(bufferReadyEvent);
+		bufferReadyEvent = nullptr;
+	}
+}
+
+
+AudioFormat WasapiAudioSource::format() const
+{
+	AudioFormat fmt;
+	if (!pwfx) return fmt;
+
+	fmt.sampleRate = pwfx->nSamplesPerSec;
+	fmt.channels = pwfx->nChannels;
+
+	//	Extensible formats carry the real format tag in the first field of the sub format GUID
+	WORD tag = pwfx->wFormatTag;
+	if (tag == WAVE_FORMAT_EXTENSIBLE)
+		tag = static_cast<WORD>(reinterpret_cast<const WAVEFORMATEXTENSIBLE*>(pwfx)->SubFormat.Data1);
+
+	if (tag == WAVE_FORMAT_IEEE_FLOAT) fmt.sampleFormat = SampleFormat::Float32;
+	else if (pwfx->wBitsPerSample == 16) fmt.sampleFormat = SampleFormat::Int16;
+	else if (pwfx->wBitsPerSample == 24) fmt.sampleFormat = SampleFormat::Int24;
+	else fmt.sampleFormat = SampleFormat::Int32;
+
+	return fmt;
+}
+
+
+bool WasapiAudioSource::acquirePacket(AudioPacket& packet)
+{
+	if (!pCaptureClient) return false;
+
+	BYTE* pData = nullptr;
+	DWORD flags = 0;
+	UINT64 qpcPosition = 0;
+
+	// Get the current audio buffer, with the performance counter time of its first frame
+	const HRESULT hr = pCaptureClient->GetBuffer(&pData, &framesHeld, &flags, nullptr, &qpcPosition);
+	if (FAILED(hr))
+	{
+		std::cerr << "hr failed with code: " << hr << std::endl;
+		THROW_ON_ERROR(hr, "Failed to get buffer");
+	}
+
+	//	Nothing captured since the last packet
+	if (hr == AUDCLNT_S_BUFFER_EMPTY || framesHeld == 0) {
+		framesHeld = 0;
+		return false;
+	}
+
+	packet.data = reinterpret_cast<const std::byte*>(pData);
+	packet.frames = framesHeld;
+
+	// Flags is a bitfield returned by buffer, Bitwise AND to check for silence
+	packet.silent = (flags & AUDCLNT_BUFFERFLAGS_SILENT) != 0;
+
+	//	The position is in 100ns units of QueryPerformanceCounter, which steady_clock also counts from zero
+	//	on Windows, so it converts directly. The stamp is moved on to the newest frame of the packet.
+	if (qpcPosition && !(flags & AUDCLNT_BUFFERFLAGS_TIMESTAMP_ERROR)) {
+		const auto newest = std::chrono::nanoseconds(qpcPosition * 100 + (framesHeld - 1ull) * 1000000000ull / pwfx->nSamplesPerSec);
+		packet.captureTime = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(newest));
+	}
+	else packet.captureTime = std::chrono::steady_clock::now();
+	return true;
+}
+
+
+void WasapiAudioSource::releasePacket()
+{
+	// Let windows know youre done reading from the buffer so it can overwrite
+	if (pCaptureClient && framesHeld > 0)
+		pCaptureClient->ReleaseBuffer(framesHeld);
+	framesHeld = 0;
+}
+
+
+bool WasapiAudioSource::waitForPacket(const std::chrono::milliseconds timeout)
+{
+	if (!bufferReadyEvent) return false;
+
+	//	Older Windows builds never signal the event for loopback streams, the timeout
+	//	turns that into plain polling so the capture thread still drains the buffer
+	return WaitForSingleObject(bufferReadyEvent, static_cast<DWORD>(timeout.count())) == WAIT_OBJECT_0;
+}
+
+
+void WasapiAudioSource::onCaptureThreadStart()
+{
+	//	The capture client lives in the multithreaded apartment, join it from this thread too
+	CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+}
+
+
+void WasapiAudioSource::onCaptureThreadStop()
+{
+	CoUninitialize();
+}
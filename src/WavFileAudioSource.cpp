@@ -0,0 +1,245 @@
+#include "../include/WavFileAudioSource.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ----------------------------------------------------
+// Helpers
+// ----------------------------------------------------
+
+static uint16_t readU16(const std::byte* p)
+{
+	uint16_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static uint32_t readU32(const std::byte* p)
+{
+	uint32_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static bool tagEquals(const std::byte* p, const char* tag)
+{
+	return std::memcmp(p, tag, 4) == 0;
+}
+
+constexpr uint16_t WAV_FORMAT_PCM = 0x0001;
+constexpr uint16_t WAV_FORMAT_FLOAT = 0x0003;
+constexpr uint16_t WAV_FORMAT_EXTENSIBLE = 0xFFFE;
+
+// ----------------------------------------------------
+// WavFileAudioSource
+// ----------------------------------------------------
+
+WavFileAudioSource::WavFileAudioSource(const std::string& path, const uint32_t packetFrames, const bool loop)
+	: packetFrames(packetFrames), loop(loop)
+{
+	if (packetFrames == 0) throw std::invalid_argument("WavFileAudioSource needs a non-zero packet size");
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Unable to open wav file: " + path);
+	fileHandle = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		unmap();
+		throw std::runtime_error("Unable to size wav file: " + path);
+	}
+	mappingSize = static_cast<size_t>(size.QuadPart);
+
+	HANDLE map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!map) {
+		unmap();
+		throw std::runtime_error("Unable to map wav file: " + path);
+	}
+	mappingHandle = map;
+
+	mapping = static_cast<const std::byte*>(MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0));
+#else
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) throw std::runtime_error("Unable to open wav file: " + path);
+
+	struct stat st {};
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		throw std::runtime_error("Unable to size wav file: " + path);
+	}
+	mappingSize = static_cast<size_t>(st.st_size);
+
+	void* p = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);	//	The mapping keeps the file alive
+	if (p != MAP_FAILED) {
+		mapping = static_cast<const std::byte*>(p);
+		madvise(p, mappingSize, MADV_SEQUENTIAL);
+	}
+#endif
+
+	if (!mapping) {
+		unmap();
+		throw std::runtime_error("Unable to map wav file: " + path);
+	}
+
+	try {
+		parseHeader();
+	}
+	catch (...) {
+		unmap();
+		throw;
+	}
+}
+
+
+WavFileAudioSource::~WavFileAudioSource()
+{
+	unmap();
+}
+
+
+void WavFileAudioSource::parseHeader()
+{
+	if (mappingSize < 12 || !tagEquals(mapping, "RIFF") || !tagEquals(mapping + 8, "WAVE"))
+		throw std::runtime_error("Not a RIFF/WAVE file");
+
+	bool haveFormat = false;
+	size_t offset = 12;
+
+	//	Walk the chunk list, chunks are word aligned
+	while (offset + 8 <= mappingSize) {
+		const std::byte* chunk = mapping + offset;
+		const uint32_t chunkSize = readU32(chunk + 4);
+		const std::byte* body = chunk + 8;
+		const size_t available = mappingSize - offset - 8;
+
+		if (tagEquals(chunk, "fmt ")) {
+			if (chunkSize < 16 || available < 16) throw std::runtime_error("Truncated wav fmt chunk");
+
+			uint16_t tag = readU16(body);
+			const uint16_t channels = readU16(body + 2);
+			const uint32_t sampleRate = readU32(body + 4);
+			const uint16_t bits = readU16(body + 14);
+
+			//	Extensible headers keep the real format tag in the first two bytes of the sub format GUID
+			if (tag == WAV_FORMAT_EXTENSIBLE) {
+				if (chunkSize < 40 || available < 40) throw std::runtime_error("Truncated extensible wav header");
+				tag = readU16(body + 24);
+			}
+
+			if (tag == WAV_FORMAT_FLOAT && bits == 32) fmt.sampleFormat = SampleFormat::Float32;
+			else if (tag == WAV_FORMAT_PCM && bits == 16) fmt.sampleFormat = SampleFormat::Int16;
+			else if (tag == WAV_FORMAT_PCM && bits == 24) fmt.sampleFormat = SampleFormat::Int24;
+			else if (tag == WAV_FORMAT_PCM && bits == 32) fmt.sampleFormat = SampleFormat::Int32;
+			else throw std::runtime_error("Unsupported wav sample format");
+
+			if (channels == 0 || sampleRate == 0) throw std::runtime_error("Invalid wav channel count or sample rate");
+
+			fmt.channels = channels;
+			fmt.sampleRate = sampleRate;
+			haveFormat = true;
+		}
+		else if (tagEquals(chunk, "data")) {
+			if (!haveFormat) throw std::runtime_error("wav data chunk before fmt chunk");
+
+			//	Tolerate writers that leave the size unpatched or truncate the file
+			const size_t dataBytes = std::min<size_t>(chunkSize, available);
+			frameData = body;
+			totalFrames = dataBytes / fmt.bytesPerFrame();
+			return;
+		}
+
+		offset += 8 + static_cast<size_t>(chunkSize) + (chunkSize & 1);
+	}
+
+	throw std::runtime_error("wav file has no data chunk");
+}
+
+
+AudioPacket WavFileAudioSource::frames(const uint64_t first, const uint32_t count) const
+{
+	AudioPacket packet;
+	if (first >= totalFrames) return packet;
+
+	packet.data = frameData + first * fmt.bytesPerFrame();
+	packet.frames = static_cast<uint32_t>(std::min<uint64_t>(count, totalFrames - first));
+	return packet;
+}
+
+
+bool WavFileAudioSource::acquirePacket(AudioPacket& packet)
+{
+	if (cursor >= totalFrames) {
+		if (!loop || totalFrames == 0) return false;
+		cursor = 0;
+	}
+
+	//	The last packet of the file can be short, pace it by the frames it really has
+	const AudioPacket next = frames(cursor, packetFrames);
+	if (realtime) {
+		if (!pacer.ready(next.frames, fmt.sampleRate)) return false;
+		pacer.advance(next.frames);
+	}
+
+	packet = next;
+	packet.captureTime = realtime ? pacer.releasedUntil(fmt.sampleRate) : std::chrono::steady_clock::now();
+	cursor += packet.frames;
+	return packet.frames > 0;
+}
+
+
+bool WavFileAudioSource::waitForPacket(const std::chrono::milliseconds timeout)
+{
+	if (!realtime) return true;
+
+	pacer.waitUntilReady(packetFrames, fmt.sampleRate, timeout);
+	return pacer.ready(packetFrames, fmt.sampleRate);
+}
+
+
+void WavFileAudioSource::setRealtime(const bool enabled)
+{
+	realtime = enabled;
+	pacer.reset();
+}
+
+
+void WavFileAudioSource::onCaptureThreadStart()
+{
+	realtimeBeforeCapture = realtime;
+	if (!realtime) setRealtime(true);
+}
+
+
+void WavFileAudioSource::onCaptureThreadStop()
+{
+	if (!realtimeBeforeCapture) setRealtime(false);
+}
+
+
+void WavFileAudioSource::unmap() noexcept
+{
+#ifdef _WIN32
+	if (mapping) UnmapViewOfFile(mapping);
+	if (mappingHandle) CloseHandle(mappingHandle);
+	if (fileHandle) CloseHandle(fileHandle);
+#else
+	if (mapping) munmap(const_cast<std::byte*>(mapping), mappingSize);
+#endif
+	mapping = nullptr;
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+	mappingSize = 0;
+}
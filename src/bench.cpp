@@ -1,12 +1,18 @@
 //Main loop for visualization
 
 #include "../include/AudioManager.h"
+#include "../include/MicroBenchmarks.h"
+#include "../include/PerformanceManager.h"
 
-#include "ImGui.h"
+#include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 
+#include <cctype>
 #include <chrono>   //  For running bench timer
+#include <cstring>
+#include <string>
+#include <tuple>
 
 using namespace std;
 
@@ -14,9 +20,44 @@ static GLFWwindow* createWindow(int, int);
 static void toggleFullscreen(GLFWwindow*, bool);
 static void error_callback(int, const char*);
 static void processInput(GLFWwindow*);
+static std::string reportLabel(const std::string&);
 
 
-int main() {
+int main(int argc, char** argv) {
+    const auto launch = std::chrono::steady_clock::now();
+
+    //  Headless micro benchmarks, no window or audio device needed
+    if (argc > 1 && std::strcmp(argv[1], "--micro") == 0) {
+        runSampleRingBenchmark(cout);
+        runFftBenchmark(cout);
+        runFftEngineBenchmark(cout);
+        runMagnitudeKernelBenchmark(cout);
+        return EXIT_SUCCESS;
+    }
+
+    //  Frame time against bar count instead of the mode sweep
+    const bool barSweep = argc > 1 && std::strcmp(argv[1], "--bars") == 0;
+    const unsigned int sweepBarCounts[] = { 16, 64, 256, 512, 1024, MAX_BAR_COUNT };
+    size_t sweepIndex = 0;
+
+    //  CPU time spent on the vertex upload per strategy, the old glBufferData path first as the baseline
+    const bool uploadSweep = argc > 1 && std::strcmp(argv[1], "--upload") == 0;
+    const UploadStrategy sweepStrategies[] = { UploadStrategy::BufferData, UploadStrategy::Orphaning, UploadStrategy::PersistentMapped };
+
+    //  Geometry shader against instanced quads and the fullscreen shader, in every mode
+    const bool pathSweep = argc > 1 && std::strcmp(argv[1], "--paths") == 0;
+    const std::pair<RenderPath, unsigned int> sweepPaths[] = {
+        { RenderPath::GeometryShader, DEFAULT_M }, { RenderPath::Instanced, DEFAULT_M },
+        { RenderPath::GeometryShader, SYMMETRIC_M }, { RenderPath::Instanced, SYMMETRIC_M },
+        { RenderPath::GeometryShader, DOUBLE_SYM_M }, { RenderPath::Instanced, DOUBLE_SYM_M },
+        { RenderPath::Fullscreen, DEFAULT_M }, { RenderPath::Fullscreen, SYMMETRIC_M }, { RenderPath::Fullscreen, DOUBLE_SYM_M }
+    };
+
+    //  Launch to first presented frame. "--startup --cold" empties the program binary cache first,
+    //  run it once cold and once without to compare
+    const bool startupRun = argc > 1 && std::strcmp(argv[1], "--startup") == 0;
+    const bool coldStart = startupRun && argc > 2 && std::strcmp(argv[2], "--cold") == 0;
+
     // Create the audio manager
     AudioManager am;
 
@@ -40,8 +81,13 @@ int main() {
 
     //  Set up openGL
     GLuint VBO, VAO;
+    if (uploadSweep) am.setUploadStrategy(sweepStrategies[0]);
+    if (coldStart) am.getProgramCache().clear();
     am.openGLInit(VBO, VAO);
 
+    //  Capture and FFT run on their own thread from here on
+    am.startCapture();
+
     ////////// Setup Dear ImGui context
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -60,11 +106,20 @@ int main() {
     bool first = true;
 
 
-    //  Benchmarking vars
-    std::vector<std::chrono::duration<float>> renderTimes;
-    renderTimes.reserve(1000);
+    //  Benchmarking vars. Each sweep step writes benchmarks/out/<label>.json, compare two runs with BenchCompare
+    PerformanceManager pm;
+    auto averageRenderTime = [&pm] {
+        return std::chrono::duration<float>(std::chrono::duration<double, std::nano>(pm.getRenderTimeHistogram().mean()));
+    };
+    auto writeReport = [&](const std::string& label) {
+        pm.setRunInfo({ FFT_COUNT, am.getSourceFormat().sampleRate, am.getBarCount(), modes[am.settings.modeIndex],
+                        RENDER_PATH_NAMES[static_cast<int>(am.settings.renderPath)] });
+        pm.writePerformanceData(reportLabel(label));
+    };
     int iterations = 0;
     am.settings.smoothing = false;
+    if (barSweep) am.settings.barCount = sweepBarCounts[0];
+    if (pathSweep) std::tie(am.settings.renderPath, am.settings.modeIndex) = sweepPaths[0];
 
 
     //Main Loop
@@ -82,21 +137,50 @@ int main() {
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        auto st = std::chrono::high_resolution_clock::now();
-        am.RenderAudio(w, VBO, VAO);
-        auto en = std::chrono::high_resolution_clock::now();
+        //  Frames 100 to 10,100 of every step are measured, the first ones warm up caches and drivers
+        const bool measured = iterations > 100 && iterations < 10100;
+        if (measured) pm.startRenderTimer();
+        am.RenderAudio(w, VAO);
+        if (measured) pm.stopRenderTimer();
+
+        if (iterations == 100) {
+            am.resetUploadTime();
+            pm.resetTimers();
+        }
+
+        if (barSweep && iterations > 10100) {
+            const auto sum = averageRenderTime();
+            cout << "Average per frame render time for 10,000 frames with " << am.getBarCount() << " bars:\t" << sum << endl;
+            writeReport("bars-" + std::to_string(am.getBarCount()));
+            if (++sweepIndex == std::size(sweepBarCounts)) return EXIT_SUCCESS;
+
+            am.settings.barCount = sweepBarCounts[sweepIndex];
+            iterations = 0;
+        }
+
+        else if (pathSweep && iterations > 10100) {
+            const auto sum = averageRenderTime();
+            cout << "Average per frame render time for 10,000 frames, " << RENDER_PATH_NAMES[static_cast<int>(am.settings.renderPath)] << " mode " << modes[am.settings.modeIndex] << ":\t" << sum << endl;
+            writeReport(std::string("path-") + RENDER_PATH_NAMES[static_cast<int>(am.settings.renderPath)] + "-" + modes[am.settings.modeIndex]);
+            if (++sweepIndex == std::size(sweepPaths)) return EXIT_SUCCESS;
+
+            std::tie(am.settings.renderPath, am.settings.modeIndex) = sweepPaths[sweepIndex];
+            iterations = 0;
+        }
 
-        auto frameDuration = en - st;
-        //cout << "Frame Duration:\t" << frameDuration << endl;
-        if (iterations > 100 && iterations < 10100)
-            renderTimes.push_back(frameDuration);
+        else if (uploadSweep && iterations > 10100) {
+            //  A persistent mapping request without buffer storage reports as orphaning
+            cout << "Average per frame upload time for 10,000 frames with " << UPLOAD_STRATEGY_NAMES[static_cast<int>(am.uploadStrategy())] << ":\t" << am.getAverageUploadTime() << endl;
+            writeReport(std::string("upload-") + UPLOAD_STRATEGY_NAMES[static_cast<int>(am.uploadStrategy())]);
+            if (++sweepIndex == std::size(sweepStrategies)) return EXIT_SUCCESS;
+
+            am.setUploadStrategy(sweepStrategies[sweepIndex]);
+            iterations = 0;
+        }
 
         else if (iterations > 10100) {
-            std::chrono::duration<float> sum(0);
-            for (const auto i : renderTimes) {
-                sum += i;
-            }
-            sum /= renderTimes.size();
+            const auto sum = averageRenderTime();
+            writeReport(std::string("mode-") + modes[am.settings.modeIndex] + (am.settings.smoothing ? "-smoothing" : ""));
             cout << "Average per frame render time for 10,000 frames with mode";
 
 
@@ -127,7 +211,6 @@ int main() {
             cout << "Switching modes..." << endl;
 
             iterations = 0;
-            renderTimes.clear();
         }
         iterations++;
 
@@ -139,12 +222,7 @@ int main() {
         }
 
         ImGui::ColorEdit3("Background Color", am.settings.baseColor);
-        if (ImGui::ColorEdit3("Bar Color", am.settings.barColor)) {
-            glUseProgram(am.getDefaultShader());
-            glUniform4f(am.getColorLocation1(), am.settings.barColor[0], am.settings.barColor[1], am.settings.barColor[2], am.settings.barColor[3]);
-            glUseProgram(am.getSymmetricShader());
-            glUniform4f(am.getColorLocation2(), am.settings.barColor[0], am.settings.barColor[1], am.settings.barColor[2], am.settings.barColor[3]);
-        }
+        ImGui::ColorEdit3("Bar Color", am.settings.barColor);
 
         if (ImGui::BeginCombo("Mode", modes[am.settings.modeIndex])) {
             for (int i = 0; i < IM_ARRAYSIZE(modes); i++) {
@@ -176,6 +254,15 @@ int main() {
 
         glfwPollEvents();
         glfwSwapBuffers(w);
+        if (measured) pm.recordLatency(am.spectrumCaptureTime());
+
+        if (startupRun) {
+            glFinish();
+            const auto startup = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - launch);
+            cout << (coldStart ? "Cold" : "Warm") << " start to first frame:\t" << startup << " ("
+                 << am.getProgramCache().hits() << " programs loaded, " << am.getProgramCache().misses() << " linked)" << endl;
+            break;
+        }
     }
 
     ImGui_ImplOpenGL3_Shutdown();
@@ -187,6 +274,19 @@ int main() {
 }
 
 
+//  "Double Symetric" -> "double-symetric", report file names stay portable
+static std::string reportLabel(const std::string& name)
+{
+    std::string label;
+    for (const char c : name) {
+        if (std::isalnum(static_cast<unsigned char>(c))) label += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        else if (!label.empty() && label.back() != '-') label += '-';
+    }
+    while (!label.empty() && label.back() == '-') label.pop_back();
+    return label;
+}
+
+
 static GLFWwindow* createWindow(int w, int h)
 {
     glfwSetErrorCallback(error_callback);
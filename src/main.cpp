@@ -4,8 +4,9 @@
 #include "../include/PerformanceManager.h"
 
 #include <chrono>
+#include <cstring>
 
-#include <ImGui.h>
+#include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 
@@ -29,7 +30,13 @@ static ImGuiSettings GuiSettings = {
 };
 
 
-int main() {
+int main(int argc, char** argv) {
+    const auto launch = FPSclock::now();
+
+    //  "--trace" records the pipeline timeline from launch, F9 writes it out (benchmarks/out/trace.trace.json)
+    if (argc > 1 && std::strcmp(argv[1], "--trace") == 0) Profiler::setTracing(true);
+    Profiler::setThreadName("render");
+
     // Create the audio manager
     AudioManager am;
 
@@ -55,6 +62,9 @@ int main() {
     GLuint VBO, VAO;
     am.openGLInit(VBO, VAO);
 
+    //  Capture and FFT run on their own thread from here on
+    am.startCapture();
+
     ////////// Setup Dear ImGui context
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -75,16 +85,25 @@ int main() {
     //  Performance Metrics
     chrono::microseconds frameTime(0);
     chrono::microseconds averageFrameTime(0);
+    chrono::microseconds p99FrameTime(0);
+    chrono::microseconds averageLatency(0);
+    chrono::microseconds p99Latency(0);
+    vector<ZoneStats> zones;
     PerformanceManager pm;
     unsigned long long frameCount = 0;
+    bool traceKeyHeld = false;
 
     //Main Loop
     while (!glfwWindowShouldClose(w)) {
-        if (frameCount % 500 == 0)
-            pm.startFrameTimer();
+        pm.startFrameTimer();
 
         processInput(w);
 
+        //  Written on the press only, holding the key writes one trace
+        const bool traceKey = glfwGetKey(w, GLFW_KEY_F9) == GLFW_PRESS;
+        if (traceKey && !traceKeyHeld && pm.tracing()) pm.writeTrace();
+        traceKeyHeld = traceKey;
+
         glfwGetFramebufferSize(w, &am.settings.windowWidth, &am.settings.windowHeight);
         glViewport(0, 0, am.settings.windowWidth,am.settings.windowHeight);
 
@@ -96,7 +115,7 @@ int main() {
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        am.RenderAudio(w, VBO, VAO);
+        am.RenderAudio(w, VAO);
 
         // render GUI
         ImGui::Begin("AudioViz Menu");
@@ -106,30 +125,8 @@ int main() {
         }
 
         ImGui::ColorEdit3("Background Color", am.settings.baseColor);
-        if (ImGui::ColorEdit3("Bar Color", am.settings.barColor)) {
-            const auto state = am.settings.modeIndex;
-
-            glUseProgram(am.getDefaultShader());
-            glUniform4f(am.getColorLocation1(), am.settings.barColor[0], am.settings.barColor[1],
-                        am.settings.barColor[2], am.settings.barColor[3]);
-            glUseProgram(am.getSymmetricShader());
-            glUniform4f(am.getColorLocation2(), am.settings.barColor[0], am.settings.barColor[1],
-                        am.settings.barColor[2], am.settings.barColor[3]);
-            glUseProgram(am.getDoubleSymmetricShader());
-            glUniform4f(am.getColorLocation3(), am.settings.barColor[0], am.settings.barColor[1],
-                        am.settings.barColor[2], am.settings.barColor[3]);
-
-            switch (state) {
-            case SYMMETRIC_M:
-                glUseProgram(am.getSymmetricShader());
-                break;
-            case DOUBLE_SYM_M:
-                glUseProgram(am.getDoubleSymmetricShader());
-                break;
-            default:
-                glUseProgram(am.getDefaultShader());
-            }
-        }
+        // Picked up by the shared uniform block on the next frame
+        ImGui::ColorEdit3("Bar Color", am.settings.barColor);
         
         if (ImGui::BeginCombo("Mode", modes[am.settings.modeIndex])) {
             for (int i = 0; i < IM_ARRAYSIZE(modes); i++) {
@@ -148,11 +145,99 @@ int main() {
             if (ImGui::SliderInt("Smoothing Amount", &SmoothingAmt, 1, 5)) {
                 am.UpdateSmoothing(SmoothingAmt);
             }
+            if (am.settings.renderPath == RenderPath::GeometryShader)    //  The feedback pass writes geometry shader vertices
+                ImGui::Checkbox("GPU Smoothing", &am.settings.gpuSmoothing);
+            else
+                ImGui::TextDisabled("GPU Smoothing needs the Geometry Shader render path");
         }
 
 
         ImGui::SliderFloat("Bar Height", &am.settings.barHeightScale, 0.0f, 2.0f);
 
+        // Bar count, auto follows the window width
+        static bool autoBars = am.settings.barCount == BAR_COUNT_AUTO;
+        if (ImGui::Checkbox("Auto Bar Count", &autoBars))
+            am.settings.barCount = autoBars ? BAR_COUNT_AUTO : am.getBarCount();
+        if (!autoBars) {
+            int bars = static_cast<int>(am.settings.barCount);
+            if (ImGui::SliderInt("Bar Count", &bars, MIN_BAR_COUNT, MAX_BAR_COUNT))
+                am.settings.barCount = static_cast<unsigned int>(bars);
+        }
+
+        if (ImGui::BeginCombo("Render Path", RENDER_PATH_NAMES[static_cast<int>(am.settings.renderPath)])) {
+            for (int i = 0; i < IM_ARRAYSIZE(RENDER_PATH_NAMES); i++) {
+                const bool is_selected = (static_cast<int>(am.settings.renderPath) == i);
+                if (ImGui::Selectable(RENDER_PATH_NAMES[i], is_selected))
+                    am.settings.renderPath = static_cast<RenderPath>(i);
+                if (is_selected)
+                    ImGui::SetItemDefaultFocus();
+            }
+
+            ImGui::EndCombo();
+        }
+
+        if (ImGui::BeginCombo("Bar Spacing", BAR_SCALE_NAMES[static_cast<int>(am.settings.barScale)])) {
+            for (int i = 0; i < IM_ARRAYSIZE(BAR_SCALE_NAMES); i++) {
+                const bool is_selected = (static_cast<int>(am.settings.barScale) == i);
+                if (ImGui::Selectable(BAR_SCALE_NAMES[i], is_selected))
+                    am.settings.barScale = static_cast<BarScale>(i);
+                if (is_selected)
+                    ImGui::SetItemDefaultFocus();
+            }
+
+            ImGui::EndCombo();
+        }
+
+        // Analysis window, Hann by default
+        static int windowIndex = static_cast<int>(WindowType::Hann);
+        if (ImGui::BeginCombo("FFT Window", WINDOW_NAMES[windowIndex])) {
+            for (int i = 0; i < static_cast<int>(WINDOW_TYPE_COUNT); i++) {
+                const bool is_selected = (windowIndex == i);
+                if (ImGui::Selectable(WINDOW_NAMES[i], is_selected)) {
+                    windowIndex = i;
+                    am.setWindow(static_cast<WindowType>(i));
+                }
+                if (is_selected)
+                    ImGui::SetItemDefaultFocus();
+            }
+
+            ImGui::EndCombo();
+        }
+
+        // Linear FFT bins or constant-Q bins, both feed the same bars
+        static int analysisIndex = static_cast<int>(SpectrumAnalysis::Fft);
+        if (ImGui::BeginCombo("Analysis", SPECTRUM_ANALYSIS_NAMES[analysisIndex])) {
+            for (int i = 0; i < IM_ARRAYSIZE(SPECTRUM_ANALYSIS_NAMES); i++) {
+                const bool is_selected = (analysisIndex == i);
+                if (ImGui::Selectable(SPECTRUM_ANALYSIS_NAMES[i], is_selected)) {
+                    analysisIndex = i;
+                    am.setAnalysis(static_cast<SpectrumAnalysis>(i));
+                }
+                if (is_selected)
+                    ImGui::SetItemDefaultFocus();
+            }
+
+            ImGui::EndCombo();
+        }
+
+        // Window overlap of the STFT, more overlap means more spectra per second
+        static const char* overlaps[] = { "0%", "50%", "75%" };
+        static const uint32_t hops[] = { FFT_COUNT, FFT_COUNT / 2, FFT_COUNT / 4 };
+        static int overlapIndex = 1;
+        if (ImGui::BeginCombo("FFT Overlap", overlaps[overlapIndex])) {
+            for (int i = 0; i < IM_ARRAYSIZE(overlaps); i++) {
+                const bool is_selected = (overlapIndex == i);
+                if (ImGui::Selectable(overlaps[i], is_selected)) {
+                    overlapIndex = i;
+                    am.setStftHop(hops[i]);
+                }
+                if (is_selected)
+                    ImGui::SetItemDefaultFocus();
+            }
+
+            ImGui::EndCombo();
+        }
+
         ImGui::End();
 
         if (GuiSettings.perfOverlay){
@@ -163,25 +248,67 @@ int main() {
 
             ImGui::Text("Average FPS: %d", calculateFPS(static_cast<unsigned long long>(averageFrameTime.count())));
             ImGui::Text("Average Frame time: %dus", static_cast<unsigned long long>(averageFrameTime.count()));
+            ImGui::Text("p99 Frame time: %lluus", static_cast<unsigned long long>(p99FrameTime.count()));
+            ImGui::Text("Audio to screen: %lluus (p99 %lluus)", static_cast<unsigned long long>(averageLatency.count()),
+                        static_cast<unsigned long long>(p99Latency.count()));
+
+            const RenderStats& renderStats = am.getRenderManager().lastFrame();
+            ImGui::Text("GL binds: %u program, %u VAO, %u uniform", renderStats.programBinds,
+                        renderStats.vertexArrayBinds, renderStats.uniformUploads);
+            ImGui::Text("GL calls saved: %u", renderStats.saved());
+
+            bool tracing = pm.tracing();
+            if (ImGui::Checkbox("Record trace (F9 writes it)", &tracing))
+                pm.setTracing(tracing);
+
+            // Mean time per call of each PROFILE_ZONE, over every thread
+            if (ImGui::CollapsingHeader("Zones")) {
+                for (const ZoneStats& zone : zones)
+                    ImGui::Text("%-10s %8.1fus  (%u threads)", zone.name, zone.meanNs() / 1000.0, zone.threads);
+            }
 
             ImGui::End();
         }
 
         // Render dear imgui into screen
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            PROFILE_ZONE("imgui");
+            ImGui::Render();
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
 
 
         glfwPollEvents();
-        glfwSwapBuffers(w);
+        {
+            PROFILE_ZONE("swap");
+            glfwSwapBuffers(w);
+        }
+        //  From the newest sample in the spectrum on screen to the swap
+        pm.recordLatency(am.spectrumCaptureTime());
+        if (frameCount == 0) {
+            const auto startup = chrono::duration_cast<chrono::milliseconds>(FPSclock::now() - launch);
+            cout << "Start to first frame: " << startup.count() << "ms (" << am.getProgramCache().hits()
+                 << " programs from the shader cache, " << am.getProgramCache().misses() << " linked)\n";
+        }
+        //  Every frame is recorded, the overlay only refreshes every 500th so it stays readable
+        const chrono::microseconds lastFrameTime = pm.stopFrameTimer();
         if (frameCount % 500 == 0) {
-            frameTime = pm.stopFrameTimer();
+            frameTime = lastFrameTime;
             averageFrameTime = pm.getAverageFrameTime();
+            p99FrameTime = chrono::duration_cast<chrono::microseconds>(chrono::nanoseconds(pm.getFrameTimeHistogram().percentile(99.0)));
+            averageLatency = pm.getAverageLatency();
+            p99Latency = chrono::duration_cast<chrono::microseconds>(chrono::nanoseconds(pm.getLatencyHistogram().percentile(99.0)));
+            zones = pm.getZones();
         }
 
         frameCount++;
     }
 
+    //  The session report (benchmarks/out/session.json) is written when pm goes out of scope
+    const unsigned int fftSize = am.analysis() == SpectrumAnalysis::ConstantQ ? static_cast<unsigned int>(CQT_FFT_SIZE) : FFT_COUNT;
+    pm.setRunInfo({ fftSize, am.getSourceFormat().sampleRate, am.getBarCount(), modes[am.settings.modeIndex],
+                    RENDER_PATH_NAMES[static_cast<int>(am.settings.renderPath)] });
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
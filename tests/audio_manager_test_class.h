@@ -9,17 +9,13 @@ class AudioManagerTest : public ::testing::Test {
 	void SetUp() override {
 		//	Assert that AM was constructed correctly
 		ASSERT_FALSE(am.magnitudes.empty());
-		ASSERT_TRUE(am.prevMagnitudes.empty());
+		ASSERT_TRUE(am.prevBarHeights.empty());
 
 		ASSERT_EQ(am.getDefaultShader(), 0);
 		ASSERT_EQ(am.getSymmetricShader(), 0);
 		ASSERT_EQ(am.getDoubleSymmetricShader(), 0);
 		
-		ASSERT_EQ(am.getColorLocation1(), 0);
-		ASSERT_EQ(am.getColorLocation2(), 0);
-		ASSERT_EQ(am.getColorLocation3(), 0);
-		ASSERT_EQ(am.getBarCountUniform1(), 0);
-		ASSERT_EQ(am.getBarCountUniform2(), 0);
-		ASSERT_EQ(am.getBarCountUniform3(), 0);
+		ASSERT_FALSE(am.renderManager.ready());
+		ASSERT_EQ(am.renderManager.uniformBufferName(), 0);
 	}
 };
\ No newline at end of file
@@ -0,0 +1,316 @@
+//	Tests the device independent audio sources and runs them through the real FFT path
+
+#include "../include/AudioManager.h"
+#include "../include/SyntheticAudioSource.h"
+#include "../include/WavFileAudioSource.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+//	Writes a minimal RIFF/WAVE file with a 16 byte fmt chunk
+static void writeWav(const std::filesystem::path& path, uint16_t tag, uint16_t channels, uint32_t rate,
+	uint16_t bits, const void* data, uint32_t bytes)
+{
+	std::ofstream out(path, std::ios::binary);
+	auto u16 = [&](uint16_t v) { out.write(reinterpret_cast<const char*>(&v), 2); };
+	auto u32 = [&](uint32_t v) { out.write(reinterpret_cast<const char*>(&v), 4); };
+
+	out.write("RIFF", 4); u32(36 + bytes); out.write("WAVE", 4);
+	out.write("fmt ", 4); u32(16); u16(tag); u16(channels); u32(rate);
+	u32(rate * channels * bits / 8); u16(channels * bits / 8); u16(bits);
+	out.write("data", 4); u32(bytes);
+	out.write(static_cast<const char*>(data), bytes);
+}
+
+
+TEST(AudioSourceTest, syntheticSineTest) {
+	//	A sine sitting exactly on bin 20 should put the spectral peak there
+	constexpr int bin = 20;
+	SyntheticSignal signal;
+	signal.waveform = Waveform::Sine;
+	signal.frequency = 48000.0f / FFT_COUNT * bin;
+
+	AudioManager am(std::make_unique<SyntheticAudioSource>(signal, AudioFormat{48000, 2, SampleFormat::Float32}, FFT_COUNT));
+	ASSERT_TRUE(am.hasValidAudioDevice());
+
+	for (int i = 0; i < 4; i++)
+		if (am.getAudioSample())
+			am.vectorizeMagnitudes();
+
+	const auto peak = std::max_element(am.magnitudes.begin(), am.magnitudes.end());
+	EXPECT_EQ(std::distance(am.magnitudes.begin(), peak), bin);
+}
+
+
+TEST(AudioSourceTest, syntheticDeterminismTest) {
+	SyntheticSignal signal;
+	signal.waveform = Waveform::Noise;
+	signal.seed = 1234;
+
+	SyntheticAudioSource a(signal), b(signal);
+	AudioPacket pa, pb;
+	for (int i = 0; i < 8; i++) {
+		ASSERT_TRUE(a.acquirePacket(pa));
+		ASSERT_TRUE(b.acquirePacket(pb));
+		ASSERT_EQ(pa.frames, pb.frames);
+		EXPECT_EQ(std::memcmp(pa.data, pb.data, pa.frames * a.format().bytesPerFrame()), 0);
+		a.releasePacket();
+		b.releasePacket();
+	}
+
+	signal.waveform = Waveform::Silence;
+	SyntheticAudioSource silent(signal);
+	ASSERT_TRUE(silent.acquirePacket(pa));
+	EXPECT_TRUE(pa.silent);
+}
+
+
+TEST(AudioSourceTest, wavFileTest) {
+	const auto path = std::filesystem::temp_directory_path() / "audiovis_wav_test.wav";
+
+	//	Stereo float, 1000 frames of a ramp
+	std::vector<float> samples(2000);
+	for (size_t i = 0; i < samples.size(); i++) samples[i] = static_cast<float>(i) / 2000.0f;
+	writeWav(path, 3, 2, 44100, 32, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(float)));
+
+	{
+		WavFileAudioSource wav(path.string(), 256, false);
+		ASSERT_TRUE(wav.isValid());
+		EXPECT_EQ(wav.format().sampleRate, 44100u);
+		EXPECT_EQ(wav.format().channels, 2);
+		EXPECT_EQ(wav.format().sampleFormat, SampleFormat::Float32);
+		EXPECT_EQ(wav.frameCount(), 1000u);
+
+		//	Packets are spans into the file, the last one is short and then the stream ends
+		uint64_t frames = 0;
+		AudioPacket packet;
+		while (wav.acquirePacket(packet)) {
+			const auto* f = reinterpret_cast<const float*>(packet.data);
+			EXPECT_FLOAT_EQ(f[0], samples[frames * 2]);
+			frames += packet.frames;
+			wav.releasePacket();
+		}
+		EXPECT_EQ(frames, 1000u);
+
+		const AudioPacket span = wav.frames(990, 100);
+		EXPECT_EQ(span.frames, 10u);
+	}
+
+	{
+		//	Played in realtime and looped, the short last packet only moves the stamps on by its own frames
+		WavFileAudioSource wav(path.string(), 256, true);
+		wav.setRealtime(true);
+
+		std::vector<AudioPacket> packets;
+		AudioPacket packet;
+		while (packets.size() < 5) {
+			wav.waitForPacket(std::chrono::milliseconds(20));
+			if (!wav.acquirePacket(packet)) continue;
+			packets.push_back(packet);
+			wav.releasePacket();
+		}
+		ASSERT_EQ(packets[3].frames, 1000u - 3 * 256);
+
+		const auto framesBetween = [](const AudioPacket& a, const AudioPacket& b) {
+			return std::chrono::duration<double>(b.captureTime - a.captureTime).count() * 44100.0;
+		};
+		EXPECT_NEAR(framesBetween(packets[0], packets[3]), 1000.0 - 256.0, 0.5);
+		EXPECT_NEAR(framesBetween(packets[3], packets[4]), 256.0, 0.5);
+	}
+
+	//	16 bit PCM header
+	std::vector<int16_t> pcm(480, 1000);
+	writeWav(path, 1, 1, 48000, 16, pcm.data(), static_cast<uint32_t>(pcm.size() * sizeof(int16_t)));
+	{
+		WavFileAudioSource wav(path.string());
+		EXPECT_EQ(wav.format().sampleFormat, SampleFormat::Int16);
+		EXPECT_EQ(wav.frameCount(), 480u);
+	}
+
+	std::filesystem::remove(path);
+	EXPECT_THROW(WavFileAudioSource(path.string()), std::runtime_error);
+}
+
+
+TEST(AudioSourceTest, captureThreadTest) {
+	//	Realtime synthetic source, the capture thread should keep publishing spectra on its own
+	constexpr int bin = 12;
+	SyntheticSignal signal;
+	signal.frequency = 48000.0f / FFT_COUNT * bin;
+
+	auto source = std::make_unique<SyntheticAudioSource>(signal, AudioFormat{48000, 2, SampleFormat::Float32}, 240);
+	source->setRealtime(true);
+
+	AudioManager am(std::move(source));
+	am.startCapture();
+	ASSERT_TRUE(am.isCapturing());
+
+	bool gotSpectrum = false;
+	for (int i = 0; i < 200 && !gotSpectrum; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		gotSpectrum = am.consumeLatestSpectrum();
+	}
+	ASSERT_TRUE(gotSpectrum);
+	EXPECT_GT(am.captureThread->packetsCaptured(), 0u);
+
+	am.stopCapture();
+	EXPECT_FALSE(am.isCapturing());
+
+	const auto peak = std::max_element(am.magnitudes.begin(), am.magnitudes.end());
+	EXPECT_EQ(std::distance(am.magnitudes.begin(), peak), bin);
+}
+
+
+TEST(AudioSourceTest, capturePacingTest) {
+	//	Left at its default (not realtime), the source must still be paced once a capture thread drives it,
+	//	or the thread spins and the ring overflows
+	AudioManager am(std::make_unique<SyntheticAudioSource>(SyntheticSignal{}, AudioFormat{48000, 2, SampleFormat::Float32}, 240));
+	const auto start = std::chrono::steady_clock::now();
+	am.startCapture();
+	ASSERT_TRUE(am.isCapturing());
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	const uint64_t packets = am.captureThread->packetsCaptured();
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	am.stopCapture();
+
+	EXPECT_EQ(am.droppedSampleCount(), 0u);
+	EXPECT_GT(packets, 0u);
+	//	200 packets a second, with a packet of slack
+	const auto expected = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() / 5;
+	EXPECT_LE(packets, static_cast<uint64_t>(expected) + 1);
+}
+
+
+TEST(AudioSourceTest, impulseLatencyTest) {
+	//	Realtime clicks four times a second. Every spectrum has to carry the time the pacer released the
+	//	newest sample of its window, wherever and whenever the analysis thread got to it, so the spectra
+	//	a click shows up in are stamped at most one window after that click was due.
+	constexpr uint32_t rate = 48000;
+	constexpr uint64_t period = rate / 4;
+	SyntheticSignal signal;
+	signal.waveform = Waveform::Impulse;
+	signal.frequency = 4.0f;
+	signal.amplitude = 8.0f;		//	Flat spectrum of magnitude 8, log magnitudes only show what is above 1
+
+	auto source = std::make_unique<SyntheticAudioSource>(signal, AudioFormat{ rate, 2, SampleFormat::Float32 }, 240);
+	SyntheticAudioSource& clicks = *source;
+	AudioManager am(std::move(source));
+	am.setWindow(WindowType::Rectangular);		//	Hann would hide a click at the edge of a window
+
+	//	Frame k of the source is due (k + 1) / rate after the pacer starts
+	const auto before = std::chrono::steady_clock::now();
+	clicks.setRealtime(true);
+	const auto after = std::chrono::steady_clock::now();
+	const double slack = std::chrono::duration<double>(after - before).count() * rate + 1.0;
+	am.startCapture();
+
+	int edges = 0;
+	bool heard = false;
+	uint64_t spectra = 0;
+	while (std::chrono::steady_clock::now() - before < std::chrono::milliseconds(650)) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		if (!am.consumeLatestSpectrum()) continue;
+		spectra++;
+
+		//	Latency as the render loop sees it, never negative and nowhere near the click period
+		const auto latency = std::chrono::steady_clock::now() - am.spectrumCaptureTime();
+		EXPECT_GE(latency.count(), 0);
+		EXPECT_LT(latency, std::chrono::milliseconds(200));
+
+		const bool click = std::any_of(am.magnitudes.begin(), am.magnitudes.end(), [](const float m) { return m > 0.0f; });
+		if (click) {
+			//	A window that holds click P ends after P and at most a window later
+			const double frame = std::chrono::duration<double>(am.spectrumCaptureTime() - before).count() * rate;
+			const double sinceClick = std::fmod(frame, static_cast<double>(period));
+			EXPECT_GE(frame, 0.0);
+			EXPECT_LE(sinceClick, FFT_COUNT + slack) << "spectrum stamped " << sinceClick << " frames after a click";
+		}
+		edges += click && !heard;
+		heard = click;
+	}
+	am.stopCapture();
+
+	EXPECT_GT(spectra, 20u);
+	EXPECT_GE(edges, 2);
+}
+
+
+TEST(AudioSourceTest, multichannelPcmTest) {
+	//	24 bit 5.1 file with the sine on the front left channel only, previously rejected as non-float
+	constexpr int bin = 30;
+	constexpr uint16_t channels = 6;
+	constexpr uint32_t frames = FFT_COUNT * 4;
+
+	std::vector<uint8_t> pcm(frames * channels * 3, 0);
+	for (uint32_t i = 0; i < frames; i++) {
+		const auto v = static_cast<int32_t>(4000000.0 * std::sin(2.0 * 3.14159265358979 * bin * i / FFT_COUNT));
+		for (int b = 0; b < 3; b++) pcm[i * channels * 3 + b] = static_cast<uint8_t>((static_cast<uint32_t>(v) >> (8 * b)) & 0xff);
+	}
+
+	const auto path = std::filesystem::temp_directory_path() / "audiovis_multichannel_test.wav";
+	writeWav(path, 1, channels, 48000, 24, pcm.data(), static_cast<uint32_t>(pcm.size()));
+
+	{
+		AudioManager am(std::make_unique<WavFileAudioSource>(path.string(), FFT_COUNT, false));
+		ASSERT_TRUE(am.hasValidAudioDevice());
+
+		while (am.getAudioSample())
+			am.vectorizeMagnitudes();
+
+		const auto peak = std::max_element(am.magnitudes.begin(), am.magnitudes.end());
+		EXPECT_EQ(std::distance(am.magnitudes.begin(), peak), bin);
+	}
+
+	std::filesystem::remove(path);
+}
+
+
+//	Hands out a fixed list of mono float packets, a packet with no samples is a silent one
+class ScriptedSource : public AudioSource {
+public:
+	explicit ScriptedSource(std::vector<std::vector<float>> packets) : packets(std::move(packets)) {}
+
+	[[nodiscard]] AudioFormat format() const override { return { 48000, 1, SampleFormat::Float32 }; }
+
+	bool acquirePacket(AudioPacket& packet) override {
+		if (next == packets.size()) return false;
+		const std::vector<float>& samples = packets[next++];
+		packet.silent = samples.empty();
+		packet.data = reinterpret_cast<const std::byte*>(packet.silent ? silence.data() : samples.data());
+		packet.frames = packet.silent ? static_cast<uint32_t>(silence.size()) : static_cast<uint32_t>(samples.size());
+		return true;
+	}
+	void releasePacket() override {}
+
+private:
+	std::vector<std::vector<float>> packets;
+	std::vector<float> silence = std::vector<float>(FFT_COUNT, 0.0f);
+	size_t next = 0;
+};
+
+
+TEST(AudioSourceTest, silentPacketTest) {
+	//	Polled without a capture thread, silence still has to reach the ring like it does on the capture
+	//	thread, or the first window after it still holds the audio from before
+	const auto sine = [](const int bin, const size_t frames) {
+		std::vector<float> samples(frames);
+		for (size_t i = 0; i < frames; i++) samples[i] = static_cast<float>(std::sin(6.283185307179586 * bin * static_cast<double>(i) / FFT_COUNT));
+		return samples;
+	};
+
+	AudioManager am(std::make_unique<ScriptedSource>(std::vector<std::vector<float>>{ sine(20, FFT_COUNT), sine(20, FFT_COUNT), {}, {}, sine(40, FFT_HOP) }));
+	while (am.getAudioSample())
+		am.vectorizeMagnitudes();
+
+	//	The last window is half silence, half the new tone
+	EXPECT_EQ(am.sampleRing->totalWritten(), 4u * FFT_COUNT + FFT_HOP);
+	EXPECT_GT(am.magnitudes[40], 0.0f);
+	EXPECT_LT(am.magnitudes[20], 0.5f * am.magnitudes[40]);
+}
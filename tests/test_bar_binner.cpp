@@ -0,0 +1,118 @@
+//	Tests the bin to bar weight tables
+
+#include "../include/BarBinner.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+static BarLayout makeLayout(const BarScale scale, const size_t fftSize = 480, const size_t bars = 64)
+{
+	BarLayout layout;
+	layout.binCount = fftSize / 2;
+	layout.fftSize = fftSize;
+	layout.sampleRate = 48000;
+	layout.barCount = bars;
+	layout.scale = scale;
+	return layout;
+}
+
+
+TEST(BarBinnerTest, weightTableTest) {
+	for (const BarScale scale : { BarScale::Linear, BarScale::Log, BarScale::Mel, BarScale::Octave }) {
+		BarBinner binner;
+		const BarLayout layout = makeLayout(scale, 4096);
+		ASSERT_TRUE(binner.configure(layout));
+		EXPECT_FALSE(binner.configure(layout));
+
+		//	Edges climb, and a flat spectrum gives flat bars since each bar averages its bins
+		const auto& edges = binner.edges();
+		ASSERT_EQ(edges.size(), layout.barCount + 1);
+		for (size_t b = 0; b < layout.barCount; b++) ASSERT_LT(edges[b], edges[b + 1]);
+
+		std::vector<float> flat(layout.binCount, 3.0f), bars(layout.barCount);
+		binner.apply(flat.data(), bars.data());
+		for (size_t b = 0; b < layout.barCount; b++)
+			ASSERT_NEAR(bars[b], 3.0f, 1e-5f) << BAR_SCALE_NAMES[static_cast<int>(scale)] << " bar " << b;
+	}
+}
+
+
+TEST(BarBinnerTest, octaveFitTest) {
+	//	Octave bands stay between minFrequency and Nyquist for any bar count, so no bar is left without
+	//	bins, and a few bars still reach well up the spectrum instead of stopping at a few kHz
+	for (const size_t fftSize : { 480, 4096 })
+		for (const size_t barCount : { 8, 16, 24, 31, 64, 100 }) {
+			BarBinner binner;
+			const BarLayout layout = makeLayout(BarScale::Octave, fftSize, barCount);
+			binner.configure(layout);
+
+			const auto& edges = binner.edges();
+			EXPECT_GE(edges.front(), 20.0f * 0.999f) << fftSize << " / " << barCount;
+			EXPECT_LE(edges.back(), 20000.0f * 1.001f) << fftSize << " / " << barCount;
+			EXPECT_GT(edges.back(), 10000.0f) << fftSize << " / " << barCount;
+
+			std::vector<float> flat(layout.binCount, 3.0f), bars(barCount);
+			binner.apply(flat.data(), bars.data());
+			for (size_t b = 0; b < barCount; b++)
+				ASSERT_NEAR(bars[b], 3.0f, 1e-5f) << fftSize << " / " << barCount << " bar " << b;
+		}
+}
+
+
+TEST(BarBinnerTest, placementTest) {
+	//	A single hot bin should land in the bar whose edges contain its frequency
+	BarBinner binner;
+	const BarLayout layout = makeLayout(BarScale::Log, 2048);
+	binner.configure(layout);
+
+	const size_t bin = 100;		//	2343.75 Hz
+	const float hz = bin * 48000.0f / 2048.0f;
+	std::vector<float> spectrum(layout.binCount, 0.0f), bars(layout.barCount);
+	spectrum[bin] = 1.0f;
+	binner.apply(spectrum.data(), bars.data());
+
+	const auto peak = std::distance(bars.begin(), std::max_element(bars.begin(), bars.end()));
+	EXPECT_LE(binner.edges()[peak], hz + 12.0f);
+	EXPECT_GE(binner.edges()[peak + 1], hz - 12.0f);
+
+	//	Log bars cover the whole spectrum, not just the bottom BAR_COUNT bins
+	EXPECT_GT(binner.edges().back(), 19000.0f);
+
+	//	Changing any part of the layout rebuilds
+	BarLayout other = layout;
+	other.barCount = 32;
+	EXPECT_TRUE(binner.configure(other));
+	EXPECT_THROW(binner.configure(makeLayout(BarScale::Log, 2048, 0)), std::invalid_argument);
+}
+
+
+TEST(BarBinnerTest, constantQAxisTest) {
+	//	24 bins per octave from 55 Hz: the bars start half a bin below the first one, a flat spectrum
+	//	still gives flat bars and a hot bin lands in the bar around its frequency
+	BarLayout layout = makeLayout(BarScale::Log);
+	layout.binCount = 200;
+	layout.binsPerOctave = 24;
+	layout.firstBinFrequency = 55.0f;
+
+	BarBinner binner;
+	ASSERT_TRUE(binner.configure(layout));
+	EXPECT_NEAR(binner.edges().front(), 55.0f * std::exp2(-0.5f / 24.0f), 0.01f);
+
+	std::vector<float> flat(layout.binCount, 2.0f), bars(layout.barCount);
+	binner.apply(flat.data(), bars.data());
+	for (size_t b = 0; b < layout.barCount; b++) ASSERT_NEAR(bars[b], 2.0f, 1e-5f) << "bar " << b;
+
+	const size_t bin = 120;		//	55 Hz * 2^5 = 1760 Hz
+	std::vector<float> spectrum(layout.binCount, 0.0f);
+	spectrum[bin] = 1.0f;
+	binner.apply(spectrum.data(), bars.data());
+	const auto peak = std::distance(bars.begin(), std::max_element(bars.begin(), bars.end()));
+	EXPECT_LE(binner.edges()[peak], 1760.0f);
+	EXPECT_GE(binner.edges()[peak + 1], 1760.0f);
+
+	layout.firstBinFrequency = 0.0f;
+	EXPECT_THROW(binner.configure(layout), std::invalid_argument);
+}
@@ -0,0 +1,26 @@
+//	Tests resolving the runtime bar count setting
+
+#include "audio_manager_test_class.h"
+
+TEST_F(AudioManagerTest, barCountTest) {
+	EXPECT_EQ(am.getBarCount(), BAR_COUNT);
+	EXPECT_EQ(am.resolveBarCount(), BAR_COUNT);
+
+	am.settings.barCount = 512;
+	EXPECT_EQ(am.resolveBarCount(), 512u);
+
+	//	Out of range requests are clamped
+	am.settings.barCount = 1;
+	EXPECT_EQ(am.resolveBarCount(), MIN_BAR_COUNT);
+	am.settings.barCount = 1 << 20;
+	EXPECT_EQ(am.resolveBarCount(), MAX_BAR_COUNT);
+
+	//	Auto follows the framebuffer width
+	am.settings.barCount = BAR_COUNT_AUTO;
+	am.settings.windowWidth = 1920;
+	EXPECT_EQ(am.resolveBarCount(), 1920 / AUTO_BAR_PIXELS);
+	am.settings.windowWidth = 3840;
+	EXPECT_EQ(am.resolveBarCount(), 3840 / AUTO_BAR_PIXELS);
+	am.settings.windowWidth = 100;
+	EXPECT_EQ(am.resolveBarCount(), MIN_BAR_COUNT);
+}
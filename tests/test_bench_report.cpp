@@ -0,0 +1,147 @@
+//	Tests the JSON benchmark reports and the comparison behind BenchCompare
+
+#include "../include/Json.h"
+#include "../include/PerformanceManager.h"
+#include "../include/ReportCompare.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+//	Report with one "render" timer whose samples all fall into the bucket topped by ns
+static JsonValue singleBucketReport(const uint64_t ns, const uint64_t count)
+{
+	JsonValue::Array buckets;
+	buckets.emplace_back(JsonValue::Array{ ns, count });
+
+	JsonValue render;
+	render.set("unit", "ns");
+	render.set("count", count);
+	render.set("buckets", std::move(buckets));
+
+	JsonValue timers;
+	timers.set("render", std::move(render));
+
+	JsonValue report;
+	report.set("format", "audiovis-perf-1");
+	report.set("timers", std::move(timers));
+	return report;
+}
+
+
+TEST(BenchReportTest, jsonRoundTripTest) {
+	const JsonValue value = JsonValue::parse(R"({ "name": "bars \"256\"\n", "list": [1, 2.5, -3e2, true, false, null], "nested": { "empty": [] } })");
+	ASSERT_TRUE(value.isObject());
+	EXPECT_EQ(value.find("name")->string(), "bars \"256\"\n");
+	ASSERT_EQ(value.find("list")->array().size(), 6u);
+	EXPECT_EQ(value.find("list")->array()[2].number(), -300.0);
+	EXPECT_TRUE(value.find("list")->array()[5].isNull());
+	EXPECT_TRUE(value.find("nested")->find("empty")->array().empty());
+	EXPECT_EQ(value.find("missing"), nullptr);
+
+	//	Keys keep their order and everything survives a write and re-parse
+	std::ostringstream out;
+	out << value;
+	std::ostringstream again;
+	again << JsonValue::parse(out.str());
+	EXPECT_EQ(out.str(), again.str());
+	EXPECT_LT(out.str().find("name"), out.str().find("nested"));
+
+	EXPECT_THROW(JsonValue::parse("{ \"open\": [1, 2 }"), std::runtime_error);
+	EXPECT_THROW(JsonValue::parse("{} trailing"), std::runtime_error);
+}
+
+
+TEST(BenchReportTest, regressionTest) {
+	const JsonValue base = singleBucketReport(1000000, 100);
+	std::ostringstream log;
+
+	EXPECT_EQ(reportPercentile(*base.find("timers")->find("render"), 99.0), 1000000.0);
+
+	//	Identical runs never regress
+	EXPECT_TRUE(compareReports(base, base, {}, log).empty());
+
+	//	10% slower trips the default 5% threshold at every percentile
+	const auto regressions = compareReports(base, singleBucketReport(1100000, 100), {}, log);
+	ASSERT_EQ(regressions.size(), 3u);
+	EXPECT_EQ(regressions[0].timer, "render");
+	EXPECT_EQ(regressions[0].baseNs, 1000000.0);
+	EXPECT_EQ(regressions[0].candidateNs, 1100000.0);
+	EXPECT_NE(log.str().find("REGRESSION"), std::string::npos);
+
+	//	but not a 20% threshold, nor a minimum delta larger than the change
+	CompareOptions loose;
+	loose.thresholdPercent = 20.0;
+	EXPECT_TRUE(compareReports(base, singleBucketReport(1100000, 100), loose, log).empty());
+	CompareOptions noisy;
+	noisy.minDeltaNs = 200000.0;
+	EXPECT_TRUE(compareReports(base, singleBucketReport(1100000, 100), noisy, log).empty());
+
+	//	Faster is never a regression
+	EXPECT_TRUE(compareReports(base, singleBucketReport(500000, 100), {}, log).empty());
+
+	//	A timer that is dropped or recorded nothing in the candidate fails once
+	JsonValue timers, renamed;
+	timers.set("draw", *base.find("timers")->find("render"));
+	renamed.set("timers", std::move(timers));
+	for (const JsonValue& candidate : { renamed, singleBucketReport(1000000, 0) }) {
+		const auto missing = compareReports(base, candidate, {}, log);
+		ASSERT_EQ(missing.size(), 1u);
+		EXPECT_EQ(missing[0].timer, "render");
+		EXPECT_TRUE(missing[0].missing);
+	}
+	EXPECT_NE(log.str().find("MISSING"), std::string::npos);
+
+	EXPECT_THROW(compareReports(JsonValue::parse("[]"), base, {}, log), std::runtime_error);
+}
+
+
+TEST(BenchReportTest, performanceReportTest) {
+	const auto directory = std::filesystem::temp_directory_path() / "AudioVisTests" / "bench-report";
+	std::filesystem::remove_all(directory);
+
+	std::filesystem::path file;
+	{
+		PerformanceManager pm;
+		pm.setOutputDirectory(directory);
+		for (int i = 0; i < 10; i++) {
+			pm.startRenderTimer();
+			pm.stopRenderTimer();
+		}
+
+		//	Nothing captured yet is not a sample
+		EXPECT_EQ(pm.recordLatency({}).count(), 0);
+		EXPECT_GE(pm.recordLatency(std::chrono::steady_clock::now() - std::chrono::milliseconds(5)).count(), 5000);
+		EXPECT_EQ(pm.getLatencyHistogram().count(), 1u);
+		file = pm.writePerformanceData("unit-test");
+	}
+	ASSERT_EQ(file, directory / "unit-test.json");
+
+	std::ifstream in(file);
+	std::stringstream text;
+	text << in.rdbuf();
+	const JsonValue report = JsonValue::parse(text.str());
+
+	EXPECT_EQ(report.find("format")->string(), "audiovis-perf-1");
+	EXPECT_EQ(report.find("label")->string(), "unit-test");
+	EXPECT_TRUE(report.find("metadata")->find("commit")->isString());
+	EXPECT_TRUE(report.find("metadata")->find("cpu")->isString());
+
+	const JsonValue* render = report.find("timers")->find("render");
+	ASSERT_NE(render, nullptr);
+	EXPECT_EQ(render->find("count")->number(), 10.0);
+	EXPECT_TRUE(render->find("percentiles")->find("99")->isNumber());
+	EXPECT_EQ(report.find("timers")->find("frame")->find("count")->number(), 0.0);
+	EXPECT_EQ(report.find("timers")->find("latency")->find("count")->number(), 1.0);
+	EXPECT_GE(report.find("timers")->find("latency")->find("min")->number(), 5e6);
+
+	//	A report compared with itself passes, the empty timers are skipped
+	std::ostringstream log;
+	EXPECT_TRUE(compareReports(report, report, {}, log).empty());
+
+	//	Nothing recorded since the report, so the destructor wrote no second one
+	EXPECT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator{}), 1);
+	std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,171 @@
+//	Tests the sparse constant-Q kernels against a direct correlation, and the constant-Q path through AudioManager
+
+#include "../include/AudioManager.h"
+#include "../include/ConstantQ.h"
+#include "../include/SyntheticAudioSource.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+constexpr double TWO_PI = 6.283185307179586;
+
+static ConstantQLayout appLayout()
+{
+	ConstantQLayout layout;
+	layout.fftSize = CQT_FFT_SIZE;
+	layout.minFrequency = CQT_MIN_FREQUENCY;
+	layout.binsPerOctave = CQT_BINS_PER_OCTAVE;
+	layout.gamma = CQT_GAMMA;
+	layout.gain = static_cast<float>(FFT_COUNT);
+	return layout;
+}
+
+
+//	Constant-Q bins of frame (fftSize samples) through the real FFT and the kernels
+static std::vector<std::complex<float>> transform(const ConstantQ& cqt, const std::vector<float>& frame)
+{
+	ConstantQFft fft;
+	std::vector<float> re(ConstantQFft::bins), im(ConstantQFft::bins), binRe(cqt.binCount()), binIm(cqt.binCount());
+	fft.forward(frame.data(), re.data(), im.data());
+	cqt.apply(re.data(), im.data(), binRe.data(), binIm.data());
+
+	std::vector<std::complex<float>> bins(cqt.binCount());
+	for (size_t k = 0; k < bins.size(); k++) bins[k] = { binRe[k], binIm[k] };
+	return bins;
+}
+
+
+static std::vector<float> sines(const std::initializer_list<double> frequencies, const double amplitude)
+{
+	std::vector<float> frame(CQT_FFT_SIZE, 0.0f);
+	for (size_t n = 0; n < frame.size(); n++)
+		for (const double f : frequencies)
+			frame[n] += static_cast<float>(amplitude * std::sin(TWO_PI * f * static_cast<double>(n) / 48000.0));
+	return frame;
+}
+
+
+TEST(ConstantQTest, kernelTest) {
+	ConstantQ cqt;
+	ASSERT_TRUE(cqt.configure(appLayout()));
+	EXPECT_FALSE(cqt.configure(appLayout()));
+
+	//	C1 to 20 kHz at 24 bins per octave
+	const auto expected = static_cast<size_t>(std::floor(24.0 * std::log2(20000.0 / CQT_MIN_FREQUENCY))) + 1;
+	ASSERT_EQ(cqt.binCount(), expected);
+	EXPECT_LE(cqt.binCount(), static_cast<size_t>(FFT_COUNT / 2));
+	EXPECT_FLOAT_EQ(cqt.binFrequency(24), 2.0f * CQT_MIN_FREQUENCY);
+
+	//	Windows shrink with frequency and the lowest one fits the FFT
+	EXPECT_LE(cqt.longestKernel(), CQT_FFT_SIZE);
+	for (size_t k = 1; k < cqt.binCount(); k++) ASSERT_LE(cqt.kernelLength(k), cqt.kernelLength(k - 1));
+
+	//	Sparse: a few percent of a dense bins x FFT bins table
+	EXPECT_LT(cqt.weightCount(), cqt.binCount() * ConstantQFft::bins / 20);
+
+	ConstantQLayout bad = appLayout();
+	bad.minFrequency = 30000.0f;
+	EXPECT_THROW(cqt.configure(bad), std::invalid_argument);
+	bad = appLayout();
+	bad.fftSize = 1001;
+	EXPECT_THROW(cqt.configure(bad), std::invalid_argument);
+}
+
+
+TEST(ConstantQTest, directCorrelationTest) {
+	//	The sparse spectral kernels should give what correlating the frame with each temporal kernel gives
+	ConstantQ cqt;
+	cqt.configure(appLayout());
+	const ConstantQLayout& layout = cqt.layout();
+	const size_t n = layout.fftSize;
+
+	std::vector<float> frame = sines({ 61.0, 440.0, 3100.0, 12345.0 }, 0.2);
+	uint32_t state = 1;
+	for (float& sample : frame) {
+		state = state * 1664525u + 1013904223u;
+		sample += 0.05f * (static_cast<float>(state >> 8) / 8388608.0f - 1.0f);
+	}
+	const std::vector<std::complex<float>> bins = transform(cqt, frame);
+
+	float largest = 0.0f;
+	for (const std::complex<float>& bin : bins) largest = std::max(largest, std::abs(bin));
+
+	for (size_t k = 0; k < cqt.binCount(); k += 7) {
+		const size_t length = cqt.kernelLength(k);
+		const double f = cqt.binFrequency(k);
+		std::complex<double> direct = 0.0;
+		for (size_t m = 0; m < length; m++) {
+			const double w = layout.gain * (0.5 - 0.5 * std::cos(TWO_PI * static_cast<double>(m) / static_cast<double>(length))) / static_cast<double>(length);
+			direct += static_cast<double>(frame[n - length + m]) * w * std::polar(1.0, -TWO_PI * f * static_cast<double>(m) / layout.sampleRate);
+		}
+		EXPECT_NEAR(std::abs(bins[k]), std::abs(direct), 0.01 * largest) << "bin " << k << " at " << f << " Hz";
+	}
+}
+
+
+TEST(ConstantQTest, sineTest) {
+	//	A sine on a bin centre peaks there at gain * amplitude / 4, like the Hann windowed FFT_COUNT FFT
+	ConstantQ cqt;
+	cqt.configure(appLayout());
+	const size_t bin = 100;
+	const std::vector<std::complex<float>> bins = transform(cqt, sines({ cqt.binFrequency(bin) }, 0.5));
+
+	std::vector<float> magnitudes(bins.size());
+	std::transform(bins.begin(), bins.end(), magnitudes.begin(), [](const std::complex<float> c) { return std::abs(c); });
+	EXPECT_EQ(std::distance(magnitudes.begin(), std::max_element(magnitudes.begin(), magnitudes.end())), static_cast<std::ptrdiff_t>(bin));
+	EXPECT_NEAR(magnitudes[bin], FFT_COUNT * 0.5f / 4.0f, 0.02f * FFT_COUNT * 0.5f / 4.0f);
+	EXPECT_LT(magnitudes[bin + 12], 0.01f * magnitudes[bin]);
+}
+
+
+TEST(ConstantQTest, resolutionTest) {
+	//	A1 and E2, 27 Hz apart, land in the same bin of the 100 Hz wide FFT_COUNT bins but are two peaks here
+	ConstantQ cqt;
+	cqt.configure(appLayout());
+	const std::vector<std::complex<float>> bins = transform(cqt, sines({ 55.0, 82.41 }, 0.5));
+
+	const auto binOf = [&](const double hz) { return static_cast<size_t>(std::lround(CQT_BINS_PER_OCTAVE * std::log2(hz / CQT_MIN_FREQUENCY))); };
+	const size_t low = binOf(55.0), high = binOf(82.41), middle = (low + high) / 2;
+	EXPECT_LT(std::abs(bins[middle]), 0.5f * std::abs(bins[low]));
+	EXPECT_LT(std::abs(bins[middle]), 0.5f * std::abs(bins[high]));
+}
+
+
+TEST(ConstantQTest, audioManagerTest) {
+	//	Switched to constant-Q, the same pipeline puts a 440 Hz sine in its constant-Q bin and bar, then back
+	SyntheticSignal signal;
+	signal.frequency = 440.0f;
+	AudioManager am(std::make_unique<SyntheticAudioSource>(signal, AudioFormat{ 48000, 2, SampleFormat::Float32 }, 480));
+	ASSERT_EQ(am.analysis(), SpectrumAnalysis::Fft);
+
+	am.setAnalysis(SpectrumAnalysis::ConstantQ);
+	ASSERT_EQ(am.analysis(), SpectrumAnalysis::ConstantQ);
+	const ConstantQ& cqt = am.getConstantQ();
+	ASSERT_GT(cqt.binCount(), 0u);
+	ASSERT_LE(cqt.binCount(), am.magnitudes.size());
+
+	for (int i = 0; i < 40; i++)
+		if (am.getAudioSample()) am.vectorizeMagnitudes();
+	ASSERT_EQ(am.consumedAnalysis, SpectrumAnalysis::ConstantQ);
+
+	const auto peak = std::distance(am.magnitudes.begin(), std::max_element(am.magnitudes.begin(), am.magnitudes.end()));
+	EXPECT_EQ(peak, std::lround(CQT_BINS_PER_OCTAVE * std::log2(440.0 / CQT_MIN_FREQUENCY)));
+	for (size_t k = cqt.binCount(); k < am.magnitudes.size(); k++) ASSERT_EQ(am.magnitudes[k], 0.0f);
+
+	//	The bars follow the constant-Q axis
+	am.binBars();
+	const auto bar = std::distance(am.barHeights.begin(), std::max_element(am.barHeights.begin(), am.barHeights.begin() + am.getBarCount()));
+	EXPECT_LE(am.barBinner.edges()[bar], 440.0f * 1.03f);
+	EXPECT_GE(am.barBinner.edges()[bar + 1], 440.0f / 1.03f);
+
+	//	Back on the FFT, 440 Hz is in the 100 Hz wide bin 4
+	am.setAnalysis(SpectrumAnalysis::Fft);
+	for (int i = 0; i < 4; i++)
+		if (am.getAudioSample()) am.vectorizeMagnitudes();
+	EXPECT_EQ(am.consumedAnalysis, SpectrumAnalysis::Fft);
+	EXPECT_EQ(std::distance(am.magnitudes.begin(), std::max_element(am.magnitudes.begin(), am.magnitudes.end())), 4);
+}
@@ -0,0 +1,68 @@
+//	Tests the N-channel downmix and sample format conversion against a plain double reference
+
+#include "../include/Downmix.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+//	Interleaved integer samples in [-fullScale, fullScale) written little-endian with the given width
+static std::vector<std::byte> packIntegers(const std::vector<int32_t>& samples, const size_t bytes)
+{
+	std::vector<std::byte> out(samples.size() * bytes);
+	for (size_t i = 0; i < samples.size(); i++)
+		for (size_t b = 0; b < bytes; b++)
+			out[i * bytes + b] = static_cast<std::byte>((static_cast<uint32_t>(samples[i]) >> (8 * b)) & 0xff);
+	return out;
+}
+
+
+static void checkFormat(const SampleFormat format, const size_t bytes, const double fullScale, const uint16_t channels)
+{
+	//	Odd frame count so the vector bodies and the scalar tails both run
+	constexpr size_t frames = 37;
+	std::mt19937 rng(channels);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+	std::vector<std::byte> raw;
+	std::vector<double> values(frames * channels);
+	if (format == SampleFormat::Float32) {
+		std::vector<float> f(values.size());
+		for (size_t i = 0; i < f.size(); i++) values[i] = f[i] = static_cast<float>(dist(rng));
+		raw.resize(f.size() * sizeof(float));
+		std::memcpy(raw.data(), f.data(), raw.size());
+	}
+	else {
+		std::vector<int32_t> ints(values.size());
+		for (size_t i = 0; i < ints.size(); i++) {
+			ints[i] = static_cast<int32_t>(dist(rng) * (fullScale - 1.0));
+			values[i] = ints[i] / fullScale;
+		}
+		//	Hit both ends of the range too
+		ints[0] = static_cast<int32_t>(-fullScale);
+		values[0] = -1.0;
+		raw = packIntegers(ints, bytes);
+	}
+
+	std::vector<float> out(frames, -99.0f);
+	downmixToMono(raw.data(), format, channels, out.data(), frames);
+
+	for (size_t i = 0; i < frames; i++) {
+		double expected = 0.0;
+		for (size_t c = 0; c < channels; c++) expected += values[i * channels + c];
+		expected /= channels;
+		ASSERT_NEAR(out[i], expected, 1e-6) << "format " << static_cast<int>(format) << ", " << channels << " channels, frame " << i;
+	}
+}
+
+
+TEST(DownmixTest, formatAndChannelTest) {
+	for (const uint16_t channels : { 1, 2, 3, 4, 6, 8 }) {
+		checkFormat(SampleFormat::Float32, 4, 1.0, channels);
+		checkFormat(SampleFormat::Int16, 2, 32768.0, channels);
+		checkFormat(SampleFormat::Int24, 3, 8388608.0, channels);
+		checkFormat(SampleFormat::Int32, 4, 2147483648.0, channels);
+	}
+}
@@ -0,0 +1,120 @@
+//	Checks the compile-time FFT engine against kissfft for every size we use
+
+#include "../include/Fft.h"
+
+extern "C" {
+#include "kiss_fft.h"
+#include "kiss_fftr.h"
+}
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+//	Largest bin error relative to the largest reference bin
+constexpr float FFT_TOLERANCE = 2e-5f;
+
+static std::vector<float> randomSignal(const size_t n, const unsigned seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	std::vector<float> v(n);
+	for (auto& x : v) x = dist(rng);
+	return v;
+}
+
+
+static float relativeError(const std::vector<kiss_fft_cpx>& ref, const float* re, const float* im, const size_t bins)
+{
+	float maxRef = 0.0f, maxErr = 0.0f;
+	for (size_t k = 0; k < bins; k++) {
+		maxRef = std::max(maxRef, std::hypot(ref[k].r, ref[k].i));
+		maxErr = std::max(maxErr, std::hypot(ref[k].r - re[k], ref[k].i - im[k]));
+	}
+	return maxErr / maxRef;
+}
+
+
+template <size_t N>
+static void checkComplex()
+{
+	const auto inRe = randomSignal(N, 1), inIm = randomSignal(N, 2);
+	std::vector<float> outRe(N), outIm(N);
+	auto fft = std::make_unique<Fft<N>>();
+	fft->forward(inRe.data(), inIm.data(), outRe.data(), outIm.data());
+
+	std::vector<kiss_fft_cpx> in(N), ref(N);
+	for (size_t i = 0; i < N; i++) in[i] = { inRe[i], inIm[i] };
+	kiss_fft_cfg cfg = kiss_fft_alloc(static_cast<int>(N), 0, nullptr, nullptr);
+	kiss_fft(cfg, in.data(), ref.data());
+	free(cfg);
+
+	EXPECT_LT(relativeError(ref, outRe.data(), outIm.data(), N), FFT_TOLERANCE) << "N = " << N;
+}
+
+
+template <size_t N>
+static void checkReal()
+{
+	const auto in = randomSignal(N, 3);
+	std::vector<float> outRe(RealFft<N>::bins), outIm(RealFft<N>::bins);
+	auto fft = std::make_unique<RealFft<N>>();
+	fft->forward(in.data(), outRe.data(), outIm.data());
+
+	std::vector<kiss_fft_cpx> ref(N / 2 + 1);
+	kiss_fftr_cfg cfg = kiss_fftr_alloc(static_cast<int>(N), 0, nullptr, nullptr);
+	kiss_fftr(cfg, in.data(), ref.data());
+	free(cfg);
+
+	EXPECT_LT(relativeError(ref, outRe.data(), outIm.data(), ref.size()), FFT_TOLERANCE) << "N = " << N;
+}
+
+
+TEST(FftTest, planTest) {
+	static_assert(fftSupportsSize(480));
+	static_assert(fftSupportsSize(8192));
+	static_assert(!fftSupportsSize(7 * 64));
+	static_assert(!fftSupportsSize(1));
+
+	constexpr FftPlan plan = makeFftPlan(480);
+	size_t product = 1;
+	for (size_t i = 0; i < plan.stages; i++) product *= plan.radices[i];
+	EXPECT_EQ(product, 480u);
+
+	//	Compile-time trig has to be close to double precision for the twiddles
+	for (double x = -20.0; x < 20.0; x += 0.01) {
+		ASSERT_NEAR(constexprSin(x), std::sin(x), 1e-12);
+		ASSERT_NEAR(constexprCos(x), std::cos(x), 1e-12);
+	}
+}
+
+
+TEST(FftTest, complexAccuracyTest) {
+	//	Every radix on its own, then the sizes the analysis uses
+	checkComplex<2>();
+	checkComplex<3>();
+	checkComplex<4>();
+	checkComplex<5>();
+	checkComplex<60>();
+	checkComplex<480>();
+	checkComplex<512>();
+	checkComplex<1024>();
+	checkComplex<2048>();
+	checkComplex<4096>();
+	checkComplex<8192>();
+}
+
+
+TEST(FftTest, realAccuracyTest) {
+	checkReal<480>();
+	checkReal<512>();
+	checkReal<1024>();
+	checkReal<2048>();
+	checkReal<4096>();
+	checkReal<8192>();
+}
@@ -0,0 +1,54 @@
+//	GPU smoothing (transform feedback) has to draw the same bars as the CPU smoothing within float tolerance
+
+#include "graphics_test_class.h"
+
+#include <algorithm>
+#include <vector>
+
+/*
+	One sequence of raw bar heights goes through the app's CPU path (smoothBars() then genMinVerts(),
+	what RenderAudio uploads) and through GpuSmoother with the same scales, and the bar vertices
+	they produce are compared frame by frame.
+*/
+
+TEST_F(GraphicsTest, gpuSmoothingTest) {
+	if (!hasWindow()) GTEST_SKIP() << "No window, the feedback pass needs a GL context";
+
+	constexpr float coef = 0.9f;
+	constexpr unsigned int bars = 64;
+	constexpr int frames = 8;
+
+	//	Rising and falling targets in every frame
+	auto target = [](const size_t bar, const int frame) {
+		return static_cast<float>((bar * 7 + static_cast<size_t>(frame) * 13) % 23) * 10.0f;
+	};
+
+	am.settings.smoothingCoef = coef;
+	am.resizeBars(bars);
+	const auto [horizScale, vertScale] = am.minVertScales();
+
+	int success;
+	GLuint shader;
+	am.compileShader(shaderSource("smoothing.vert").data(), shader, GL_VERTEX_SHADER, success);
+	ASSERT_TRUE(success);
+
+	GpuSmoother smoother;
+	ASSERT_TRUE(smoother.init(shader, bars));
+	glDeleteShader(shader);
+
+	std::vector<float> targets(bars), cpuVertices(bars * 2), gpuVertices(bars * 2);
+	for (int f = 0; f < frames; f++) {
+		for (size_t b = 0; b < bars; b++) targets[b] = target(b, f);
+
+		std::copy(targets.begin(), targets.end(), am.barHeights.begin());
+		am.smoothBars();
+		am.genMinVerts(cpuVertices.data());
+
+		smoother.run(targets.data(), bars, coef, horizScale, vertScale);
+		glBindBuffer(GL_ARRAY_BUFFER, smoother.vertexBuffer());
+		glGetBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(float) * gpuVertices.size()), gpuVertices.data());
+
+		for (size_t i = 0; i < gpuVertices.size(); i++)
+			ASSERT_NEAR(gpuVertices[i], cpuVertices[i], 1e-5f) << "frame " << f << ", bar " << i / 2;
+	}
+}
@@ -0,0 +1,63 @@
+//	Tests the log-bucketed latency histogram behind PerformanceManager
+
+#include "../include/LatencyHistogram.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+TEST(LatencyHistogramTest, statisticsTest) {
+	LatencyHistogram histogram;
+	EXPECT_EQ(histogram.count(), 0u);
+	EXPECT_EQ(histogram.percentile(50.0), 0u);
+	EXPECT_EQ(histogram.mean(), 0.0);
+
+	//	Small values have a bucket each, so everything is exact
+	for (uint64_t v = 1; v <= 100; v++) histogram.record(v);
+	EXPECT_EQ(histogram.count(), 100u);
+	EXPECT_EQ(histogram.min(), 1u);
+	EXPECT_EQ(histogram.max(), 100u);
+	EXPECT_DOUBLE_EQ(histogram.mean(), 50.5);
+	EXPECT_NEAR(histogram.stddev(), std::sqrt((100.0 * 100.0 - 1.0) / 12.0), 1e-9);
+	EXPECT_EQ(histogram.percentile(50.0), 50u);
+	EXPECT_EQ(histogram.percentile(99.0), 99u);
+	EXPECT_EQ(histogram.percentile(100.0), 100u);
+	EXPECT_EQ(histogram.percentile(0.0), 1u);
+
+	//	Out of range values are clamped, not lost
+	histogram.record(std::chrono::hours(1));
+	EXPECT_EQ(histogram.count(), 101u);
+	EXPECT_EQ(histogram.max(), LatencyHistogram::MAX_VALUE);
+
+	histogram.reset();
+	EXPECT_EQ(histogram.count(), 0u);
+	EXPECT_EQ(histogram.max(), 0u);
+}
+
+
+TEST(LatencyHistogramTest, percentileAccuracyTest) {
+	//	Frame times spread over several powers of two, percentiles within the bucket resolution of the exact ones
+	std::mt19937_64 rng(7);
+	std::lognormal_distribution<double> frameTime(std::log(4.0e6), 0.6);
+
+	LatencyHistogram histogram;
+	std::vector<uint64_t> values(100000);
+	for (uint64_t& v : values) {
+		v = static_cast<uint64_t>(frameTime(rng));
+		histogram.record(v);
+	}
+	std::sort(values.begin(), values.end());
+
+	const double resolution = 1.0 / (1 << LatencyHistogram::SUB_BUCKET_BITS);
+	for (const double p : { 1.0, 50.0, 90.0, 95.0, 99.0, 99.9 }) {
+		const uint64_t exact = values[static_cast<size_t>(std::ceil(p / 100.0 * values.size())) - 1];
+		const uint64_t reported = histogram.percentile(p);
+		EXPECT_GE(reported, exact) << "p" << p;
+		EXPECT_LE(static_cast<double>(reported - exact), static_cast<double>(exact) * resolution) << "p" << p;
+	}
+	EXPECT_EQ(histogram.min(), values.front());
+	EXPECT_EQ(histogram.max(), values.back());
+}
@@ -0,0 +1,237 @@
+//	Tests the PROFILE_ZONE counters (per thread buffers summed by snapshot()) and the trace timeline
+
+#include "../include/Json.h"
+#include "../include/PerformanceManager.h"
+#include "../include/Profiler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//	Other tests record zones too, only look at ours
+static ZoneStats findZone(const char* name)
+{
+	const std::vector<ZoneStats> zones = Profiler::snapshot();
+	const auto zone = std::find_if(zones.begin(), zones.end(), [name](const ZoneStats& z) { return std::strcmp(z.name, name) == 0; });
+	return zone == zones.end() ? ZoneStats{} : *zone;
+}
+
+
+TEST(ProfilerTest, recordTest) {
+	Profiler::reset();
+
+	//	Same name, same zone, wherever the string lives
+	const std::string copy = "test.record";
+	const uint32_t zone = Profiler::zoneIndex("test.record");
+	EXPECT_EQ(Profiler::zoneIndex(copy.c_str()), zone);
+	EXPECT_NE(Profiler::zoneIndex("test.other"), zone);
+
+	EXPECT_EQ(findZone("test.record").count, 0u);
+	for (const uint64_t ns : { 300u, 100u, 200u }) Profiler::record(zone, ns);
+
+	const ZoneStats stats = findZone("test.record");
+	EXPECT_EQ(stats.count, 3u);
+	EXPECT_EQ(stats.totalNs, 600u);
+	EXPECT_EQ(stats.minNs, 100u);
+	EXPECT_EQ(stats.maxNs, 300u);
+	EXPECT_EQ(stats.meanNs(), 200.0);
+	EXPECT_EQ(stats.threads, 1u);
+
+	//	A reset drops everything recorded before it
+	Profiler::reset();
+	EXPECT_EQ(findZone("test.record").count, 0u);
+	Profiler::record(zone, 50);
+	EXPECT_EQ(findZone("test.record").count, 1u);
+	EXPECT_EQ(findZone("test.record").maxNs, 50u);
+
+	//	Out of range zones are ignored
+	Profiler::record(static_cast<uint32_t>(Profiler::MAX_ZONES), 1);
+}
+
+
+TEST(ProfilerTest, scopedZoneTest) {
+	Profiler::reset();
+	{
+		const ProfileZone zone(Profiler::zoneIndex("test.scoped"));
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+
+	const ZoneStats stats = findZone("test.scoped");
+	EXPECT_EQ(stats.count, 1u);
+	EXPECT_GE(stats.totalNs, 2000000u);
+
+#ifdef AUDIOVIS_PROFILING
+	for (int i = 0; i < 3; i++) {
+		PROFILE_ZONE("test.macro");
+	}
+	EXPECT_EQ(findZone("test.macro").count, 3u);
+#endif
+}
+
+
+TEST(ProfilerTest, threadsTest) {
+	constexpr int threads = 4;
+	constexpr uint64_t samples = 20000;
+	Profiler::reset();
+	const uint32_t zone = Profiler::zoneIndex("test.threads");
+
+	//	Snapshots taken while the writers run never see more than was recorded
+	std::atomic<bool> done{ false };
+	std::thread reader([&] {
+		while (!done.load()) EXPECT_LE(findZone("test.threads").count, threads * samples);
+	});
+
+	//	All writers are alive together, so none of them takes over another's buffer
+	std::atomic<int> started{ 0 }, finished{ 0 };
+	std::vector<std::thread> writers;
+	for (int t = 0; t < threads; t++)
+		writers.emplace_back([&, zone, t] {
+			started.fetch_add(1);
+			while (started.load() < threads) std::this_thread::yield();
+			for (uint64_t i = 0; i < samples; i++) Profiler::record(zone, static_cast<uint64_t>(t) + 1);
+			finished.fetch_add(1);
+			while (finished.load() < threads) std::this_thread::yield();
+		});
+	for (std::thread& writer : writers) writer.join();
+	done.store(true);
+	reader.join();
+
+	//	Exited threads keep their samples
+	const ZoneStats stats = findZone("test.threads");
+	EXPECT_EQ(stats.count, threads * samples);
+	EXPECT_EQ(stats.totalNs, samples * (1 + 2 + 3 + 4));
+	EXPECT_EQ(stats.minNs, 1u);
+	EXPECT_EQ(stats.maxNs, 4u);
+	EXPECT_EQ(stats.threads, static_cast<uint32_t>(threads));
+}
+
+
+//	Trace of the thread called name, empty if it has none
+static ThreadTrace ownTrace(const char* name)
+{
+	for (ThreadTrace& trace : Profiler::collectTrace())
+		if (trace.name && std::strcmp(trace.name, name) == 0) return trace;
+	return {};
+}
+
+
+TEST(ProfilerTest, traceTest) {
+	const uint32_t zone = Profiler::zoneIndex("test.trace");
+	const auto start = Profiler::epoch() + std::chrono::microseconds(5);
+
+	//	Nothing lands on the timeline while tracing is off
+	std::thread([&] {
+		Profiler::setThreadName("test.off");
+		Profiler::record(zone, start, start + std::chrono::nanoseconds(10));
+	}).join();
+	EXPECT_TRUE(ownTrace("test.off").events.empty());
+
+	Profiler::setTracing(true);
+	ASSERT_TRUE(Profiler::tracing());
+	std::thread([&] {
+		Profiler::setThreadName("test.on");
+		for (int i = 0; i < 3; i++)
+			Profiler::record(zone, start + std::chrono::nanoseconds(100 * i), start + std::chrono::nanoseconds(100 * i + 40));
+	}).join();
+
+	const ThreadTrace trace = ownTrace("test.on");
+	ASSERT_EQ(trace.events.size(), 3u);
+	EXPECT_EQ(trace.dropped, 0u);
+	EXPECT_EQ(trace.events[2].zone, zone);
+	EXPECT_EQ(trace.events[2].startNs, 5200u);
+	EXPECT_EQ(trace.events[2].durationNs, 40u);
+	EXPECT_STREQ(Profiler::zoneName(zone), "test.trace");
+
+	//	The ring keeps the newest TRACE_CAPACITY events
+	std::thread([&] {
+		Profiler::setThreadName("test.wrap");
+		for (uint64_t i = 0; i < Profiler::TRACE_CAPACITY + 10; i++)
+			Profiler::record(zone, start + std::chrono::nanoseconds(i), start + std::chrono::nanoseconds(i + 1));
+	}).join();
+	const ThreadTrace wrapped = ownTrace("test.wrap");
+	ASSERT_EQ(wrapped.events.size(), Profiler::TRACE_CAPACITY);
+	EXPECT_EQ(wrapped.dropped, 10u);
+	EXPECT_EQ(wrapped.events.front().startNs, 5000u + 10u);
+
+	Profiler::setTracing(false);
+}
+
+
+TEST(ProfilerTest, recycleTest) {
+	//	Threads that come and go, like the capture and analysis threads on every restart, reuse the
+	//	buffers and rings of exited threads instead of adding new ones, and their samples still count
+	Profiler::reset();
+	Profiler::setTracing(true);
+	const uint32_t zone = Profiler::zoneIndex("test.recycle");
+	const auto start = Profiler::epoch();
+	const auto runThread = [&](const char* name) {
+		std::thread([&] {
+			Profiler::setThreadName(name);
+			Profiler::record(zone, start, start + std::chrono::nanoseconds(10));
+		}).join();
+	};
+
+	runThread("test.recycle");
+	const size_t buffers = Profiler::collectTrace().size();
+	for (int i = 0; i < 20; i++) runThread("test.recycle");
+	EXPECT_EQ(Profiler::collectTrace().size(), buffers);
+	EXPECT_EQ(findZone("test.recycle").count, 21u);
+
+	//	The trace of a reused buffer only holds its current thread's events
+	const ThreadTrace trace = ownTrace("test.recycle");
+	ASSERT_EQ(trace.events.size(), 1u);
+	EXPECT_EQ(trace.dropped, 0u);
+
+	Profiler::setTracing(false);
+}
+
+
+TEST(ProfilerTest, chromeTraceTest) {
+	const auto directory = std::filesystem::temp_directory_path() / "AudioVisTests" / "trace";
+	std::filesystem::remove_all(directory);
+
+	std::filesystem::path file;
+	{
+		PerformanceManager pm;
+		pm.setOutputDirectory(directory);
+		pm.setTracing(true);
+		{
+			const ProfileZone zone(Profiler::zoneIndex("test.chrome"));
+		}
+		pm.startFrameTimer();
+		pm.stopFrameTimer();
+		file = pm.writeTrace();
+		pm.setTracing(false);
+		pm.resetTimers();
+	}
+	ASSERT_EQ(file, directory / "trace.trace.json");
+
+	std::ifstream in(file);
+	std::stringstream text;
+	text << in.rdbuf();
+	const JsonValue trace = JsonValue::parse(text.str());
+
+	//	Both zones as complete events on one thread, plus its name
+	bool zone = false, frame = false, named = false;
+	for (const JsonValue& event : trace.find("traceEvents")->array()) {
+		const std::string& name = event.find("name")->string();
+		const std::string& phase = event.find("ph")->string();
+		if (phase == "M" && name == "thread_name") named = true;
+		if (phase != "X") continue;
+		EXPECT_TRUE(event.find("ts")->isNumber());
+		EXPECT_GE(event.find("dur")->number(), 0.0);
+		zone |= name == "test.chrome";
+		frame |= name == "frame";
+	}
+	EXPECT_TRUE(zone);
+	EXPECT_TRUE(frame);
+	EXPECT_TRUE(named);
+	std::filesystem::remove_all(directory);
+}
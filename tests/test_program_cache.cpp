@@ -0,0 +1,56 @@
+//	Embedded shaders and the program binary cache
+
+#include "graphics_test_class.h"
+
+#include <filesystem>
+
+TEST_F(GraphicsTest, programCacheTest) {
+	//	Every shader in shaders/ is compiled in
+	for (const char* name : { "default.vert", "default.frag", "default.geom", "symmetric.geom", "doubleSym.geom",
+		"bars.vert", "fullscreen.vert", "fullscreen.frag", "smoothing.vert" }) {
+		EXPECT_EQ(shaderSource(name).substr(0, 12), "#version 330") << name;
+	}
+	EXPECT_THROW(static_cast<void>(shaderSource("missing.frag")), std::invalid_argument);
+
+	//	The key follows the sources and the stage types
+	const std::string_view vertex = shaderSource("bars.vert"), fragment = shaderSource("default.frag");
+	const uint64_t key = ProgramCache::sourceHash({ { GL_VERTEX_SHADER, vertex }, { GL_FRAGMENT_SHADER, fragment } });
+	EXPECT_EQ(key, ProgramCache::sourceHash({ { GL_VERTEX_SHADER, vertex }, { GL_FRAGMENT_SHADER, fragment } }));
+	EXPECT_NE(key, ProgramCache::sourceHash({ { GL_VERTEX_SHADER, vertex }, { GL_FRAGMENT_SHADER, shaderSource("fullscreen.frag") } }));
+	EXPECT_NE(key, ProgramCache::sourceHash({ { GL_FRAGMENT_SHADER, vertex }, { GL_VERTEX_SHADER, fragment } }));
+
+	//	The rest needs a GL context
+	if (!hasWindow())
+	{
+		return;
+	}
+
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "AudioVisTests" / "shader-cache";
+	ProgramCache cold(directory);
+	cold.clear();
+
+	const GLuint linked = cold.link("instanced", { { GL_VERTEX_SHADER, vertex }, { GL_FRAGMENT_SHADER, fragment } });
+	ASSERT_NE(linked, 0u);
+	EXPECT_EQ(cold.hits(), 0u);
+	EXPECT_EQ(cold.misses(), 1u);
+
+	//	Same driver and sources: loaded, unless the driver offers no binary formats
+	ProgramCache warm(directory);
+	const GLuint loaded = warm.link("instanced", { { GL_VERTEX_SHADER, vertex }, { GL_FRAGMENT_SHADER, fragment } });
+	ASSERT_NE(loaded, 0u);
+	EXPECT_EQ(warm.hits(), ProgramCache::hasProgramBinary() ? 1u : 0u);
+
+	GLint success = 0;
+	glGetProgramiv(loaded, GL_LINK_STATUS, &success);
+	EXPECT_TRUE(success);
+
+	//	An edited shader misses and relinks from source
+	const GLuint relinked = warm.link("instanced", { { GL_VERTEX_SHADER, shaderSource("fullscreen.vert") }, { GL_FRAGMENT_SHADER, fragment } });
+	EXPECT_NE(relinked, 0u);
+	EXPECT_EQ(warm.misses(), ProgramCache::hasProgramBinary() ? 1u : 2u);
+
+	glDeleteProgram(linked);
+	glDeleteProgram(loaded);
+	glDeleteProgram(relinked);
+	cold.clear();
+}
@@ -0,0 +1,104 @@
+//	The render manager has to skip redundant binds and only write the uniform block when it changed
+
+#include "graphics_test_class.h"
+
+TEST_F(GraphicsTest, renderCacheTest) {
+	RenderManager rm;
+
+	//	Staging needs no context
+	const float color[4] = { 0.25f, 0.5f, 0.75f, 1.0f };
+	rm.setBaseColor(color);
+	rm.setBarCount(128);
+	rm.setMode(2);
+	rm.setFirstBar(7);
+	EXPECT_EQ(rm.uniforms().baseColor[2], 0.75f);
+	EXPECT_EQ(rm.uniforms().barCount, 128);
+	EXPECT_EQ(rm.uniforms().mode, 2);
+	EXPECT_EQ(rm.uniforms().firstBar, 7);
+	EXPECT_FALSE(rm.ready());
+
+	//	The rest needs a GL context
+	if (!hasWindow())
+	{
+		return;
+	}
+
+	GLuint vertexArray;
+	glGenVertexArrays(1, &vertexArray);
+	rm.init({});
+	ASSERT_TRUE(rm.ready());
+
+	//	init() uploaded the staged values, so an unchanged flush is skipped
+	rm.beginFrame();
+	rm.flushUniforms();
+	rm.bindVertexArray(vertexArray);
+	rm.bindVertexArray(vertexArray);
+	rm.setBarCount(256);
+	rm.flushUniforms();
+	rm.beginFrame();
+
+	const RenderStats& stats = rm.lastFrame();
+	EXPECT_EQ(stats.uniformUploads, 1u);
+	EXPECT_EQ(stats.uniformUploadsSkipped, 1u);
+	EXPECT_EQ(stats.vertexArrayBinds, 1u);
+	EXPECT_EQ(stats.vertexArrayBindsSkipped, 1u);
+	EXPECT_EQ(stats.saved(), 2u);
+
+	BarUniforms stored{};
+	glBindBuffer(GL_UNIFORM_BUFFER, rm.uniformBufferName());
+	glGetBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(stored), &stored);
+	EXPECT_EQ(stored.barCount, 256);
+	EXPECT_EQ(stored.firstBar, 7);
+
+	//	After invalidate() the next bind goes through again
+	rm.invalidate();
+	rm.bindVertexArray(vertexArray);
+	rm.beginFrame();
+	EXPECT_EQ(rm.lastFrame().vertexArrayBinds, 1u);
+
+	glBindVertexArray(0);
+	glDeleteVertexArrays(1, &vertexArray);
+}
+
+
+TEST_F(GraphicsTest, uniformBlockLayoutTest) {
+	//	Every bar shader gets the block from shaders/BarUniforms.glsl when it is embedded
+	const std::string_view block = shaderSource("bars.vert").substr(shaderSource("bars.vert").find("layout (std140) uniform BarUniforms"));
+	for (const char* name : { "bars.vert", "default.frag", "fullscreen.frag", "default.geom", "symmetric.geom", "doubleSym.geom" }) {
+		const std::string_view source = shaderSource(name);
+		EXPECT_EQ(source.find("#include"), std::string_view::npos) << name;
+		EXPECT_NE(source.find(block.substr(0, block.find("};") + 2)), std::string_view::npos) << name;
+	}
+
+	if (!hasWindow()) GTEST_SKIP() << "No window, the block layout needs a linked program";
+
+	//	What the driver makes of the block has to be the C++ struct byte for byte
+	int success;
+	GLuint vertexShader, fragmentShader;
+	am.compileShader(shaderSource("bars.vert").data(), vertexShader, GL_VERTEX_SHADER, success);
+	am.compileShader(shaderSource("default.frag").data(), fragmentShader, GL_FRAGMENT_SHADER, success);
+	const GLuint program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+	glLinkProgram(program);
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	ASSERT_TRUE(success);
+
+	const GLuint blockIndex = glGetUniformBlockIndex(program, "BarUniforms");
+	ASSERT_NE(blockIndex, GL_INVALID_INDEX);
+	GLint size = 0;
+	glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+	EXPECT_EQ(static_cast<size_t>(size), sizeof(BarUniforms));
+
+	const char* names[] = { "BaseColor", "BarCount", "Mode", "FirstBar" };
+	const size_t expected[] = { offsetof(BarUniforms, baseColor), offsetof(BarUniforms, barCount), offsetof(BarUniforms, mode), offsetof(BarUniforms, firstBar) };
+	GLuint indices[4];
+	GLint offsets[4];
+	glGetUniformIndices(program, 4, names, indices);
+	glGetActiveUniformsiv(program, 4, indices, GL_UNIFORM_OFFSET, offsets);
+	for (size_t i = 0; i < 4; i++) EXPECT_EQ(static_cast<size_t>(offsets[i]), expected[i]) << names[i];
+
+	glDeleteProgram(program);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+}
@@ -0,0 +1,95 @@
+//	Tests the lock free sample ring between the capture and analysis threads
+
+#include "../include/SpscRingBuffer.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+TEST(SpscRingBufferTest, wrapAndOverflowTest) {
+	SpscRingBuffer<float> ring(10);
+	ASSERT_EQ(ring.capacity(), 16u);		//	Rounded up to a power of two
+
+	std::vector<float> in(12), out(16);
+	std::iota(in.begin(), in.end(), 0.0f);
+
+	EXPECT_EQ(ring.push(in.data(), 12), 12u);
+	EXPECT_EQ(ring.pop(out.data(), 10), 10u);
+
+	//	This push wraps around the end of the storage
+	EXPECT_EQ(ring.push(in.data(), 12), 12u);
+	EXPECT_EQ(ring.readAvailable(), 14u);
+	EXPECT_EQ(ring.pop(out.data(), 16), 14u);
+	EXPECT_EQ(out[0], 10.0f);
+	EXPECT_EQ(out[1], 11.0f);
+	for (int i = 0; i < 12; i++)
+		EXPECT_EQ(out[i + 2], static_cast<float>(i));
+
+	//	Overfilling drops the newest samples and counts them
+	EXPECT_EQ(ring.push(in.data(), 12), 12u);
+	EXPECT_EQ(ring.push(in.data(), 12), 4u);
+	EXPECT_EQ(ring.overflowCount(), 1u);
+	EXPECT_EQ(ring.droppedCount(), 8u);
+	EXPECT_EQ(ring.writeAvailable(), 0u);
+}
+
+
+TEST(SpscRingBufferTest, spanTest) {
+	SpscRingBuffer<float> ring(8);
+
+	//	Contiguous spans stop at the wrap point
+	auto w = ring.writableSpan();
+	ASSERT_EQ(w.size(), 8u);
+	for (size_t i = 0; i < 6; i++) w[i] = static_cast<float>(i);
+	ring.commitWrite(6);
+
+	auto r = ring.readableSpan();
+	ASSERT_EQ(r.size(), 6u);
+	ring.consume(4);
+
+	w = ring.writableSpan(4);
+	EXPECT_EQ(w.size(), 2u);			//	Slots 6 and 7, the rest is at the front
+	ring.commitWrite(2);
+	w = ring.writableSpan();
+	EXPECT_EQ(w.size(), 4u);
+
+	r = ring.readableSpan(4);
+	EXPECT_EQ(r.size(), 4u);
+	EXPECT_EQ(r[0], 4.0f);
+}
+
+
+TEST(SpscRingBufferTest, twoThreadStreamTest) {
+	//	Producer and consumer on separate threads, every sample must arrive once and in order
+	constexpr uint32_t total = 1 << 18;
+	SpscRingBuffer<uint32_t> ring(1024);
+
+	std::thread producer([&] {
+		uint32_t next = 0;
+		while (next < total) {
+			auto span = ring.writableSpan();
+			if (span.empty()) std::this_thread::yield();
+			const uint32_t n = std::min<uint32_t>(static_cast<uint32_t>(span.size()), total - next);
+			for (uint32_t i = 0; i < n; i++) span[i] = next + i;
+			ring.commitWrite(n);
+			next += n;
+		}
+	});
+
+	uint32_t expected = 0;
+	bool inOrder = true;
+	std::vector<uint32_t> chunk(97);
+	while (expected < total) {
+		const size_t n = ring.pop(chunk.data(), chunk.size());
+		if (n == 0) std::this_thread::yield();
+		for (size_t i = 0; i < n; i++)
+			inOrder &= chunk[i] == expected++;
+	}
+	producer.join();
+
+	EXPECT_TRUE(inOrder);
+	EXPECT_EQ(ring.droppedCount(), 0u);
+	EXPECT_EQ(ring.totalRead(), total);
+}
@@ -13,31 +13,49 @@ TEST_F(GraphicsTest, compilationTest) {
 	int defaultVertexShaderSuccess;
 
 	GLuint vertexShader;
-	am.compileShader(fileToString("../shaders/default.vert").data(), vertexShader, GL_VERTEX_SHADER, defaultVertexShaderSuccess);
+	am.compileShader(shaderSource("default.vert").data(), vertexShader, GL_VERTEX_SHADER, defaultVertexShaderSuccess);
 
 	EXPECT_TRUE(defaultVertexShaderSuccess);
 
 	int defaultFragmentShaderSuccess;
 	GLuint fragmentShader;
-	am.compileShader(fileToString("../shaders/default.frag").data(), fragmentShader, GL_FRAGMENT_SHADER, defaultFragmentShaderSuccess);
+	am.compileShader(shaderSource("default.frag").data(), fragmentShader, GL_FRAGMENT_SHADER, defaultFragmentShaderSuccess);
 
 	EXPECT_TRUE(defaultFragmentShaderSuccess);
 
 	int doubleSymGeomShaderSuccess;
 	GLuint symGeomShader;
-	am.compileShader(fileToString("../shaders/symmetric.geom").data(), symGeomShader, GL_GEOMETRY_SHADER, doubleSymGeomShaderSuccess);
+	am.compileShader(shaderSource("symmetric.geom").data(), symGeomShader, GL_GEOMETRY_SHADER, doubleSymGeomShaderSuccess);
 
 	EXPECT_TRUE(doubleSymGeomShaderSuccess);
 
 	int defaultGeomShaderSuccess;
 	GLuint defGeomShader;
-	am.compileShader(fileToString("../shaders/default.geom").data(), defGeomShader, GL_GEOMETRY_SHADER, defaultGeomShaderSuccess);
+	am.compileShader(shaderSource("default.geom").data(), defGeomShader, GL_GEOMETRY_SHADER, defaultGeomShaderSuccess);
 
 	EXPECT_TRUE(defaultGeomShaderSuccess);
 
 	int doublySymGeomShaderSuccess;
 	GLuint dblSymGeomShader;
-	am.compileShader(fileToString("../shaders/doubleSym.geom").data(), dblSymGeomShader, GL_GEOMETRY_SHADER, doublySymGeomShaderSuccess);
+	am.compileShader(shaderSource("doubleSym.geom").data(), dblSymGeomShader, GL_GEOMETRY_SHADER, doublySymGeomShaderSuccess);
 
 	EXPECT_TRUE(doublySymGeomShaderSuccess);
+
+	int barsVertexShaderSuccess;
+	GLuint barsVertexShader;
+	am.compileShader(shaderSource("bars.vert").data(), barsVertexShader, GL_VERTEX_SHADER, barsVertexShaderSuccess);
+
+	EXPECT_TRUE(barsVertexShaderSuccess);
+
+	int fullscreenVertexShaderSuccess;
+	GLuint fullscreenVertexShader;
+	am.compileShader(shaderSource("fullscreen.vert").data(), fullscreenVertexShader, GL_VERTEX_SHADER, fullscreenVertexShaderSuccess);
+
+	EXPECT_TRUE(fullscreenVertexShaderSuccess);
+
+	int fullscreenFragmentShaderSuccess;
+	GLuint fullscreenFragmentShader;
+	am.compileShader(shaderSource("fullscreen.frag").data(), fullscreenFragmentShader, GL_FRAGMENT_SHADER, fullscreenFragmentShaderSuccess);
+
+	EXPECT_TRUE(fullscreenFragmentShaderSuccess);
 }
\ No newline at end of file
@@ -14,8 +14,9 @@ TEST_F(AudioManagerTest, silenceTest) {
 	}
 
 	//	Fill the sample wtih all 0's, should output all 0 magnitudes
-	std::fill(am.visualData.begin(), am.visualData.end(), kiss_fft_cpx(0,0));
-	std::fill(am.accumulator.begin(), am.accumulator.end(), 0.0f);
+	std::fill(am.spectrumRe.begin(), am.spectrumRe.end(), 0.0f);
+	std::fill(am.spectrumIm.begin(), am.spectrumIm.end(), 0.0f);
+	am.sampleRing->consume(am.sampleRing->readAvailable());
 	am.vectorizeMagnitudes();
 
 	ASSERT_FALSE(am.magnitudes.empty());
@@ -27,18 +28,19 @@ TEST_F(AudioManagerTest, silenceTest) {
 	ASSERT_TRUE(allZero);
 
 
-	//	Set the smoothing and make sure the prevMangitudes is storing the correct data
+	//	Set the smoothing and make sure the previous bar heights store the correct data
 	//	These should be all zeros because we just filled with 0's
 	am.settings.smoothing = true;
 
 	if (am.hasValidAudioDevice())
 		am.getAudioSample();
 	am.vectorizeMagnitudes();
-	am.smoothMagnitudes();
+	am.binBars();
+	am.smoothBars();
 
-	ASSERT_FALSE(am.prevMagnitudes.empty());
+	ASSERT_FALSE(am.prevBarHeights.empty());
 	allZero = true;
-	for (const auto i : am.prevMagnitudes)
+	for (const auto i : am.prevBarHeights)
 		if (!(i < 0.0f + FLT_EPSILON && i > 0.0f - FLT_EPSILON))
 			allZero = false;
 
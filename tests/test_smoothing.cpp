@@ -1,4 +1,4 @@
-//	This will test the smoothing function smoothMagnitudes() from AudioManager
+//	This will test the bar smoothing function smoothBars() from AudioManager
 
 #include "audio_manager_test_class.h"
 #include <ranges>
@@ -16,33 +16,33 @@ TEST_F(AudioManagerTest, smoothingTest) {
 	auto allEqOne = [](float x) { return (x == 1.0f); };
 
 	//	Fill sample with all zeros
-	std::fill(am.magnitudes.begin(), am.magnitudes.end(), 0.0f);
+	std::fill(am.barHeights.begin(), am.barHeights.end(), 0.0f);
 
 	//	Run the smoothing algo
-	am.smoothMagnitudes();
+	am.smoothBars();
 
 	//	The previous magnitudes should all be zero now
 	//	Check exact equality - all the 0.0f's should be passed straight through
-	ASSERT_FALSE(am.magnitudes.empty());
-	ASSERT_FALSE(am.prevMagnitudes.empty());
-	ASSERT_TRUE(std::ranges::all_of(am.prevMagnitudes, allEqZero));
+	ASSERT_FALSE(am.barHeights.empty());
+	ASSERT_FALSE(am.prevBarHeights.empty());
+	ASSERT_TRUE(std::ranges::all_of(am.prevBarHeights, allEqZero));
 
 	//	Input all 1's into magnitudes
-	std::fill(am.magnitudes.begin(), am.magnitudes.end(), 1.0f);
-	am.smoothMagnitudes();
+	std::fill(am.barHeights.begin(), am.barHeights.end(), 1.0f);
+	am.smoothBars();
 
 	//	Make sure all magnitudes are EXACTLY equal to 1 - this means were NOT smoothing increasing values
-	ASSERT_TRUE(std::ranges::all_of(am.magnitudes, allEqOne));
+	ASSERT_TRUE(std::ranges::all_of(am.barHeights, allEqOne));
 
 	//	Input new data that's DECREASING (0's)
-	std::fill(am.magnitudes.begin(), am.magnitudes.end(), 0.0f);
-	am.smoothMagnitudes();
+	std::fill(am.barHeights.begin(), am.barHeights.end(), 0.0f);
+	am.smoothBars();
 
 	//	Now the magnitudes should be SOMEWHERE between 0 and 1, but NOT equal to either
-	ASSERT_TRUE(std::ranges::all_of(am.magnitudes, [](float x) { return (x < 1.0f && x > 0.0f);} ));
+	ASSERT_TRUE(std::ranges::all_of(am.barHeights, [](float x) { return (x < 1.0f && x > 0.0f);} ));
 
 	//	Test increasing magnitudes again
-	std::fill(am.magnitudes.begin(), am.magnitudes.end(), 1.0f);
-	am.smoothMagnitudes();
-	ASSERT_TRUE(std::ranges::all_of(am.magnitudes, allEqOne));
+	std::fill(am.barHeights.begin(), am.barHeights.end(), 1.0f);
+	am.smoothBars();
+	ASSERT_TRUE(std::ranges::all_of(am.barHeights, allEqOne));
 }
\ No newline at end of file
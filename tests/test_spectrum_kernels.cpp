@@ -0,0 +1,57 @@
+//	Accuracy of the vectorised log magnitude kernel against libm
+
+#include "../include/SpectrumKernels.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+TEST(SpectrumKernelTest, fastLog2Test) {
+	//	The documented bounds: the polynomial alone over every float in [1, 2), then many binades
+	for (float x = 1.0f; x < 2.0f; x = std::nextafter(x, 2.0f))
+		ASSERT_NEAR(fastLog2(x), std::log2(static_cast<double>(x)), 1.5e-5) << x;
+	for (float x = 1e-20f; x < 1e20f; x *= 1.0137f)
+		ASSERT_NEAR(fastLog2(x), std::log2(static_cast<double>(x)), 2e-5) << x;
+
+	for (int e = -126; e < 128; e++)
+		ASSERT_FLOAT_EQ(fastLog2(std::ldexp(1.0f, e)), static_cast<float>(e));
+
+	//	No -inf for silence, it lands well below any sensible floor instead
+	EXPECT_LT(fastLog2(0.0f), -100.0f);
+	EXPECT_TRUE(std::isfinite(fastLog2(0.0f)));
+}
+
+
+TEST(SpectrumKernelTest, logMagnitudesTest) {
+	//	Odd count so the vector body and the scalar tail both run
+	constexpr size_t count = 241;
+	constexpr float scale = 108.0f;
+
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> exponent(-10.0f, 20.0f), phase(0.0f, 6.2831853f);
+
+	std::vector<float> re(count), im(count), out(count);
+	for (size_t i = 0; i < count; i++) {
+		const float magnitude = std::exp2(exponent(rng));
+		re[i] = magnitude * std::cos(phase(rng));
+		im[i] = magnitude * std::sin(phase(rng));
+	}
+	re[3] = im[3] = 0.0f;
+
+	logMagnitudes(re.data(), im.data(), out.data(), count, scale);
+
+	for (size_t i = 0; i < count; i++) {
+		const double reference = scale * std::max(0.0, std::log2(std::hypot(double(re[i]), double(im[i]))));
+		ASSERT_NEAR(out[i], reference, scale * 2e-5) << "bin " << i;
+	}
+
+	//	Zero bins hit the floor exactly rather than -inf
+	EXPECT_EQ(out[3], 0.0f);
+
+	//	A floor below zero keeps quiet bins
+	logMagnitudes(re.data(), im.data(), out.data(), count, 1.0f, -4.0f);
+	EXPECT_EQ(out[3], -4.0f);
+}
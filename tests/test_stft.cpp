@@ -0,0 +1,67 @@
+//	Tests the sliding window framing of the STFT stage
+
+#include "../include/Stft.h"
+#include "../include/AudioManager.h"
+#include "../include/SyntheticAudioSource.h"
+
+#include <gtest/gtest.h>
+
+
+TEST(StftTest, overlapFramingTest) {
+	//	Ramp through a small ring so windows straddle the wrap point
+	SpscRingBuffer<float> ring(16);
+	Stft stft(8, 2);
+	EXPECT_FLOAT_EQ(stft.overlap(), 0.75f);
+
+	std::vector<float> frame(8);
+	float next = 0.0f;
+	uint64_t frames = 0;
+	for (int round = 0; round < 20; round++) {
+		while (ring.writeAvailable() > 0) {
+			ring.push(&next, 1);
+			next += 1.0f;
+		}
+
+		while (stft.nextFrame(ring, frame.data())) {
+			//	Window k starts at sample k * hop
+			for (size_t i = 0; i < frame.size(); i++)
+				ASSERT_FLOAT_EQ(frame[i], static_cast<float>(frames * 2 + i));
+			frames++;
+		}
+
+		//	Less than a window left, nothing was consumed past it
+		EXPECT_LT(ring.readAvailable(), 8u);
+	}
+
+	//	Every sample is consumed once, only the tail of the last window is left over
+	EXPECT_EQ(ring.totalRead(), frames * 2);
+	EXPECT_EQ(ring.totalRead() + ring.readAvailable(), ring.totalWritten());
+}
+
+
+TEST(StftTest, hopTest) {
+	EXPECT_THROW(Stft(0, 1), std::invalid_argument);
+	EXPECT_THROW(Stft(8, 0), std::invalid_argument);
+	EXPECT_THROW(Stft(8, 9), std::invalid_argument);
+
+	//	Spectra come out once per hop regardless of packet size
+	for (const uint32_t hop : { static_cast<uint32_t>(FFT_COUNT), static_cast<uint32_t>(FFT_COUNT / 2), static_cast<uint32_t>(FFT_COUNT / 4) }) {
+		AudioManager am(std::make_unique<SyntheticAudioSource>(SyntheticSignal{}, AudioFormat{}, 100));
+		am.setStftHop(hop);
+
+		int spectra = 0;
+		for (int i = 0; i < 48; i++) {
+			ASSERT_TRUE(am.getAudioSample());
+			am.vectorizeMagnitudes();
+		}
+		while (am.analyseNextBlock(am.magnitudes)) spectra++;
+
+		//	4800 samples were captured, vectorizeMagnitudes already drained them
+		EXPECT_EQ(spectra, 0);
+		EXPECT_EQ(am.sampleRing->totalRead(), static_cast<uint64_t>((4800 - FFT_COUNT) / hop + 1) * hop);
+	}
+
+	AudioManager am(std::make_unique<SyntheticAudioSource>(SyntheticSignal{}));
+	EXPECT_THROW(am.setStftHop(0), std::invalid_argument);
+	EXPECT_THROW(am.setStftHop(FFT_COUNT + 1), std::invalid_argument);
+}
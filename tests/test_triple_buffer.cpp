@@ -0,0 +1,87 @@
+//	Tests the wait-free latest-spectrum handoff between the analysis and render threads
+
+#include "../include/TripleBuffer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+	struct Frame {
+		std::vector<uint32_t> values;
+		uint64_t sequence = 0;
+	};
+}
+
+
+TEST(TripleBufferTest, latestValueTest) {
+	TripleBuffer<Frame> buffer({ std::vector<uint32_t>(4, 0), 0 });
+
+	//	Nothing published yet
+	EXPECT_FALSE(buffer.update());
+	EXPECT_EQ(buffer.readBuffer().sequence, 0u);
+
+	//	The reader skips straight to the newest of several publishes
+	for (uint64_t s = 1; s <= 3; s++) {
+		buffer.writeBuffer().sequence = s;
+		buffer.publish();
+	}
+	ASSERT_TRUE(buffer.update());
+	EXPECT_EQ(buffer.readBuffer().sequence, 3u);
+	EXPECT_FALSE(buffer.update());
+	EXPECT_EQ(buffer.readBuffer().sequence, 3u);
+
+	//	The writer never gets the slot the reader holds
+	buffer.writeBuffer().sequence = 4;
+	EXPECT_EQ(buffer.readBuffer().sequence, 3u);
+	buffer.publish();
+	buffer.writeBuffer().sequence = 5;
+	EXPECT_EQ(buffer.readBuffer().sequence, 3u);
+	ASSERT_TRUE(buffer.update());
+	EXPECT_EQ(buffer.readBuffer().sequence, 4u);
+}
+
+
+TEST(TripleBufferTest, twoThreadStressTest) {
+	//	The writer fills every element of a frame with its sequence number, so any frame the reader
+	//	sees with mixed values was torn. Sequences must only ever go up and the last one must arrive.
+	constexpr uint64_t frames = 200000;
+	constexpr size_t frameSize = 512;
+	TripleBuffer<Frame> buffer({ std::vector<uint32_t>(frameSize, 0), 0 });
+	std::atomic<bool> done{ false };
+
+	std::thread writer([&] {
+		for (uint64_t s = 1; s <= frames; s++) {
+			Frame& frame = buffer.writeBuffer();
+			std::fill(frame.values.begin(), frame.values.end(), static_cast<uint32_t>(s));
+			frame.sequence = s;
+			buffer.publish();
+		}
+		done.store(true, std::memory_order_release);
+	});
+
+	uint64_t last = 0, picked = 0;
+	bool torn = false, monotonic = true;
+	for (;;) {
+		//	Read the flag before updating, so the final update is guaranteed to see the last publish
+		const bool finished = done.load(std::memory_order_acquire);
+		if (buffer.update()) {
+			const Frame& frame = buffer.readBuffer();
+			for (const uint32_t v : frame.values)
+				torn |= v != static_cast<uint32_t>(frame.sequence);
+			monotonic &= frame.sequence > last;
+			last = frame.sequence;
+			picked++;
+		}
+		if (finished) break;
+	}
+	writer.join();
+
+	EXPECT_FALSE(torn);
+	EXPECT_TRUE(monotonic);
+	EXPECT_EQ(last, frames);
+	EXPECT_GT(picked, 0u);
+}
@@ -0,0 +1,53 @@
+//	The vertex ring has to switch upload strategies in either direction and keep delivering the written bytes
+
+#include "graphics_test_class.h"
+
+#include <vector>
+
+TEST_F(GraphicsTest, vertexRingStrategyTest) {
+	if (!hasWindow()) GTEST_SKIP() << "No window, the ring needs a GL context";
+
+	constexpr size_t count = 64;
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	VertexRing ring;
+	ring.init(buffer, sizeof(float) * count);
+	EXPECT_THROW(ring.init(ring.name(), sizeof(float) * count), std::logic_error);
+
+	//	Persistent storage can not be re-specified, leaving it has to move to a new buffer
+	for (const UploadStrategy strategy : { UploadStrategy::BufferData, UploadStrategy::PersistentMapped, UploadStrategy::Orphaning, UploadStrategy::PersistentMapped }) {
+		const bool wasPersistent = ring.strategy() == UploadStrategy::PersistentMapped;
+		const GLuint before = ring.name();
+		EXPECT_EQ(ring.setStrategy(strategy), wasPersistent && strategy != UploadStrategy::PersistentMapped);
+		EXPECT_EQ(ring.name() != before, wasPersistent && ring.strategy() != UploadStrategy::PersistentMapped);
+		if (strategy != UploadStrategy::PersistentMapped) EXPECT_EQ(ring.strategy(), strategy);
+
+		for (int frame = 0; frame < 4; frame++) {
+			auto* written = static_cast<float*>(ring.map());
+			for (size_t i = 0; i < count; i++) written[i] = static_cast<float>(frame * 100) + static_cast<float>(i);
+			const GLint first = ring.unmap(sizeof(float) * count, sizeof(float));
+
+			std::vector<float> read(count);
+			glBindBuffer(GL_ARRAY_BUFFER, ring.name());
+			glGetBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(sizeof(float) * static_cast<size_t>(first)), static_cast<GLsizeiptr>(sizeof(float) * count), read.data());
+			ring.fence();
+			for (size_t i = 0; i < count; i++)
+				ASSERT_EQ(read[i], static_cast<float>(frame * 100) + static_cast<float>(i)) << UPLOAD_STRATEGY_NAMES[static_cast<int>(strategy)] << ", frame " << frame;
+		}
+		EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+	}
+}
+
+
+TEST_F(GraphicsTest, uploadStrategySwitchTest) {
+	if (!hasWindow()) GTEST_SKIP() << "No window, openGLInit needs a GL context";
+
+	//	The bench sweep switches after openGLInit, every ring has to follow without throwing
+	GLuint VBO, VAO;
+	am.openGLInit(VBO, VAO);
+	for (const UploadStrategy strategy : { UploadStrategy::BufferData, UploadStrategy::Orphaning, UploadStrategy::PersistentMapped, UploadStrategy::BufferData }) {
+		ASSERT_NO_THROW(am.setUploadStrategy(strategy)) << UPLOAD_STRATEGY_NAMES[static_cast<int>(strategy)];
+		if (strategy != UploadStrategy::PersistentMapped) EXPECT_EQ(am.uploadStrategy(), strategy);
+		EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+	}
+}
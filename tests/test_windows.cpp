@@ -0,0 +1,92 @@
+//	Tests the compile-time window tables and the windowed STFT copy
+
+#include "../include/Fft.h"
+#include "../include/Stft.h"
+#include "../include/WindowTables.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+template <size_t N>
+static void checkTables()
+{
+	for (size_t t = 0; t < WINDOW_TYPE_COUNT; t++) {
+		const auto w = windowTable<N>(static_cast<WindowType>(t));
+
+		//	Unit coherent gain and DFT-even symmetry
+		double sum = 0.0;
+		for (const float x : w) sum += x;
+		EXPECT_NEAR(sum / N, 1.0, 1e-5) << WINDOW_NAMES[t] << ", N = " << N;
+		for (size_t n = 1; n < N; n++)
+			ASSERT_NEAR(w[n], w[N - n], 1e-5f) << WINDOW_NAMES[t] << ", N = " << N;
+	}
+
+	EXPECT_NEAR(windowTable<N>(WindowType::Hann)[0], 0.0f, 1e-6f);
+	EXPECT_NEAR(windowTable<N>(WindowType::Hann)[N / 2], 2.0f, 1e-6f);
+	EXPECT_EQ(windowTable<N>(WindowType::Rectangular)[N / 3], 1.0f);
+}
+
+
+//	Share of the spectrum energy more than 8 bins away from a sine sitting between two bins
+static double farLeakage(const WindowType type)
+{
+	constexpr size_t N = 480;
+	const auto w = windowTable<N>(type);
+
+	std::vector<float> in(N), re(N / 2 + 1), im(N / 2 + 1);
+	for (size_t i = 0; i < N; i++)
+		in[i] = w[i] * static_cast<float>(std::sin(2.0 * PI * 40.5 * static_cast<double>(i) / N));
+
+	auto fft = std::make_unique<RealFft<N>>();
+	fft->forward(in.data(), re.data(), im.data());
+
+	double total = 0.0, far = 0.0;
+	for (size_t k = 0; k <= N / 2; k++) {
+		const double power = double(re[k]) * re[k] + double(im[k]) * im[k];
+		total += power;
+		if (std::abs(static_cast<double>(k) - 40.5) > 8.0) far += power;
+	}
+	return far / total;
+}
+
+
+TEST(WindowTest, tableTest) {
+	checkTables<480>();
+	checkTables<1024>();
+	checkTables<8192>();
+}
+
+
+TEST(WindowTest, leakageTest) {
+	const double rectangular = farLeakage(WindowType::Rectangular);
+	const double hann = farLeakage(WindowType::Hann);
+	const double blackmanHarris = farLeakage(WindowType::BlackmanHarris);
+
+	EXPECT_LT(hann, rectangular / 100.0);
+	EXPECT_LT(blackmanHarris, hann);
+}
+
+
+TEST(WindowTest, windowedFrameTest) {
+	//	The fused copy has to match copying and then windowing, across the ring wrap point
+	SpscRingBuffer<float> ring(16);
+	Stft stft(8, 4);
+	const auto w = windowTable<8>(WindowType::BlackmanHarris);
+
+	std::vector<float> plain(8), windowed(8);
+	for (int round = 0; round < 6; round++) {
+		for (float v = 0.0f; ring.writeAvailable() > 0; v += 1.0f) ring.push(&v, 1);
+
+		//	Reference copy through peek, which leaves the ring untouched for the fused copy
+		const auto [first, second] = ring.peek(8);
+		std::copy(first.begin(), first.end(), plain.begin());
+		std::copy(second.begin(), second.end(), plain.begin() + first.size());
+
+		ASSERT_TRUE(stft.nextFrame(ring, windowed.data(), w.data()));
+		for (size_t i = 0; i < 8; i++) ASSERT_FLOAT_EQ(windowed[i], plain[i] * w[i]);
+	}
+}